@@ -63,11 +63,19 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-android/charactergenerator.android.cp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-android/sound.openal.android.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-android/nativeactivity.android.cpp
 
+LOCAL_SRC_FILES += $(SOURCE_PATH)/core/arenaallocator.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/core/asynclog.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/core/base64.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/core/binaryserialization.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/core/conversion.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/core/dictionary.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/core/filewatcher.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/core/flatdictionary.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/core/mappedfile.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/core/memorytags.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/core/objectscache.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/core/plist.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/core/profiler.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/core/tools.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/core/transformable.cpp
 
@@ -78,6 +86,8 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/material.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/mesh.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/particlesystem.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/scene3d.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/scenecontainer.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/scenestreamer.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/serialization.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/storage.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/supportmesh.cpp
@@ -94,6 +104,7 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/camera/frustum.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/imaging/ddsloader.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/imaging/imageoperations.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/imaging/imagepipeline.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/imaging/imagewriter.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/imaging/pngloader.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/imaging/pvrloader.cpp
@@ -103,6 +114,7 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/imaging/pvrdecompressor.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/imaging/textureloader.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/tasks/taskpool.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/tasks/jobsystem.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/timers/notifytimer.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/timers/sequence.cpp
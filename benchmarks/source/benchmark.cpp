@@ -0,0 +1,106 @@
+#include <numeric>
+#include <et/json/json.h>
+#include "benchmark.h"
+
+using namespace et;
+
+namespace
+{
+	volatile unsigned char consumedData = 0;
+
+	int64_t nanoseconds(double seconds)
+		{ return static_cast<int64_t>(seconds * 1.0e+9 + 0.5); }
+}
+
+std::vector<benchmark::Benchmark>& benchmark::registeredBenchmarks()
+{
+	static std::vector<Benchmark> benchmarks;
+	return benchmarks;
+}
+
+bool benchmark::registerBenchmark(const std::string& name, size_t iterations, Body body)
+{
+	Benchmark b;
+	b.name = name;
+	b.iterations = iterations;
+	b.body = body;
+	registeredBenchmarks().push_back(b);
+	return true;
+}
+
+benchmark::Result benchmark::run(const Benchmark& b, const Options& options)
+{
+	for (size_t i = 0; i < options.warmupIterations; ++i)
+		b.body();
+
+	size_t iterations = (options.iterations > 0) ? options.iterations : b.iterations;
+
+	std::vector<double> times;
+	times.reserve(iterations);
+
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		auto start = Clock::now();
+		double measuredTime = b.body();
+		times.push_back((measuredTime < 0.0) ? elapsedSeconds(start) : measuredTime);
+	}
+
+	Result result;
+	result.name = b.name;
+	result.iterations = times.size();
+	result.warmupIterations = options.warmupIterations;
+
+	if (!times.empty())
+	{
+		std::sort(times.begin(), times.end());
+		result.minTime = times.front();
+		result.maxTime = times.back();
+		result.medianTime = times.at(times.size() / 2);
+		result.meanTime = std::accumulate(times.begin(), times.end(), 0.0) / static_cast<double>(times.size());
+
+		double variance = 0.0;
+		for (double t : times)
+			variance += (t - result.meanTime) * (t - result.meanTime);
+		result.standardDeviation = std::sqrt(variance / static_cast<double>(times.size()));
+	}
+
+	return result;
+}
+
+void benchmark::print(const Result& r)
+{
+	log::info("%-40s %8zu iterations, mean: %10.3f us, median: %10.3f us, min: %10.3f us, max: %10.3f us",
+		r.name.c_str(), r.iterations, 1.0e+6 * r.meanTime, 1.0e+6 * r.medianTime,
+		1.0e+6 * r.minTime, 1.0e+6 * r.maxTime);
+}
+
+std::string benchmark::serialize(const std::vector<Result>& results, const Options& options)
+{
+	ArrayValue benchmarks;
+	for (const auto& r : results)
+	{
+		Dictionary entry;
+		entry.setStringForKey("name", r.name);
+		entry.setIntegerForKey("iterations", static_cast<int64_t>(r.iterations));
+		entry.setIntegerForKey("warmup_iterations", static_cast<int64_t>(r.warmupIterations));
+		entry.setIntegerForKey("mean_ns", nanoseconds(r.meanTime));
+		entry.setIntegerForKey("median_ns", nanoseconds(r.medianTime));
+		entry.setIntegerForKey("min_ns", nanoseconds(r.minTime));
+		entry.setIntegerForKey("max_ns", nanoseconds(r.maxTime));
+		entry.setIntegerForKey("stddev_ns", nanoseconds(r.standardDeviation));
+		benchmarks->content.push_back(entry);
+	}
+
+	Dictionary report;
+	report.setIntegerForKey("version", static_cast<int64_t>(1));
+	report.setStringForKey("filter", options.filter);
+	report.setArrayForKey("benchmarks", benchmarks);
+	return json::serialize(report, json::SerializationFlag_ReadableFormat);
+}
+
+void benchmark::consume(const void* data, size_t size)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; ++i)
+		consumedData ^= bytes[i];
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <et/core/et.h>
+
+namespace et
+{
+	namespace benchmark
+	{
+		using Clock = std::chrono::steady_clock;
+
+		/*
+		 * Times are in seconds per iteration
+		 */
+		struct Result
+		{
+			std::string name;
+			size_t iterations = 0;
+			size_t warmupIterations = 0;
+			double minTime = 0.0;
+			double maxTime = 0.0;
+			double meanTime = 0.0;
+			double medianTime = 0.0;
+			double standardDeviation = 0.0;
+		};
+
+		/*
+		 * Body is called once per iteration and may return its own measured time
+		 * (for example round-trip latency), or a negative value to use wall time of the call
+		 */
+		using Body = std::function<double()>;
+
+		struct Benchmark
+		{
+			std::string name;
+			size_t iterations = 0;
+			Body body;
+		};
+
+		/*
+		 * Non-zero iterations overrides iterations count of every benchmark,
+		 * warmup iterations are executed before measured ones and are not included into results
+		 */
+		struct Options
+		{
+			std::string filter;
+			std::string jsonFileName;
+			size_t iterations = 0;
+			size_t warmupIterations = 1;
+		};
+
+		std::vector<Benchmark>& registeredBenchmarks();
+		bool registerBenchmark(const std::string& name, size_t iterations, Body body);
+
+		Result run(const Benchmark&, const Options&);
+		void print(const Result&);
+
+		/*
+		 * Machine-readable report, times are in nanoseconds
+		 */
+		std::string serialize(const std::vector<Result>&, const Options&);
+
+		/*
+		 * Keeps computations, which results are not used otherwise, from being optimized out
+		 */
+		void consume(const void* data, size_t size);
+
+		template <typename T>
+		inline void consume(const T& value)
+			{ consume(&value, sizeof(value)); }
+
+		inline double elapsedSeconds(Clock::time_point start)
+			{ return std::chrono::duration<double>(Clock::now() - start).count(); }
+	}
+}
+
+#define ET_BENCHMARK_VARIABLE_IMPL(NAME, LINE)	NAME##LINE
+#define ET_BENCHMARK_VARIABLE(NAME, LINE)		ET_BENCHMARK_VARIABLE_IMPL(NAME, LINE)
+
+/*
+ * Registers benchmark at static initialization time:
+ *	ET_BENCHMARK("name", 1000, []() { ...; return -1.0; });
+ */
+#define ET_BENCHMARK(NAME, ITERATIONS, BODY) \
+	static const bool ET_BENCHMARK_VARIABLE(etBenchmarkRegistered, __LINE__) = \
+		et::benchmark::registerBenchmark(NAME, ITERATIONS, BODY)
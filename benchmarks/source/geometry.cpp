@@ -0,0 +1,111 @@
+#include <random>
+#include <et/geometry/rectplacer.h>
+#include <et/primitives/primitives.h>
+#include "benchmark.h"
+
+using namespace et;
+
+namespace
+{
+	const vec2i sphereDensity(256, 128);
+
+	enum : size_t
+	{
+		rectanglesCount = 1024
+	};
+
+	struct SphereMesh
+	{
+		VertexStorage::Pointer vertices;
+		IndexArray::Pointer indices;
+		uint32_t primitivesCount = 0;
+
+		SphereMesh()
+		{
+			VertexDeclaration decl(true);
+			decl.push_back(VertexAttributeUsage::Position, VertexAttributeType::Vec3);
+			decl.push_back(VertexAttributeUsage::Normal, VertexAttributeType::Vec3);
+			decl.push_back(VertexAttributeUsage::TexCoord0, VertexAttributeType::Vec2);
+			decl.push_back(VertexAttributeUsage::Tangent, VertexAttributeType::Vec3);
+
+			VertexArray::Pointer data = VertexArray::Pointer::create(decl, 0);
+			primitives::createSphere(data, 1.0f, sphereDensity);
+			vertices = VertexStorage::Pointer::create(data);
+
+			uint32_t indexCount = primitives::indexCountForRegularMesh(sphereDensity, PrimitiveType::Triangles);
+			indices = IndexArray::Pointer::create(IndexArrayFormat::Format_32bit, indexCount, PrimitiveType::Triangles);
+			primitives::buildTrianglesIndexes(indices, sphereDensity, 0, 0);
+			primitivesCount = static_cast<uint32_t>(indices->primitivesCount());
+		}
+	};
+
+	SphereMesh& sphereMesh()
+	{
+		static SphereMesh mesh;
+		return mesh;
+	}
+
+	const std::vector<vec2i>& rectangleSizes()
+	{
+		static std::vector<vec2i> sizes;
+		if (sizes.empty())
+		{
+			std::mt19937 generator(5);
+			std::uniform_int_distribution<int> distribution(4, 48);
+			for (size_t i = 0; i < rectanglesCount; ++i)
+				sizes.emplace_back(distribution(generator), distribution(generator));
+		}
+		return sizes;
+	}
+}
+
+ET_BENCHMARK("primitives/calculate_normals", 50, []()
+{
+	SphereMesh& mesh = sphereMesh();
+	primitives::calculateNormals(mesh.vertices, mesh.indices, 0, mesh.primitivesCount);
+	return -1.0;
+});
+
+ET_BENCHMARK("primitives/calculate_tangents", 50, []()
+{
+	SphereMesh& mesh = sphereMesh();
+	primitives::calculateTangents(mesh.vertices, mesh.indices, 0, mesh.primitivesCount);
+	return -1.0;
+});
+
+ET_BENCHMARK("index_array/primitive_iterator", 200, []()
+{
+	const IndexArray::Pointer& indices = sphereMesh().indices;
+	size_t result = 0;
+	for (auto i = indices->begin(), e = indices->end(); i != e; ++i)
+		result += (*i)[0] ^ (*i)[1] ^ (*i)[2];
+	benchmark::consume(result);
+	return -1.0;
+});
+
+ET_BENCHMARK("index_array/get_index", 200, []()
+{
+	const IndexArray::Pointer& indices = sphereMesh().indices;
+	uint32_t result = 0;
+	for (size_t i = 0, e = indices->actualSize(); i < e; ++i)
+		result ^= indices->getIndex(i);
+	benchmark::consume(result);
+	return -1.0;
+});
+
+ET_BENCHMARK("rect_placer/place", 50, []()
+{
+	const auto& sizes = rectangleSizes();
+
+	auto start = benchmark::Clock::now();
+	RectPlacer placer(vec2i(1024), true);
+
+	size_t placed = 0;
+	recti position;
+	for (const auto& size : sizes)
+		placed += placer.place(size, position) ? 1 : 0;
+	double elapsed = benchmark::elapsedSeconds(start);
+
+	benchmark::consume(placed);
+	return elapsed;
+});
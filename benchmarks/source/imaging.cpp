@@ -0,0 +1,108 @@
+#include <random>
+#include <et/imaging/imagepipeline.h>
+#include "benchmark.h"
+
+using namespace et;
+
+namespace
+{
+	const vec2i imageSize(512, 512);
+
+	enum : int
+	{
+		imageComponents = 4,
+		blurRadius = 8,
+		medianRadius = 2
+	};
+
+	const BinaryDataStorage& sourceImage()
+	{
+		static BinaryDataStorage image;
+		if (image.size() == 0)
+		{
+			std::mt19937 generator(7);
+			std::uniform_int_distribution<int> distribution(0, 255);
+
+			image.resize(static_cast<size_t>(imageSize.square() * imageComponents));
+			for (auto& value : image)
+				value = static_cast<unsigned char>(distribution(generator));
+		}
+		return image;
+	}
+
+	/*
+	 * Operations are in-place, so every iteration works on the fresh copy of the source,
+	 * copying is not included into measured time
+	 */
+	template <typename F>
+	double measureOnCopy(F operation)
+	{
+		BinaryDataStorage image(sourceImage());
+
+		auto start = benchmark::Clock::now();
+		operation(image);
+		double elapsed = benchmark::elapsedSeconds(start);
+
+		benchmark::consume(image[image.size() / 2]);
+		return elapsed;
+	}
+}
+
+ET_BENCHMARK("imaging/blur_horizontal", 20, []()
+{
+	return measureOnCopy([](BinaryDataStorage& image)
+		{ ImageOperations::blur(image, imageSize, imageComponents, vec2i(1, 0), blurRadius, ImageBlurType_Average); });
+});
+
+ET_BENCHMARK("imaging/blur_vertical", 20, []()
+{
+	return measureOnCopy([](BinaryDataStorage& image)
+		{ ImageOperations::blur(image, imageSize, imageComponents, vec2i(0, 1), blurRadius, ImageBlurType_Average); });
+});
+
+ET_BENCHMARK("imaging/blur_gaussian", 20, []()
+{
+	static FloatDataStorage scratch;
+	return measureOnCopy([](BinaryDataStorage& image)
+		{ ImageOperations::blur(image, imageSize, imageComponents, 4 * blurRadius, ImageBlurType_Gaussian, &scratch); });
+});
+
+ET_BENCHMARK("imaging/median", 5, []()
+{
+	return measureOnCopy([](BinaryDataStorage& image)
+		{ ImageOperations::median(image, imageSize, imageComponents, medianRadius); });
+});
+
+ET_BENCHMARK("imaging/median_large_radius", 5, []()
+{
+	return measureOnCopy([](BinaryDataStorage& image)
+		{ ImageOperations::median(image, imageSize, imageComponents, 8 * medianRadius); });
+});
+
+ET_BENCHMARK("imaging/matrix_filter", 20, []()
+{
+	return measureOnCopy([](BinaryDataStorage& image)
+		{ ImageOperations::applyMatrixFilter(image, imageSize, imageComponents, ImageOperations::matrixFilterSharpen); });
+});
+
+ET_BENCHMARK("imaging/draw", 20, []()
+{
+	return measureOnCopy([](BinaryDataStorage& image)
+	{
+		ImageOperations::draw(sourceImage(), imageSize, imageComponents, image, imageSize, imageComponents,
+			recti(imageSize / 4, imageSize), ImageBlendType_Default, ImageFilteringType_Linear);
+	});
+});
+
+ET_BENCHMARK("imaging/pipeline", 20, []()
+{
+	return measureOnCopy([](BinaryDataStorage& image)
+	{
+		ImagePipeline(imageSize, imageComponents)
+			.matrixFilter(ImageOperations::matrixFilterSharpen)
+			.matrixFilter(ImageOperations::matrixFilterBlur)
+			.draw(sourceImage(), imageSize, imageComponents, recti(imageSize / 4, imageSize), ImageBlendType_Additive, ImageFilteringType_Linear)
+			.normalMapFilter(vec2(1.0f))
+			.execute(image);
+	});
+});
@@ -0,0 +1,58 @@
+#include <et/app/invocation.h>
+#include <et/app/backgroundthread.h>
+#include "benchmark.h"
+
+using namespace et;
+
+namespace
+{
+	/*
+	 * Same path as Invocation::invokeInBackground, but with own thread,
+	 * so benchmark does not depend on Application instance
+	 */
+	struct BenchmarkBackgroundThread
+	{
+		BackgroundThread thread;
+
+		BenchmarkBackgroundThread()
+			{ thread.run(); }
+
+		~BenchmarkBackgroundThread()
+			{ thread.stopAndWaitForTermination(); }
+	};
+
+	BackgroundThread& benchmarkBackgroundThread()
+	{
+		static BenchmarkBackgroundThread holder;
+		return holder.thread;
+	}
+
+	double backgroundRoundTrip(float delay)
+	{
+		std::atomic<bool> executed(false);
+		auto& runLoop = benchmarkBackgroundThread().runLoop();
+
+		auto start = benchmark::Clock::now();
+		Invocation([&executed]() { executed = true; }).invokeInRunLoop(runLoop, delay);
+
+		while (!executed)
+			std::this_thread::yield();
+
+		return benchmark::elapsedSeconds(start);
+	}
+}
+
+ET_BENCHMARK("invocation/background_round_trip", 10000, []()
+	{ return backgroundRoundTrip(0.0f); });
+
+ET_BENCHMARK("invocation/background_round_trip_idle", 200, []()
+{
+	/*
+	 * Let background thread fall asleep before posting
+	 */
+	std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	return backgroundRoundTrip(0.0f);
+});
+
+ET_BENCHMARK("invocation/background_delayed_5ms", 100, []()
+	{ return backgroundRoundTrip(0.005f) - 0.005; });
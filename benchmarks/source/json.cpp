@@ -0,0 +1,192 @@
+#include <et/core/binaryserialization.h>
+#include <et/core/flatdictionary.h>
+#include <et/json/json.h>
+#include "benchmark.h"
+
+using namespace et;
+
+namespace
+{
+	enum : size_t
+	{
+		sceneObjectsCount = 8000
+	};
+
+	/*
+	 * Scene-like document: many objects with repeating keys,
+	 * transforms as float arrays, names and nested material properties.
+	 * Produces few megabytes of JSON.
+	 */
+	Dictionary createScene()
+	{
+		ArrayValue objects;
+		for (size_t i = 0; i < sceneObjectsCount; ++i)
+		{
+			ArrayValue transform;
+			for (size_t t = 0; t < 16; ++t)
+				transform->content.push_back(FloatValue(static_cast<float>(i * 16 + t) * 0.001234f - 3.5f));
+
+			Dictionary material;
+			material.setStringForKey("name", "material_" + intToStr(i % 64));
+			material.setFloatForKey("roughness", static_cast<float>(i % 100) / 100.0f);
+			material.setFloatForKey("metallness", static_cast<float>(i % 7) / 7.0f);
+			material.setIntegerForKey("flags", static_cast<int64_t>(i % 5));
+
+			Dictionary object;
+			object.setStringForKey("name", "object_" + intToStr(i));
+			object.setStringForKey("type", (i % 3 == 0) ? "mesh" : "storage");
+			object.setIntegerForKey("identifier", static_cast<int64_t>(i));
+			object.setArrayForKey("transform", transform);
+			object.setDictionaryForKey("material", material);
+			objects->content.push_back(object);
+		}
+
+		Dictionary scene;
+		scene.setIntegerForKey("version", static_cast<int64_t>(1));
+		scene.setArrayForKey("objects", objects);
+		return scene;
+	}
+
+	const std::string& sceneDocument()
+	{
+		static std::string document;
+		if (document.empty())
+		{
+			document = json::serialize(createScene());
+			log::debug("JSON document size: %.2f Mb", static_cast<double>(document.size()) / 1048576.0);
+		}
+		return document;
+	}
+
+	const BinaryDataStorage& sceneBinaryDocument()
+	{
+		static BinaryDataStorage document;
+		if (document.size() == 0)
+		{
+			document = binary::serialize(createScene());
+			log::debug("Binary document size: %.2f Mb", static_cast<double>(document.size()) / 1048576.0);
+		}
+		return document;
+	}
+
+	/*
+	 * Header, string table with single string, root value with tag and count varint and few values,
+	 * count is 2^63 + 1, so that 2 * count wraps around
+	 */
+	BinaryDataStorage malformedBinaryDocument(uint8_t rootTag)
+	{
+		const uint8_t data[] =
+		{
+			'E', 'T', 'B', 'D', 1,
+			1, 1, 'a',
+			rootTag, 0x81, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01,
+			0, 1, 0, 0, 1, 0, 0
+		};
+		BinaryDataStorage result(sizeof(data));
+		memcpy(result.data(), data, sizeof(data));
+		return result;
+	}
+
+	/*
+	 * Array, dictionary and float array
+	 */
+	const uint8_t malformedRootTags[] = { 4, 5, 6 };
+
+	const BinaryDataStorage& sceneFlatDocument()
+	{
+		static BinaryDataStorage document;
+		if (document.size() == 0)
+		{
+			document = FlatDocument::build(createScene());
+			log::debug("Flat document size: %.2f Mb", static_cast<double>(document.size()) / 1048576.0);
+		}
+		return document;
+	}
+}
+
+ET_BENCHMARK("json/deserialize_streaming", 20, []()
+{
+	const std::string& document = sceneDocument();
+
+	auto start = benchmark::Clock::now();
+	ValueClass c = ValueClass_Invalid;
+	auto result = json::deserialize(document, c);
+	double elapsed = benchmark::elapsedSeconds(start);
+
+	ET_ASSERT(c == ValueClass_Dictionary);
+	return elapsed;
+});
+
+ET_BENCHMARK("json/deserialize_jansson", 20, []()
+{
+	const std::string& document = sceneDocument();
+
+	auto start = benchmark::Clock::now();
+	ValueClass c = ValueClass_Invalid;
+	auto result = json::deserializeWithJansson(document.c_str(), document.size(), c);
+	double elapsed = benchmark::elapsedSeconds(start);
+
+	ET_ASSERT(c == ValueClass_Dictionary);
+	return elapsed;
+});
+
+ET_BENCHMARK("binary/deserialize", 20, []()
+{
+	const BinaryDataStorage& document = sceneBinaryDocument();
+
+	auto start = benchmark::Clock::now();
+	ValueClass c = ValueClass_Invalid;
+	auto result = binary::deserialize(document, c);
+	double elapsed = benchmark::elapsedSeconds(start);
+
+	ET_ASSERT(c == ValueClass_Dictionary);
+	return elapsed;
+});
+
+/*
+ * Truncated and crafted documents should be rejected, not crash or allocate by declared counts
+ */
+ET_BENCHMARK("binary/deserialize_malformed", 20, []()
+{
+	const BinaryDataStorage& document = sceneBinaryDocument();
+
+	auto start = benchmark::Clock::now();
+	size_t rejected = 0;
+	for (uint8_t tag : malformedRootTags)
+	{
+		ValueClass c = ValueClass_Invalid;
+		binary::deserialize(malformedBinaryDocument(tag), c, false);
+		rejected += (c == ValueClass_Invalid) ? 1 : 0;
+	}
+
+	ValueClass c = ValueClass_Invalid;
+	binary::deserialize(document.binary(), document.dataSize() / 2, c, false);
+	rejected += (c == ValueClass_Invalid) ? 1 : 0;
+	double elapsed = benchmark::elapsedSeconds(start);
+
+	ET_ASSERT(rejected == sizeof(malformedRootTags) + 1);
+	return elapsed;
+});
+
+ET_BENCHMARK("flat/open_and_query", 20, []()
+{
+	const BinaryDataStorage& data = sceneFlatDocument();
+
+	auto start = benchmark::Clock::now();
+	FlatDocument document(data.binary(), data.dataSize());
+
+	int64_t identifiers = 0;
+	float roughness = 0.0f;
+	FlatArray objects = document.rootDictionary().arrayForKey("objects");
+	for (size_t i = 0, e = objects.size(); i < e; ++i)
+	{
+		FlatDictionary object(objects[i]);
+		identifiers += object.integerForKey("identifier");
+		roughness += object.dictionaryForKey("material").floatForKey("roughness");
+	}
+	double elapsed = benchmark::elapsedSeconds(start);
+
+	ET_ASSERT(identifiers == sceneObjectsCount * (sceneObjectsCount - 1) / 2);
+	(void)roughness;
+	return elapsed;
+});
@@ -0,0 +1,115 @@
+#include <random>
+#include <et/primitives/primitives.h>
+#include <et/rt/kdtree.h>
+#include "benchmark.h"
+
+using namespace et;
+
+namespace
+{
+	const vec2i sphereDensity(192, 96);
+
+	enum : size_t
+	{
+		spheresCount = 8,
+		raysCount = 4096,
+		maxDepth = 0,
+		splits = 4
+	};
+
+	/*
+	 * Several overlapping spheres, to produce non-trivial tree
+	 */
+	const rt::TriangleList& sceneTriangles()
+	{
+		static rt::TriangleList triangles;
+		if (!triangles.empty())
+			return triangles;
+
+		VertexDeclaration decl(true);
+		decl.push_back(VertexAttributeUsage::Position, VertexAttributeType::Vec3);
+		decl.push_back(VertexAttributeUsage::Normal, VertexAttributeType::Vec3);
+		decl.push_back(VertexAttributeUsage::TexCoord0, VertexAttributeType::Vec2);
+
+		uint32_t indexCount = primitives::indexCountForRegularMesh(sphereDensity, PrimitiveType::Triangles);
+		IndexArray::Pointer indices = IndexArray::Pointer::create(IndexArrayFormat::Format_32bit,
+			indexCount, PrimitiveType::Triangles);
+		primitives::buildTrianglesIndexes(indices, sphereDensity, 0, 0);
+
+		for (size_t s = 0; s < spheresCount; ++s)
+		{
+			float angle = DOUBLE_PI * static_cast<float>(s) / static_cast<float>(spheresCount);
+			vec3 center(2.0f * std::cos(angle), 0.5f * static_cast<float>(s % 3), 2.0f * std::sin(angle));
+
+			VertexArray::Pointer data = VertexArray::Pointer::create(decl, 0);
+			primitives::createSphere(data, 1.0f + 0.1f * static_cast<float>(s), sphereDensity, center);
+
+			const auto pos = data->chunk(VertexAttributeUsage::Position).accessData<vec3>(0);
+			const auto nrm = data->chunk(VertexAttributeUsage::Normal).accessData<vec3>(0);
+			for (size_t i = 0; i + 2 < indices->actualSize(); i += 3)
+			{
+				triangles.emplace_back();
+				auto& tri = triangles.back();
+				for (size_t v = 0; v < 3; ++v)
+				{
+					size_t index = indices->getIndex(i + v);
+					tri.v[v] = rt::float4(pos[index], 1.0f);
+					tri.n[v] = rt::float4(nrm[index], 0.0f);
+				}
+				tri.computeSupportData();
+			}
+		}
+		return triangles;
+	}
+
+	const std::vector<rt::Ray>& sceneRays()
+	{
+		static std::vector<rt::Ray> rays;
+		if (rays.empty())
+		{
+			std::mt19937 generator(6);
+			std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+			for (size_t i = 0; i < raysCount; ++i)
+			{
+				vec3 target(2.5f * distribution(generator), distribution(generator), 2.5f * distribution(generator));
+				vec3 origin(0.0f, 1.0f, -8.0f);
+				rays.emplace_back(rt::float4(origin, 1.0f), rt::float4(normalize(target - origin), 0.0f));
+			}
+		}
+		return rays;
+	}
+
+	KDTree& sceneTree()
+	{
+		static KDTree tree;
+		static bool built = false;
+		if (!built)
+		{
+			tree.build(sceneTriangles(), maxDepth, splits);
+			built = true;
+		}
+		return tree;
+	}
+}
+
+ET_BENCHMARK("kdtree/build", 10, []()
+{
+	const rt::TriangleList& triangles = sceneTriangles();
+
+	auto start = benchmark::Clock::now();
+	KDTree tree;
+	tree.build(triangles, maxDepth, splits);
+	return benchmark::elapsedSeconds(start);
+});
+
+ET_BENCHMARK("kdtree/traverse", 50, []()
+{
+	KDTree& tree = sceneTree();
+
+	size_t hits = 0;
+	for (const auto& ray : sceneRays())
+		hits += (tree.traverse(ray).triangleIndex != InvalidIndex) ? 1 : 0;
+
+	benchmark::consume(hits);
+	return -1.0;
+});
@@ -0,0 +1,55 @@
+#include "benchmark.h"
+
+namespace
+{
+	/*
+	 * Usage: benchmarks [filter] [--iterations=N] [--warmup=N] [--json=file]
+	 */
+	et::benchmark::Options parseOptions(int argc, char* argv[])
+	{
+		et::benchmark::Options options;
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string arg(argv[i]);
+			if (arg.find("--iterations=") == 0)
+				options.iterations = static_cast<size_t>(std::strtoull(arg.c_str() + 13, nullptr, 10));
+			else if (arg.find("--warmup=") == 0)
+				options.warmupIterations = static_cast<size_t>(std::strtoull(arg.c_str() + 9, nullptr, 10));
+			else if (arg.find("--json=") == 0)
+				options.jsonFileName = arg.substr(7);
+			else
+				options.filter = arg;
+		}
+		return options;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	et::log::addOutput(et::log::ConsoleOutput::Pointer::create());
+
+	et::benchmark::Options options = parseOptions(argc, argv);
+
+	std::vector<et::benchmark::Result> results;
+	for (const auto& b : et::benchmark::registeredBenchmarks())
+	{
+		if (options.filter.empty() || (b.name.find(options.filter) != std::string::npos))
+		{
+			results.push_back(et::benchmark::run(b, options));
+			et::benchmark::print(results.back());
+		}
+	}
+
+	if (!options.jsonFileName.empty())
+	{
+		std::ofstream output(options.jsonFileName, std::ios::out | std::ios::binary);
+		output << et::benchmark::serialize(results, options);
+		if (!output.good())
+		{
+			et::log::error("Unable to write benchmark results to %s", options.jsonFileName.c_str());
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,110 @@
+#include <random>
+#include <et/geometry/geometry.h>
+#include <et/geometry/vector4-simd.h>
+#include "benchmark.h"
+
+using namespace et;
+
+namespace
+{
+	enum : size_t
+	{
+		elementsCount = 4096
+	};
+
+	/*
+	 * Same input for every run, so results are comparable between commits
+	 */
+	template <typename T, typename F>
+	std::vector<T, SharedBlockAllocatorSTDProxy<T>> generate(uint32_t seed, F func)
+	{
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+		auto next = [&]() { return distribution(generator); };
+
+		std::vector<T, SharedBlockAllocatorSTDProxy<T>> result(elementsCount);
+		for (auto& value : result)
+			value = func(next);
+		return result;
+	}
+
+	const std::vector<vec4simd, SharedBlockAllocatorSTDProxy<vec4simd>>& simdVectors()
+	{
+		static auto vectors = generate<vec4simd>(1, [](std::function<float()> next)
+			{ return vec4simd(next(), next(), next(), next()); });
+		return vectors;
+	}
+
+	const std::vector<vec3, SharedBlockAllocatorSTDProxy<vec3>>& vectors()
+	{
+		static auto vectors = generate<vec3>(2, [](std::function<float()> next)
+			{ return vec3(next(), next(), next()); });
+		return vectors;
+	}
+
+	const std::vector<mat4, SharedBlockAllocatorSTDProxy<mat4>>& matrices()
+	{
+		static auto matrices = generate<mat4>(3, [](std::function<float()> next)
+		{
+			vec3 translation(next(), next(), next());
+			vec3 rotation(next(), next(), next());
+			return transformYXZMatrix(translation, PI * rotation) * scaleMatrix(vec3(1.5f + next()));
+		});
+		return matrices;
+	}
+}
+
+ET_BENCHMARK("math/vec4simd_multiply_add", 2000, []()
+{
+	const auto& v = simdVectors();
+	vec4simd result(0.0f);
+	for (size_t i = 0; i + 2 < v.size(); ++i)
+		result += v[i] * v[i + 1] + v[i + 2];
+	benchmark::consume(result);
+	return -1.0;
+});
+
+ET_BENCHMARK("math/vec4simd_dot_normalize", 2000, []()
+{
+	const auto& v = simdVectors();
+	float result = 0.0f;
+	for (size_t i = 0; i + 1 < v.size(); ++i)
+	{
+		vec4simd n = v[i].crossXYZ(v[i + 1]);
+		n.normalize();
+		result += n.dot(v[i]);
+	}
+	benchmark::consume(result);
+	return -1.0;
+});
+
+ET_BENCHMARK("math/mat4_multiply", 2000, []()
+{
+	const auto& m = matrices();
+	mat4 result = identityMatrix;
+	for (const auto& i : m)
+		result = result * i;
+	benchmark::consume(result);
+	return -1.0;
+});
+
+ET_BENCHMARK("math/mat4_transform_vec3", 2000, []()
+{
+	const auto& m = matrices();
+	const auto& v = vectors();
+	vec3 result(0.0f);
+	for (size_t i = 0; i < v.size(); ++i)
+		result += m[i] * v[i];
+	benchmark::consume(result);
+	return -1.0;
+});
+
+ET_BENCHMARK("math/mat4_inverse", 500, []()
+{
+	const auto& m = matrices();
+	mat4 result = identityMatrix;
+	for (const auto& i : m)
+		result += i.inverse();
+	benchmark::consume(result);
+	return -1.0;
+});
@@ -0,0 +1,72 @@
+#include <random>
+#include "benchmark.h"
+
+using namespace et;
+
+namespace
+{
+	enum : size_t
+	{
+		allocationsCount = 4096
+	};
+
+	/*
+	 * Mixed small sizes and shuffled release order, similar to containers of the engine
+	 */
+	struct AllocationPattern
+	{
+		std::vector<size_t> sizes;
+		std::vector<size_t> releaseOrder;
+
+		AllocationPattern()
+		{
+			std::mt19937 generator(4);
+			std::uniform_int_distribution<size_t> sizeDistribution(8, 512);
+
+			sizes.resize(allocationsCount);
+			releaseOrder.resize(allocationsCount);
+			for (size_t i = 0; i < allocationsCount; ++i)
+			{
+				sizes[i] = sizeDistribution(generator);
+				releaseOrder[i] = i;
+			}
+			std::shuffle(releaseOrder.begin(), releaseOrder.end(), generator);
+		}
+	};
+
+	const AllocationPattern& allocationPattern()
+	{
+		static AllocationPattern pattern;
+		return pattern;
+	}
+
+	template <typename A, typename R>
+	double allocateAndRelease(A allocate, R release)
+	{
+		const AllocationPattern& pattern = allocationPattern();
+		std::vector<void*> pointers(allocationsCount, nullptr);
+
+		auto start = benchmark::Clock::now();
+		for (size_t i = 0; i < allocationsCount; ++i)
+		{
+			pointers[i] = allocate(pattern.sizes[i]);
+			*static_cast<char*>(pointers[i]) = static_cast<char>(i);
+		}
+		for (size_t i : pattern.releaseOrder)
+			release(pointers[i]);
+		return benchmark::elapsedSeconds(start);
+	}
+}
+
+ET_BENCHMARK("memory/block_allocator", 500, []()
+{
+	static BlockMemoryAllocator allocator;
+	return allocateAndRelease([](size_t size) { return allocator.allocate(size); },
+		[](void* ptr) { allocator.release(ptr); });
+});
+
+ET_BENCHMARK("memory/malloc", 500, []()
+{
+	return allocateAndRelease([](size_t size) { return malloc(size); },
+		[](void* ptr) { free(ptr); });
+});
@@ -0,0 +1,75 @@
+#include <et/models/objloader.h>
+#include "benchmark.h"
+
+using namespace et;
+
+namespace
+{
+	const vec2i gridSize(192, 192);
+
+	/*
+	 * Writes grid with positions, texture coordinates and normals,
+	 * faces are quads and triangles in v/vt/vn format.
+	 */
+	const std::string& objFileName()
+	{
+		static std::string fileName;
+		if (!fileName.empty())
+			return fileName;
+
+		fileName = addTrailingSlash(temporaryBaseFolder()) + "et-benchmark-grid.obj";
+		std::ofstream output(fileName, std::ios::out | std::ios::binary);
+
+		char buffer[256] = { };
+		output << "# benchmark grid\ng grid\ns 1\n";
+		for (int y = 0; y < gridSize.y; ++y)
+		{
+			for (int x = 0; x < gridSize.x; ++x)
+			{
+				float u = static_cast<float>(x) / static_cast<float>(gridSize.x - 1);
+				float v = static_cast<float>(y) / static_cast<float>(gridSize.y - 1);
+				float h = 0.1f * std::sin(10.0f * u) * std::cos(10.0f * v);
+				snprintf(buffer, sizeof(buffer), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n",
+					u, h, v, u, v, 0.0f, 1.0f, 0.0f);
+				output << buffer;
+			}
+		}
+
+		for (int y = 0; y + 1 < gridSize.y; ++y)
+		{
+			for (int x = 0; x + 1 < gridSize.x; ++x)
+			{
+				int i00 = 1 + x + y * gridSize.x;
+				int i10 = i00 + 1;
+				int i01 = i00 + gridSize.x;
+				int i11 = i01 + 1;
+				if ((x + y) % 2 == 0)
+				{
+					snprintf(buffer, sizeof(buffer), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n",
+						i00, i00, i00, i01, i01, i01, i11, i11, i11, i10, i10, i10);
+				}
+				else
+				{
+					snprintf(buffer, sizeof(buffer), "f %d/%d/%d %d/%d/%d %d/%d/%d\nf %d/%d/%d %d/%d/%d %d/%d/%d\n",
+						i00, i00, i00, i01, i01, i01, i11, i11, i11, i00, i00, i00, i11, i11, i11, i10, i10, i10);
+				}
+				output << buffer;
+			}
+		}
+
+		return fileName;
+	}
+}
+
+ET_BENCHMARK("obj_loader/parse", 5, []()
+{
+	const std::string& fileName = objFileName();
+
+	auto start = benchmark::Clock::now();
+	OBJLoader loader(fileName, OBJLoader::Option_JustLoad);
+	loader.parse();
+	double elapsed = benchmark::elapsedSeconds(start);
+
+	ET_ASSERT(loader.indexArray().valid() && (loader.indexArray()->actualSize() > 0));
+	return elapsed;
+});
@@ -0,0 +1,70 @@
+#include <et/app/runloop.h>
+#include "benchmark.h"
+
+using namespace et;
+
+namespace
+{
+	enum : size_t
+	{
+		tasksPerProducer = 20000
+	};
+
+	/*
+	 * N producer threads are posting tasks to one run loop,
+	 * which is updated on the calling thread until all tasks are executed.
+	 * Returns time per task.
+	 */
+	double runLoopStress(size_t producersCount)
+	{
+		RunLoop::Pointer runLoop = RunLoop::Pointer::create();
+		std::atomic<size_t> executedTasks(0);
+		std::atomic<bool> started(false);
+		size_t totalTasks = producersCount * tasksPerProducer;
+
+		std::vector<std::thread> producers;
+		for (size_t i = 0; i < producersCount; ++i)
+		{
+			producers.emplace_back([&]()
+			{
+				while (!started)
+					std::this_thread::yield();
+
+				for (size_t t = 0; t < tasksPerProducer; ++t)
+					runLoop->addTask([&executedTasks]() { executedTasks.fetch_add(1, std::memory_order_relaxed); }, 0.0f);
+			});
+		}
+
+		auto start = benchmark::Clock::now();
+		started = true;
+
+		uint64_t time = 0;
+		while (executedTasks.load(std::memory_order_relaxed) < totalTasks)
+			runLoop->update(++time);
+
+		double elapsed = benchmark::elapsedSeconds(start);
+
+		for (auto& producer : producers)
+			producer.join();
+
+		auto stats = runLoop->taskStatistics();
+		log::debug("%zu producers: peak queue depth: %zu, overflowed: %llu, peak drain: %.3f us, average drain per task: %.3f ns",
+			producersCount, stats.peakQueueDepth, static_cast<unsigned long long>(stats.overflowedTasks),
+			static_cast<double>(stats.peakDrainTime) / 1000.0,
+			static_cast<double>(stats.totalDrainTime) / static_cast<double>(etMax(uint64_t(1), stats.drainedTasks)));
+
+		return elapsed / static_cast<double>(totalTasks);
+	}
+}
+
+ET_BENCHMARK("runloop/stress_1_producer", 10, []()
+	{ return runLoopStress(1); });
+
+ET_BENCHMARK("runloop/stress_2_producers", 10, []()
+	{ return runLoopStress(2); });
+
+ET_BENCHMARK("runloop/stress_4_producers", 10, []()
+	{ return runLoopStress(4); });
+
+ET_BENCHMARK("runloop/stress_8_producers", 10, []()
+	{ return runLoopStress(8); });
@@ -14,6 +14,7 @@
 #include <et/app/applicationdelegate.h>
 #include <et/app/backgroundthread.h>
 #include <et/app/pathresolver.h>
+#include <et/app/frametimehistogram.h>
 
 namespace et
 {
@@ -82,6 +83,22 @@ namespace et
 
 		void setTitle(const std::string& s);
 		void setFrameRateLimit(size_t value);
+		void setFixedTimeStep(double value);
+
+		/*
+		 * Fraction of the fixed time step accumulated since the last fixed update
+		 */
+		float interpolationAlpha() const
+			{ return _interpolationAlpha; }
+
+		/*
+		 * Intervals between frames since the last reset
+		 */
+		const FrameTimeHistogram& frameTimeHistogram() const
+			{ return _frameTimeHistogram; }
+
+		void resetFrameTimeHistogram()
+			{ _frameTimeHistogram.reset(); }
 
 		void requestUserAttention();
 		
@@ -122,7 +139,10 @@ namespace et
 		void exitRunLoop();
 		
 		bool shouldPerformRendering();
+		bool shouldPerformRenderingCoarse();
+		bool shouldPerformRenderingPrecise();
 		void performUpdateAndRender();
+		void performFixedUpdates();
 		
 		void updateTimers(float dt);
 		
@@ -160,9 +180,19 @@ namespace et
 		std::atomic<bool> _suspended;
 		
 		size_t _renderingContextHandle = 0;
-		uint64_t _lastQueuedTimeMSec = 0;
+		uint64_t _lastQueuedTimeNSec = 0;
+		uint64_t _lastFrameTimeNSec = 0;
+		uint64_t _nextFrameTimeNSec = 0;
+		uint64_t _frameIntervalNSec = 15000000;
+		uint64_t _sleepOvershootNSec = 1000000;
 		uint64_t _fpsLimitMSec = 15;
 		uint64_t _fpsLimitMSecFractPart = 0;
+
+		double _fixedUpdateAccumulator = 0.0;
+		double _lastFixedUpdateTime = 0.0;
+		float _interpolationAlpha = 1.0f;
+
+		FrameTimeHistogram _frameTimeHistogram;
 		
 		int _exitCode = 0;
 		bool _postResizeOnActivate = false;
@@ -44,6 +44,16 @@ namespace et
 		Fullscreen
 	};
 
+	/*
+	 * Coarse - millisecond sleeps, cheap but jittery
+	 * Precise - nanosecond clock, sleeps until shortly before deadline and then spins
+	 */
+	enum class FramePacing
+	{
+		Coarse,
+		Precise
+	};
+
 	struct ApplicationParameters
 	{
 		size_t windowStyle = WindowStyle_Caption;
@@ -53,6 +63,14 @@ namespace et
 		bool shouldCreateRunLoop = true;
 		bool shouldSuspendOnDeactivate = currentPlatformIsMobile;
 		bool shouldPreserveRenderContext = false;
+
+		FramePacing framePacing = FramePacing::Precise;
+
+		/*
+		 * Interval of the fixed update in seconds, zero disables fixed updates
+		 */
+		double fixedTimeStep = 0.0;
+		uint32_t maxFixedStepsPerFrame = 8;
 	};
 	
 	class IApplicationDelegate
@@ -74,6 +92,12 @@ namespace et
 
 		virtual void applicationWillResizeContext(const et::vec2i&) { }
 
+		/*
+		 * Called zero or more times per frame with constant step (see ApplicationParameters::fixedTimeStep),
+		 * render could use Application::interpolationAlpha() to blend between simulation states
+		 */
+		virtual void fixedUpdate(float) { }
+
 		virtual void render(et::RenderContext*) { }
 	};
 }
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <mutex>
+#include <condition_variable>
 #include <et/threading/thread.h>
 #include <et/app/runloop.h>
 
@@ -20,13 +22,16 @@ namespace et
 		BackgroundRunLoop();
 		
 		void setOwner(BackgroundThread* owner);
-		void addTask(Task* t, float);
+		void wakeUp();
 		
 	private:
 		friend class BackgroundThread;
 		BackgroundThread* _owner;
 	};
 	
+	/*
+	 * Sleeps until a task is added or the next task / timer is due
+	 */
 	class BackgroundThread : public Thread
 	{
 	public:
@@ -34,11 +39,17 @@ namespace et
 		
 		RunLoop& runLoop()
 			{ return _runLoop; }
+
+		void resume();
 		
 	private:
 		uint64_t main();
+		void waitForEvents();
 		
 	private:
 		BackgroundRunLoop _runLoop;
+		std::mutex _wakeLock;
+		std::condition_variable _wakeCondition;
+		bool _wakeRequested = false;
 	};
 }
@@ -0,0 +1,67 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/core/et.h>
+
+namespace et
+{
+	/*
+	 * Distribution of frame times with 0.5 ms buckets,
+	 * frames longer than 64 ms are accumulated in the last bucket
+	 */
+	struct FrameTimeHistogram
+	{
+		enum : uint64_t
+		{
+			BucketWidthInMicroseconds = 500,
+			BucketsCount = 129,
+		};
+
+		uint64_t buckets[BucketsCount] = { };
+		uint64_t framesCount = 0;
+		uint64_t totalFrameTimeInMicroseconds = 0;
+		uint64_t minFrameTimeInMicroseconds = std::numeric_limits<uint64_t>::max();
+		uint64_t maxFrameTimeInMicroseconds = 0;
+
+		void addSample(uint64_t frameTimeInMicroseconds)
+		{
+			buckets[etMin(frameTimeInMicroseconds / BucketWidthInMicroseconds, uint64_t(BucketsCount - 1))] += 1;
+			totalFrameTimeInMicroseconds += frameTimeInMicroseconds;
+			minFrameTimeInMicroseconds = etMin(minFrameTimeInMicroseconds, frameTimeInMicroseconds);
+			maxFrameTimeInMicroseconds = etMax(maxFrameTimeInMicroseconds, frameTimeInMicroseconds);
+			++framesCount;
+		}
+
+		uint64_t averageFrameTimeInMicroseconds() const
+			{ return (framesCount > 0) ? totalFrameTimeInMicroseconds / framesCount : 0; }
+
+		/*
+		 * Returns upper bound of the bucket containing given percentile (0..1),
+		 * for example percentile(0.99f) for the 99th percentile frame time
+		 */
+		uint64_t percentile(float value) const
+		{
+			if (framesCount == 0)
+				return 0;
+
+			uint64_t threshold = static_cast<uint64_t>(std::ceil(clamp(value, 0.0f, 1.0f) * static_cast<float>(framesCount)));
+			uint64_t accumulated = 0;
+			for (uint64_t i = 0; i < BucketsCount - 1; ++i)
+			{
+				accumulated += buckets[i];
+				if ((accumulated > 0) && (accumulated >= threshold))
+					return (i + 1) * BucketWidthInMicroseconds;
+			}
+			return maxFrameTimeInMicroseconds;
+		}
+
+		void reset()
+			{ *this = FrameTimeHistogram(); }
+	};
+}
@@ -22,16 +22,29 @@ namespace et
 		virtual ~RunLoop();
 		
 		float time() const
+			{ return static_cast<float>(_time); }
+
+		/*
+		 * Active time in seconds, computed from integer nanoseconds
+		 * and does not lose precision with uptime
+		 */
+		double preciseTime() const
 			{ return _time; }
 		
 		uint64_t timeMSec() const
-			{ return _actualTimeMSec; }
+			{ return _actualTimeNSec / 1000000; }
+
+		uint64_t timeNSec() const
+			{ return _actualTimeNSec; }
 
 		TimerPool::Pointer& firstTimerPool()
 			{ return _timerPools.front(); }
 		
-		void updateTime(uint64_t t);
-		void update(uint64_t t);
+		void updateTime(uint64_t msec);
+		void update(uint64_t msec);
+
+		void updateTimeNSec(uint64_t nsec);
+		void updateNSec(uint64_t nsec);
 
 		void pause();
 		void resume();
@@ -40,17 +53,36 @@ namespace et
 		void detachTimerPool(const TimerPool::Pointer&);
 		void detachAllTimerPools();
 
-		virtual void addTask(Task*, float);
+		void addTask(Task*, float);
+		void addTask(TaskFunction, float);
 		
 		bool hasTasks()
 			{ return _taskPool.hasTasks(); }
 
+		double nextTaskTime()
+			{ return _taskPool.nextTaskTime(); }
+
+		TaskPool::Statistics taskStatistics() const
+			{ return _taskPool.statistics(); }
+
+		/*
+		 * Earliest time when any of the attached timer pools should be updated
+		 */
+		double nextTimerTime();
+
+		/*
+		 * Called when new task or timed object was scheduled,
+		 * run loops which are waiting for events should stop waiting
+		 */
+		virtual void wakeUp() { }
+
 	private:
 		std::vector<TimerPool::Pointer> _timerPools;
 		TaskPool _taskPool;
-		uint64_t _actualTimeMSec = 0;
-		uint64_t _activityTimeMSec = 0;
-		float _time = 0.0f;
+		uint64_t _actualTimeNSec = 0;
+		uint64_t _activityTimeNSec = 0;
+		uint64_t _activeTimeNSec = 0;
+		double _time = 0.0;
 		bool _started = false;
 		bool _active = true;
 	};
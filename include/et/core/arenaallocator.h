@@ -0,0 +1,155 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/core/et.h>
+
+namespace et
+{
+	/*
+	 * Linear (bump-pointer) allocator for short-lived temporary data.
+	 * Individual release is a no-op, memory is reclaimed by rewinding to a marker
+	 * or by resetting the whole arena. Not thread-safe, use one arena per thread.
+	 */
+	class ArenaAllocator : public MemoryAllocatorBase
+	{
+	public:
+		enum : size_t
+		{
+			defaultPageSize = 1024 * 1024,
+			defaultAlignment = 16,
+		};
+
+		struct Page;
+
+		struct Marker
+		{
+			Page* page = nullptr;
+			char* position = nullptr;
+			size_t previousPagesSize = 0;
+		};
+
+	public:
+		ArenaAllocator(size_t pageSize = defaultPageSize);
+		~ArenaAllocator();
+
+		void* allocate(size_t);
+		void* allocate(size_t, size_t alignment);
+		void release(void*);
+
+		bool validatePointer(void*, bool = true);
+
+		void printInfo() const;
+
+		Marker marker() const;
+		void rewind(const Marker&);
+
+		void reset();
+		void releaseUnusedPages();
+
+		size_t allocatedSize() const;
+
+		size_t capacity() const
+			{ return _capacity; }
+
+		size_t peakAllocatedSize() const
+			{ return _peakAllocatedSize; }
+
+	private:
+		Page* createPage(size_t);
+
+		ET_DENY_COPY(ArenaAllocator)
+
+	private:
+		Page* _firstPage = nullptr;
+		Page* _currentPage = nullptr;
+		size_t _pageSize = defaultPageSize;
+		size_t _previousPagesSize = 0;
+		size_t _capacity = 0;
+		size_t _peakAllocatedSize = 0;
+	};
+
+	/*
+	 * Remembers arena position on construction and rewinds to it on destruction
+	 */
+	class ArenaAllocatorScope
+	{
+	public:
+		ArenaAllocatorScope(ArenaAllocator& arena) :
+			_arena(arena), _marker(arena.marker()) { }
+
+		~ArenaAllocatorScope()
+			{ _arena.rewind(_marker); }
+
+		ArenaAllocator& arena()
+			{ return _arena; }
+
+	private:
+		ET_DENY_COPY(ArenaAllocatorScope)
+
+	private:
+		ArenaAllocator& _arena;
+		ArenaAllocator::Marker _marker;
+	};
+
+	/*
+	 * Per-thread arena. Arena of the main thread is reset by Application once per frame,
+	 * other threads should wrap their work into ArenaAllocatorScope.
+	 */
+	ArenaAllocator& threadFrameArena();
+
+	template <typename T>
+	struct ArenaAllocatorSTDProxy
+	{
+		using size_type = size_t;
+		using value_type = T;
+		using pointer = T*;
+
+		ArenaAllocatorSTDProxy() :
+			arena(&threadFrameArena()) { }
+
+		ArenaAllocatorSTDProxy(ArenaAllocator& a) :
+			arena(&a) { }
+
+		ArenaAllocatorSTDProxy(const ArenaAllocatorSTDProxy& r) :
+			arena(r.arena) { }
+
+		template<class U>
+		ArenaAllocatorSTDProxy(const ArenaAllocatorSTDProxy<U>& r) :
+			arena(r.arena) { }
+
+		pointer allocate(size_type n)
+		{
+			return reinterpret_cast<pointer>(arena->allocate(n * sizeof(T),
+				etMax(alignof(T), static_cast<size_t>(ArenaAllocator::defaultAlignment))));
+		}
+
+		void deallocate(pointer ptr, size_type)
+		{
+			arena->release(ptr);
+		}
+
+		bool operator == (const ArenaAllocatorSTDProxy<T>& r) const
+		{
+			return arena == r.arena;
+		}
+
+		bool operator != (const ArenaAllocatorSTDProxy<T>& r) const
+		{
+			return arena != r.arena;
+		}
+
+		template<class O>
+		struct rebind
+		{
+			typedef ArenaAllocatorSTDProxy<O> other;
+		};
+
+		ArenaAllocator* arena = nullptr;
+	};
+}
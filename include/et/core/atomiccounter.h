@@ -9,7 +9,7 @@
 
 namespace et
 {
-#if (ET_PLATFORM_IOS || ET_PLATFORM_MAC || ET_PLATFORM_ANDROID)
+#if (ET_PLATFORM_IOS || ET_PLATFORM_MAC || ET_PLATFORM_ANDROID || ET_PLATFORM_LINUX)
 	typedef int AtomicCounterType;
 #elif (ET_PLATFORM_WIN)
 	typedef long AtomicCounterType;
@@ -0,0 +1,34 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/core/et.h>
+#include <et/core/datastorage.h>
+
+namespace et
+{
+	namespace binary
+	{
+		/*
+		 * Compact binary encoding of the value tree:
+		 * header, table of unique strings (keys and string values) and the tree itself,
+		 * where each value is a type tag followed by its content. Lengths and integers are varints,
+		 * arrays of floats are stored as raw little-endian floats.
+		 */
+		BinaryDataStorage serialize(const et::Dictionary&);
+		BinaryDataStorage serialize(const et::ArrayValue&);
+
+		et::ValueBase::Pointer deserialize(const char*, size_t, et::ValueClass&, bool printErrors = true);
+		et::ValueBase::Pointer deserialize(const BinaryDataStorage&, et::ValueClass&, bool printErrors = true);
+
+		/*
+		 * Checks header, could be used to choose between binary and JSON deserialization
+		 */
+		bool isBinaryData(const char*, size_t);
+	}
+}
@@ -23,12 +23,17 @@ namespace et
 		return buffer;
 	}
 
+	/*
+	 * On Linux uint64_t is unsigned long, overload below is used
+	 */
+#if (!ET_PLATFORM_LINUX)
 	inline std::string intToStr(unsigned long value)
 	{
 		char buffer[32] = { };
 		sprintf(buffer, "%lu", value);
 		return buffer;
 	}
+#endif
 	
 	inline std::string intToStr(unsigned int value)
 	{
@@ -226,7 +226,10 @@ namespace et
 			if (ownsData())
 				sharedBlockAllocator().release(_mutableData);
 			
-			_flags |= DataStorageFlag_Mutable;
+			/*
+			 * Storage always owns newly allocated data, even if it was a view before
+			 */
+			_flags |= DataStorageFlag_OwnsMutableData;
 			_mutableData = new_data;
 		}
 		
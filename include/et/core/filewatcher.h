@@ -0,0 +1,51 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/core/et.h>
+
+namespace et
+{
+	/*
+	 * Watches set of files for changes. Uses inotify where available
+	 * (watching containing folders, so files replaced by rename are detected),
+	 * and falls back to comparing modification dates on every poll.
+	 * Paths which could not be watched natively (watches limit, removed folder)
+	 * are polled by date until their folder could be watched again.
+	 * Same path could be watched several times, it is reference counted.
+	 * Not thread safe, should be used from a single thread or under external lock.
+	 */
+	class FileWatcherPrivate;
+	class FileWatcher
+	{
+	public:
+		FileWatcher();
+		~FileWatcher();
+
+		void watch(const std::string& path);
+		void unwatch(const std::string& path);
+		void unwatchAll();
+
+		/*
+		 * Appends paths changed since previous call, each path is reported once
+		 */
+		void poll(StringList& changedPaths);
+
+		/*
+		 * Returns true if changes are delivered by the system,
+		 * so cost of poll() does not depend on amount of watched files
+		 */
+		bool usesNativeNotifications() const;
+
+		size_t watchedPathsCount() const;
+
+	private:
+		ET_DENY_COPY(FileWatcher)
+		ET_DECLARE_PIMPL(FileWatcher, 256)
+	};
+}
@@ -0,0 +1,181 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/core/et.h>
+#include <et/core/datastorage.h>
+#include <et/core/mappedfile.h>
+
+namespace et
+{
+	/*
+	 * Read-only view of a value stored in flat document.
+	 * Does not own any data, valid as long as document's buffer is alive.
+	 */
+	class FlatValue
+	{
+	public:
+		FlatValue() = default;
+
+		FlatValue(const char* base, uint32_t offset) :
+			_base(base), _offset(offset) { }
+
+		bool valid() const
+			{ return _base != nullptr; }
+
+		bool invalid() const
+			{ return _base == nullptr; }
+
+		ValueClass valueClass() const;
+
+		float floatValue(float def = 0.0f) const;
+		int64_t integerValue(int64_t def = 0) const;
+		bool booleanValue(bool def = false) const;
+
+		/*
+		 * Returns null-terminated string stored in document, or def if value is not a string
+		 */
+		const char* stringValue(const char* def = "") const;
+		size_t stringLength() const;
+
+		/*
+		 * Creates mutable copy of the value
+		 */
+		ValueBase::Pointer toValue() const;
+
+	protected:
+		uint32_t readUInt32(uint32_t offset) const;
+
+	protected:
+		const char* _base = nullptr;
+		uint32_t _offset = 0;
+	};
+
+	class FlatArray : public FlatValue
+	{
+	public:
+		FlatArray() = default;
+
+		explicit FlatArray(const FlatValue&);
+
+		size_t size() const;
+
+		bool empty() const
+			{ return size() == 0; }
+
+		FlatValue operator [] (size_t) const;
+
+		ArrayValue toArray() const;
+	};
+
+	class FlatDictionary : public FlatValue
+	{
+	public:
+		FlatDictionary() = default;
+
+		explicit FlatDictionary(const FlatValue&);
+
+		size_t size() const;
+
+		bool empty() const
+			{ return size() == 0; }
+
+		/*
+		 * Keys are stored sorted, so lookup is binary search
+		 */
+		FlatValue objectForKey(const char* key, size_t keyLength) const;
+
+		FlatValue objectForKey(const std::string& key) const
+			{ return objectForKey(key.data(), key.size()); }
+
+		bool hasKey(const std::string& key) const
+			{ return objectForKey(key).valid(); }
+
+		ValueClass valueClassForKey(const std::string& key) const
+			{ return objectForKey(key).valueClass(); }
+
+		int64_t integerForKey(const std::string& key, int64_t def = 0) const
+			{ return objectForKey(key).integerValue(def); }
+
+		float floatForKey(const std::string& key, float def = 0.0f) const
+			{ return objectForKey(key).floatValue(def); }
+
+		bool booleanForKey(const std::string& key, bool def = false) const
+			{ return objectForKey(key).booleanValue(def); }
+
+		const char* stringForKey(const std::string& key, const char* def = "") const
+			{ return objectForKey(key).stringValue(def); }
+
+		FlatArray arrayForKey(const std::string& key) const
+			{ return FlatArray(objectForKey(key)); }
+
+		FlatDictionary dictionaryForKey(const std::string& key) const
+			{ return FlatDictionary(objectForKey(key)); }
+
+		/*
+		 * Access by index, in order of sorted keys
+		 */
+		FlatValue keyAtIndex(size_t) const;
+		FlatValue valueAtIndex(size_t) const;
+
+		Dictionary toDictionary() const;
+	};
+
+	/*
+	 * Flat, offset-based encoding of the value tree. Could be queried directly from the buffer
+	 * (loaded or memory-mapped) without allocating any nodes. Buffer is validated once on construction.
+	 */
+	class FlatDocument
+	{
+	public:
+		static BinaryDataStorage build(const Dictionary&);
+		static BinaryDataStorage build(const ArrayValue&);
+
+		static bool isFlatData(const char*, size_t);
+
+	public:
+		FlatDocument() = default;
+
+		/*
+		 * References external buffer, which should outlive the document
+		 */
+		FlatDocument(const char* data, size_t size);
+
+		/*
+		 * Takes ownership of the buffer
+		 */
+		FlatDocument(BinaryDataStorage&& data);
+
+		/*
+		 * Queries are resolved directly against mapped memory, mapping is kept alive by document
+		 */
+		FlatDocument(MappedFile::Pointer file);
+
+		bool valid() const
+			{ return _root.valid(); }
+
+		FlatValue root() const
+			{ return _root; }
+
+		FlatDictionary rootDictionary() const
+			{ return FlatDictionary(_root); }
+
+		FlatArray rootArray() const
+			{ return FlatArray(_root); }
+
+	private:
+		ET_DENY_COPY(FlatDocument)
+
+		void validate(const char* data, size_t size);
+
+	private:
+		BinaryDataStorage _storage;
+		MappedFile::Pointer _mappedFile;
+		FlatValue _root;
+	};
+}
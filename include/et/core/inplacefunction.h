@@ -0,0 +1,250 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/core/et.h>
+
+namespace et
+{
+	template <typename Signature, size_t Capacity = 48>
+	class InplaceFunction;
+
+	/*
+	 * Type-erased callable, similar to std::function, which stores callables
+	 * up to Capacity bytes in place without touching the allocator.
+	 * Larger callables are allocated with etCreateObject.
+	 */
+	template <typename R, typename... Args, size_t Capacity>
+	class InplaceFunction<R(Args...), Capacity>
+	{
+	public:
+		enum : size_t
+		{
+			capacity = Capacity
+		};
+
+		template <typename F>
+		struct StoredInline
+		{
+			enum : bool
+			{
+				value = (sizeof(F) <= Capacity) && (alignof(F) <= alignof(std::max_align_t)) &&
+					std::is_nothrow_move_constructible<F>::value
+			};
+		};
+
+	public:
+		InplaceFunction() = default;
+
+		InplaceFunction(std::nullptr_t) { }
+
+		template <typename F, typename = typename std::enable_if<
+			!std::is_same<typename std::decay<F>::type, InplaceFunction>::value>::type>
+		InplaceFunction(F&& f)
+			{ assign(std::forward<F>(f)); }
+
+		InplaceFunction(const InplaceFunction& r)
+			{ copyFrom(r); }
+
+		InplaceFunction(InplaceFunction&& r)
+			{ moveFrom(r); }
+
+		~InplaceFunction()
+			{ reset(); }
+
+		InplaceFunction& operator = (const InplaceFunction& r)
+		{
+			if (this != &r)
+			{
+				reset();
+				copyFrom(r);
+			}
+			return *this;
+		}
+
+		InplaceFunction& operator = (InplaceFunction&& r)
+		{
+			if (this != &r)
+			{
+				reset();
+				moveFrom(r);
+			}
+			return *this;
+		}
+
+		InplaceFunction& operator = (std::nullptr_t)
+		{
+			reset();
+			return *this;
+		}
+
+		template <typename F, typename = typename std::enable_if<
+			!std::is_same<typename std::decay<F>::type, InplaceFunction>::value>::type>
+		InplaceFunction& operator = (F&& f)
+		{
+			reset();
+			assign(std::forward<F>(f));
+			return *this;
+		}
+
+		R operator () (Args... args) const
+		{
+			ET_ASSERT(_operations != nullptr);
+			return _operations->invoke(_storage, std::forward<Args>(args)...);
+		}
+
+		explicit operator bool () const
+			{ return _operations != nullptr; }
+
+		bool valid() const
+			{ return _operations != nullptr; }
+
+		bool storedInline() const
+			{ return (_operations != nullptr) && _operations->storedInline; }
+
+		void reset()
+		{
+			if (_operations != nullptr)
+			{
+				_operations->destroy(_storage);
+				_operations = nullptr;
+			}
+		}
+
+		/*
+		 * Returns stored callable, type should match the one used for assignment
+		 */
+		template <typename F>
+		F* target()
+			{ return (_operations == nullptr) ? nullptr : static_cast<F*>(_operations->target(_storage)); }
+
+	private:
+		struct Operations
+		{
+			R (*invoke)(void*, Args&&...);
+			void (*copy)(void*, const void*);
+			void (*move)(void*, void*);
+			void (*destroy)(void*);
+			void* (*target)(void*);
+			bool storedInline;
+		};
+
+		template <typename F>
+		struct InlineOperations
+		{
+			static R invoke(void* s, Args&&... args)
+				{ return (*static_cast<F*>(s))(std::forward<Args>(args)...); }
+
+			static void copy(void* d, const void* s)
+				{ new (d) F(*static_cast<const F*>(s)); }
+
+			static void move(void* d, void* s)
+			{
+				new (d) F(std::move(*static_cast<F*>(s)));
+				static_cast<F*>(s)->~F();
+			}
+
+			static void destroy(void* s)
+				{ static_cast<F*>(s)->~F(); }
+
+			static void* target(void* s)
+				{ return s; }
+
+			static const Operations operations;
+		};
+
+		template <typename F>
+		struct HeapOperations
+		{
+			static F*& object(void* s)
+				{ return *static_cast<F**>(s); }
+
+			static R invoke(void* s, Args&&... args)
+				{ return (*object(s))(std::forward<Args>(args)...); }
+
+			static void copy(void* d, const void* s)
+				{ object(d) = etCreateObject<F>(*object(const_cast<void*>(s))); }
+
+			static void move(void* d, void* s)
+			{
+				object(d) = object(s);
+				object(s) = nullptr;
+			}
+
+			static void destroy(void* s)
+				{ etDestroyObject(object(s)); }
+
+			static void* target(void* s)
+				{ return object(s); }
+
+			static const Operations operations;
+		};
+
+		template <typename F>
+		void assign(F&& f)
+		{
+			using T = typename std::decay<F>::type;
+			assign<T>(std::forward<F>(f), std::integral_constant<bool, StoredInline<T>::value>());
+		}
+
+		template <typename T, typename F>
+		void assign(F&& f, std::true_type)
+		{
+			new (_storage) T(std::forward<F>(f));
+			_operations = &InlineOperations<T>::operations;
+		}
+
+		template <typename T, typename F>
+		void assign(F&& f, std::false_type)
+		{
+			*reinterpret_cast<T**>(_storage) = etCreateObject<T>(std::forward<F>(f));
+			_operations = &HeapOperations<T>::operations;
+		}
+
+		void copyFrom(const InplaceFunction& r)
+		{
+			if (r._operations != nullptr)
+			{
+				r._operations->copy(_storage, r._storage);
+				_operations = r._operations;
+			}
+		}
+
+		void moveFrom(InplaceFunction& r)
+		{
+			if (r._operations != nullptr)
+			{
+				r._operations->move(_storage, r._storage);
+				_operations = r._operations;
+				r._operations = nullptr;
+			}
+		}
+
+	private:
+		alignas(std::max_align_t) mutable char _storage[Capacity];
+		const Operations* _operations = nullptr;
+	};
+
+	template <typename R, typename... Args, size_t Capacity>
+	template <typename F>
+	const typename InplaceFunction<R(Args...), Capacity>::Operations
+		InplaceFunction<R(Args...), Capacity>::InlineOperations<F>::operations =
+	{
+		&InlineOperations<F>::invoke, &InlineOperations<F>::copy, &InlineOperations<F>::move,
+		&InlineOperations<F>::destroy, &InlineOperations<F>::target, true
+	};
+
+	template <typename R, typename... Args, size_t Capacity>
+	template <typename F>
+	const typename InplaceFunction<R(Args...), Capacity>::Operations
+		InplaceFunction<R(Args...), Capacity>::HeapOperations<F>::operations =
+	{
+		&HeapOperations<F>::invoke, &HeapOperations<F>::copy, &HeapOperations<F>::move,
+		&HeapOperations<F>::destroy, &HeapOperations<F>::target, false
+	};
+}
@@ -25,10 +25,59 @@ namespace et
 			virtual void info(const char*, va_list) { }
 			virtual void warning(const char*, va_list) { }
 			virtual void error(const char*, va_list) { }
+
+			/*
+			 * Called by asynchronous writer after each batch of messages
+			 */
+			virtual void flush() { }
 		};
 		
 		void addOutput(Output::Pointer);
 		void removeOutput(Output::Pointer);
+
+		/*
+		 * Asynchronous output: messages are formatted on the calling thread into per-thread
+		 * lock-free ring buffers and passed to outputs by background thread in batches.
+		 * Outputs should be added before enabling asynchronous output.
+		 * Messages up to 500 characters are formatted directly into the ring buffer,
+		 * longer ones are not truncated, but require an additional allocation.
+		 */
+		enum class Level : uint32_t
+		{
+			Debug,
+			Info,
+			Warning,
+			Error
+		};
+
+		enum class OverflowPolicy : uint32_t
+		{
+			Drop,
+			Block
+		};
+
+		struct AsyncOutputOptions
+		{
+			size_t messagesPerThread = 256;
+			uint32_t flushIntervalMSec = 100;
+			OverflowPolicy overflowPolicy = OverflowPolicy::Drop;
+		};
+
+		void enableAsyncOutput(const AsyncOutputOptions& = AsyncOutputOptions());
+		void disableAsyncOutput();
+		bool asyncOutputEnabled();
+
+		/*
+		 * Blocks until messages logged before the call are passed to outputs
+		 */
+		void flushAsyncOutput();
+
+		uint64_t droppedMessagesCount();
+
+		/*
+		 * Used by log functions, returns false if message should be passed to outputs directly
+		 */
+		bool pushAsyncMessage(Level, const char*, va_list);
 		
 		class FileOutput : public Output
 		{
@@ -45,6 +94,8 @@ namespace et
 			void info(const char*, va_list);
 			void warning(const char*, va_list);
 			void error(const char*, va_list);
+
+			void flush();
 			
 		private:
 			FILE* _file = nullptr;
@@ -0,0 +1,118 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <streambuf>
+#include <et/core/datastorage.h>
+
+namespace et
+{
+	/*
+	 * Memory mapping of the whole file. Mapping silently fails for missing, empty
+	 * or packed (for example, inside of apk) files, so callers should check valid() and fall back to InputStream.
+	 * Views returned from the file do not own memory and should not outlive it.
+	 * Copy-on-write mapping allows modifying data in place, changes are private and never reach the file.
+	 */
+	class MappedFile : public Shared
+	{
+	public:
+		ET_DECLARE_POINTER(MappedFile)
+
+		enum class Access
+		{
+			Normal,
+			Sequential,
+			Random,
+			WillNeed,
+			DontNeed
+		};
+
+		enum class Protection
+		{
+			ReadOnly,
+			CopyOnWrite
+		};
+
+	public:
+		MappedFile(const std::string& path, Access access = Access::Sequential,
+			Protection protection = Protection::ReadOnly);
+		~MappedFile();
+
+		bool valid() const
+			{ return _data != nullptr; }
+
+		const char* data() const
+			{ return _data; }
+
+		size_t size() const
+			{ return _size; }
+
+		BinaryDataStorage view() const
+			{ return view(0, _size); }
+
+		BinaryDataStorage view(size_t offset, size_t size) const;
+
+		/*
+		 * Available only for copy-on-write mappings, returns empty storage otherwise
+		 */
+		BinaryDataStorage mutableView(size_t offset, size_t size);
+
+		Protection protection() const
+			{ return _protection; }
+
+		/*
+		 * Hints for the kernel about access pattern (madvise), no-op where not supported
+		 */
+		void advise(Access access) const
+			{ advise(access, 0, _size); }
+
+		void advise(Access, size_t offset, size_t size) const;
+
+	private:
+		ET_DENY_COPY(MappedFile)
+
+	private:
+		const char* _data = nullptr;
+		size_t _size = 0;
+		Protection _protection = Protection::ReadOnly;
+	};
+
+	/*
+	 * Stream buffer over memory range, supports seeking and bulk reads without copying into intermediate buffer
+	 */
+	class MemoryStreamBuffer : public std::streambuf
+	{
+	public:
+		MemoryStreamBuffer(const char* data, size_t size);
+
+	protected:
+		pos_type seekoff(off_type, std::ios_base::seekdir, std::ios_base::openmode) override;
+		pos_type seekpos(pos_type, std::ios_base::openmode) override;
+		std::streamsize xsgetn(char_type*, std::streamsize) override;
+		std::streamsize showmanyc() override;
+	};
+
+	/*
+	 * Input stream for loaders taking std::istream, reads directly from mapped file
+	 */
+	class MappedFileStream : public std::istream
+	{
+	public:
+		MappedFileStream(MappedFile::Pointer);
+
+		const MappedFile::Pointer& file() const
+			{ return _file; }
+
+	private:
+		ET_DENY_COPY(MappedFileStream)
+
+	private:
+		MappedFile::Pointer _file;
+		MemoryStreamBuffer _buffer;
+	};
+}
@@ -80,17 +80,14 @@ namespace et
 	
 	class DefaultMemoryAllocator : public MemoryAllocatorBase
 	{
-		void* release(size_t sz)
-			{ return malloc(sz); }
-		
-		void release(void* ptr)
-			{ ::free(ptr); }
+	public:
+		void* allocate(size_t);
+		void release(void*);
 		
 		bool validatePointer(void*, bool = true)
 			{ return true; }
 		
-		void printInfo() const
-			{ log::info("Not available for DefaultMemoryAllocator"); }
+		void printInfo() const;
 	};
 	
 	class BlockMemoryAllocatorPrivate;
@@ -111,6 +108,6 @@ namespace et
 				
 	private:
 		BlockMemoryAllocatorPrivate* _private = nullptr;
-		char _privateData[256];
+		char _privateData[1024];
 	};
 }
@@ -0,0 +1,113 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/core/et.h>
+
+#define ET_MEMORY_TAG_VARIABLE_IMPL(NAME, LINE)		NAME##LINE
+#define ET_MEMORY_TAG_VARIABLE(NAME, LINE)			ET_MEMORY_TAG_VARIABLE_IMPL(NAME, LINE)
+
+/*
+ * Attributes allocations made in the current scope (and current thread) to a named tag:
+ *	ET_MEMORY_TAG("json");
+ */
+#define ET_MEMORY_TAG(NAME)	\
+	static const uint32_t ET_MEMORY_TAG_VARIABLE(etMemoryTagIndex, __LINE__) = et::memory::registerTag(NAME); \
+	et::memory::TagScope ET_MEMORY_TAG_VARIABLE(etMemoryTagScope, __LINE__)(ET_MEMORY_TAG_VARIABLE(etMemoryTagIndex, __LINE__))
+
+namespace et
+{
+	namespace memory
+	{
+		enum : uint32_t
+		{
+			MaxTagsCount = 64,
+			MaxTagNameLength = 32,
+			MaxCallStackDepth = 24,
+
+			DefaultTag = 0,
+			NotAccountedTag = 0xff,
+		};
+
+		struct TagStatistics
+		{
+			std::string name;
+			int64_t currentBytes = 0;
+			int64_t peakBytes = 0;
+			int64_t liveAllocations = 0;
+			uint64_t totalAllocations = 0;
+		};
+
+		struct CallStackSample
+		{
+			void* pointer = nullptr;
+			size_t size = 0;
+			uint32_t tag = DefaultTag;
+			uint32_t depth = 0;
+			void* frames[MaxCallStackDepth] = { };
+		};
+
+		/*
+		 * Returns index for tag with given name, registering it on the first call.
+		 * Returns DefaultTag if there is no space for new tags.
+		 */
+		uint32_t registerTag(const char* name);
+		std::string tagName(uint32_t);
+
+		uint32_t currentTag();
+		uint32_t setCurrentTag(uint32_t);
+
+		/*
+		 * Accounting is enabled by default and only costs a few atomic
+		 * operations per allocation; sampling is disabled by default
+		 */
+		void setAccountingEnabled(bool);
+		bool accountingEnabled();
+
+		/*
+		 * Captures call stack for every N-th accounted allocation, 0 disables capturing
+		 */
+		void setCallStackSamplingInterval(uint32_t);
+		uint32_t callStackSamplingInterval();
+
+		/*
+		 * Returns tag which should be stored with new allocation
+		 */
+		uint32_t tagForNewAllocation();
+
+		void recordAllocation(uint32_t tag, size_t size, void* ptr);
+		void recordDeallocation(uint32_t tag, size_t size, void* ptr);
+
+		std::vector<TagStatistics> tagStatistics();
+		std::vector<CallStackSample> liveCallStackSamples();
+
+		void printTagStatistics();
+		void printCallStackSamples();
+
+		std::string snapshotJson(size_t serializationFlags = 0);
+
+		class TagScope
+		{
+		public:
+			TagScope(uint32_t tag) :
+				_previousTag(setCurrentTag(tag)) { }
+
+			TagScope(const char* name) :
+				_previousTag(setCurrentTag(registerTag(name))) { }
+
+			~TagScope()
+				{ setCurrentTag(_previousTag); }
+
+		private:
+			ET_DENY_COPY(TagScope)
+
+		private:
+			uint32_t _previousTag = DefaultTag;
+		};
+	}
+}
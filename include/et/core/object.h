@@ -60,6 +60,12 @@ namespace et
 
 		bool canBeReloaded() const
 			{ return !(_origin.empty() && _distributedOrigins.empty()); }
+
+		/*
+		 * Amount of memory (including API resources) held by object, used by ObjectsCache budget
+		 */
+		virtual uint64_t estimatedMemoryUsage() const
+			{ return 0; }
 	
 	private:
 		std::string _origin;
@@ -74,5 +80,13 @@ namespace et
 	public:
 		virtual ~ObjectLoader() { }
 		virtual void reloadObject(LoadableObject::Pointer, ObjectsCache&) = 0;
+
+		/*
+		 * Loaders which are able to decode data in background should start reloading
+		 * and return true, then call ObjectsCache::objectDidReload from the main run loop
+		 * after object was updated. Returning false makes cache call reloadObject instead.
+		 */
+		virtual bool reloadObjectAsync(LoadableObject::Pointer, ObjectsCache&)
+			{ return false; }
 	};
 }
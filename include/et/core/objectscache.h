@@ -7,8 +7,10 @@
 
 #pragma once
 
+#include <list>
 #include <unordered_map>
 #include <et/core/et.h>
+#include <et/core/filewatcher.h>
 #include <et/threading/criticalsection.h>
 #include <et/timers/timedobject.h>
 
@@ -16,6 +18,22 @@ namespace et
 {
 	class ObjectsCache : public TimedObject
 	{
+	public:
+		struct ReloadStatistics
+		{
+			uint64_t reloadsStarted = 0;
+			uint64_t reloadsCompleted = 0;
+			uint64_t asyncReloads = 0;
+			uint64_t coalescedNotifications = 0;
+
+			/*
+			 * Time from detecting change to completing reload, in microseconds
+			 */
+			uint64_t lastLatency = 0;
+			uint64_t peakLatency = 0;
+			uint64_t totalLatency = 0;
+		};
+
 	public:
 		ObjectsCache();
 		~ObjectsCache();
@@ -36,6 +54,31 @@ namespace et
 		uint64_t getFileProperty(const std::string& p);
 		uint64_t getObjectProperty(LoadableObject::Pointer);
 
+		/*
+		 * When memory usage exceeds the budget, objects which are not referenced
+		 * outside of the cache are evicted, least recently used first. Zero means no limit.
+		 */
+		void setMemoryBudget(uint64_t);
+
+		uint64_t memoryBudget() const
+			{ return _memoryBudget.load(); }
+
+		uint64_t memoryUsage() const
+			{ return _memoryUsage.load(); }
+
+		/*
+		 * Re-reads estimated memory usage of the object, should be called when it changes
+		 */
+		void updateMemoryUsage(const LoadableObject::Pointer&);
+
+		/*
+		 * Should be called by loaders from the main run loop when asynchronous reload is finished
+		 * (successfully or not). If object was changed again in the meantime, reload is restarted.
+		 */
+		void objectDidReload(const LoadableObject::Pointer&);
+
+		ReloadStatistics reloadStatistics();
+
 	private:
 		ET_DENY_COPY(ObjectsCache)
 
@@ -48,6 +91,15 @@ namespace et
 			LoadableObject::Pointer object;
 			ObjectLoader::Pointer loader;
 			std::unordered_map<std::string, uint64_t> identifiers;
+			uint64_t memoryUsage = 0;
+			uint64_t lastAccess = 0;
+
+			/*
+			 * Intrusive recently used list of the shard, most recent first
+			 */
+			const std::string* key = nullptr;
+			ObjectProperty* lruPrevious = nullptr;
+			ObjectProperty* lruNext = nullptr;
 
 			ObjectProperty()
 				{ }
@@ -56,7 +108,10 @@ namespace et
 				object(o), loader(l) { }
 		};
 		
-		typedef std::vector
+		/*
+		 * List keeps addresses of the properties stable for the recently used list
+		 */
+		typedef std::list
 		<
 			ObjectProperty
 		> ObjectPropertyList;
@@ -70,8 +125,67 @@ namespace et
 			SharedBlockAllocatorSTDProxy< std::pair<const std::string, ObjectPropertyList> >
 		> ObjectMap;
 
+		/*
+		 * Watched file -> keys of the objects which depend on it, with reference counts
+		 */
+		typedef std::unordered_map
+		<
+			std::string,
+			std::unordered_map<std::string, size_t>
+		> DependencyMap;
+
+		/*
+		 * Objects are distributed between shards by key, so lookups from
+		 * different threads rarely contend. Lock order: shard, then _lock.
+		 */
+		struct Shard
+		{
+			CriticalSection lock;
+			ObjectMap objects;
+			ObjectProperty* lruHead = nullptr;
+			ObjectProperty* lruTail = nullptr;
+
+			void link(ObjectProperty&);
+			void unlink(ObjectProperty&);
+			void touch(ObjectProperty&, uint64_t accessTime);
+			ObjectProperty* leastRecentlyUsedCandidate();
+		};
+
+		enum : size_t
+		{
+			ShardsCount = 16
+		};
+
+		Shard& shardForKey(const std::string&);
+
+		void watchObject(const std::string& key, ObjectProperty&);
+		void unwatchObject(const std::string& key, const ObjectProperty&);
+		void forgetObject(Shard&, const std::string& key, ObjectProperty&);
+		void enforceMemoryBudget();
+
+		void startReload(const std::string& key, LoadableObject::Pointer, ObjectLoader::Pointer);
+		void refreshReloadedObject(const std::string& key, const LoadableObject::Pointer&);
+
+		struct PendingReload
+		{
+			std::string key;
+			LoadableObject::Pointer object;
+			ObjectLoader::Pointer loader;
+			uint64_t startTime = 0;
+			bool changedAgain = false;
+		};
+
+		Shard _shards[ShardsCount];
+
 		CriticalSection _lock;
-		ObjectMap _objects;
+		DependencyMap _dependencies;
+		FileWatcher _watcher;
+		std::unordered_map<const LoadableObject*, PendingReload> _pendingReloads;
+		ReloadStatistics _reloadStatistics;
+
+		std::atomic<uint64_t> _memoryUsage{0};
+		std::atomic<uint64_t> _memoryBudget{0};
+		std::atomic<uint64_t> _accessCounter{0};
 		float _updateTime = 0.0f;
 	};
 }
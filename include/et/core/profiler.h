@@ -0,0 +1,90 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/core/et.h>
+
+#define ET_PROFILE_ZONE_VARIABLE_IMPL(NAME, LINE)	NAME##LINE
+#define ET_PROFILE_ZONE_VARIABLE(NAME, LINE)		ET_PROFILE_ZONE_VARIABLE_IMPL(NAME, LINE)
+
+/*
+ * Records time spent in the current scope, name should be a string literal:
+ *	ET_PROFILE_ZONE("scene::load");
+ */
+#define ET_PROFILE_ZONE(NAME)	\
+	et::profiler::ZoneScope ET_PROFILE_ZONE_VARIABLE(etProfileZone, __LINE__)(NAME)
+
+#define ET_PROFILE_FUNCTION()	ET_PROFILE_ZONE(__FUNCTION__)
+
+namespace et
+{
+	namespace profiler
+	{
+		enum : uint32_t
+		{
+			DefaultZonesPerThread = 65536,
+		};
+
+		/*
+		 * Profiling is disabled by default, disabled zone costs one relaxed atomic load.
+		 * Every thread records zones into its own buffer, zones which do not fit are dropped.
+		 */
+		void setEnabled(bool);
+		bool enabled();
+
+		/*
+		 * Applies to buffers of threads which did not record anything yet (or after clear)
+		 */
+		void setZonesPerThread(uint32_t);
+
+		void setCurrentThreadName(const char*);
+
+		/*
+		 * Discards recorded zones, could be called while profiling is enabled
+		 */
+		void clear();
+
+		uint64_t recordedZonesCount();
+		uint64_t droppedZonesCount();
+
+		/*
+		 * Chrome trace event format, could be opened in chrome://tracing or Perfetto
+		 */
+		std::string chromeTrace();
+		bool exportChromeTrace(const std::string& fileName);
+
+		uint64_t beginZone();
+		void endZone(const char* name, uint64_t beginTime);
+
+		extern std::atomic<bool> profilingEnabled;
+
+		class ZoneScope
+		{
+		public:
+			ZoneScope(const char* name) :
+				_name(name)
+			{
+				if (profilingEnabled.load(std::memory_order_relaxed))
+					_beginTime = beginZone();
+			}
+
+			~ZoneScope()
+			{
+				if (_beginTime > 0)
+					endZone(_name, _beginTime);
+			}
+
+		private:
+			ET_DENY_COPY(ZoneScope)
+
+		private:
+			const char* _name = nullptr;
+			uint64_t _beginTime = 0;
+		};
+	}
+}
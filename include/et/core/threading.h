@@ -28,5 +28,6 @@ namespace et
 		
 		void sleep(float seconds);
 		void sleepMSec(uint64_t msec);
+		void sleepUSec(uint64_t usec);
 	}
 }
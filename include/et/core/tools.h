@@ -18,6 +18,11 @@ namespace et
 	
 	uint64_t queryCurrentTimeInMicroSeconds();
 
+	/*
+	 * Monotonic clock with nanosecond resolution, not affected by system time changes
+	 */
+	uint64_t queryContiniousTimeInNanoSeconds();
+
 	/**
 	 * Returns device's screen size in native units.
 	 * For Retina screens returns size in points
@@ -11,7 +11,7 @@
 
 #if (ET_PLATFORM_IOS)
 #	include "vector4-simd.neon.h"
-#elif (ET_PLATFORM_MAC || ET_PLATFORM_WIN)
+#elif (ET_PLATFORM_MAC || ET_PLATFORM_WIN) || (ET_PLATFORM_LINUX && (defined(__x86_64__) || defined(__i386__)))
 #	include "vector4-simd.sse.h"
 #else
 #	error Unsupported platform selected
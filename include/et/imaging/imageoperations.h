@@ -16,6 +16,16 @@ namespace et
 	public:
 		virtual void applyRGBA(vec4ub& pixel, void* context) = 0;
 		virtual ~PixelFilter() { }
+
+		/*
+		 * Called for every row of the image (from several threads at once for concurrent
+		 * filters of ImagePipeline), override to avoid virtual call per pixel
+		 */
+		virtual void applyRGBARow(vec4ub* pixels, size_t count, void* context)
+		{
+			for (size_t i = 0; i < count; ++i)
+				applyRGBA(pixels[i], context);
+		}
 	};
 
 	enum ImageBlendType
@@ -24,10 +34,16 @@ namespace et
 		ImageBlendType_Additive
 	};
 
+	/*
+	 * Average - box filter,
+	 * Linear - triangle filter (two box passes),
+	 * Gaussian - approximated with three box passes, radius is treated as three standard deviations
+	 */
 	enum ImageBlurType
 	{
 		ImageBlurType_Average,
-		ImageBlurType_Linear
+		ImageBlurType_Linear,
+		ImageBlurType_Gaussian
 	};
 
 	enum ImageFilteringType
@@ -36,6 +52,10 @@ namespace et
 		ImageFilteringType_Linear
 	};
 
+	/*
+	 * Transfer, draw, fill, pixel, matrix and normal map filters are single stage ImagePipeline,
+	 * use it directly to run several of them in sequence
+	 */
 	class ImageOperations
 	{
 	public:
@@ -55,7 +75,21 @@ namespace et
 		static void applyPixelFilter(BinaryDataStorage& data, const vec2i& size, int components, PixelFilter* filter, void* context);
 		static void applyMatrixFilter(BinaryDataStorage& data, const vec2i& size, int components, const mat3i& m);
 
-		static void blur(BinaryDataStorage& data, const vec2i& size, int components, vec2i direction, int radius, ImageBlurType type);
+		/*
+		 * Blur uses running sums, so cost per pixel does not depend on radius.
+		 * Direction should be (1, 0) or (0, 1), overloads without direction blur in both.
+		 * Rows (or blocks of columns) are processed in parallel by the job system,
+		 * scratch is used for line buffers, it is resized when needed and could be reused between calls.
+		 */
+		static void blur(BinaryDataStorage& data, const vec2i& size, int components, vec2i direction, int radius,
+			ImageBlurType type, FloatDataStorage* scratch = nullptr);
+		static void blur(FloatDataStorage& data, const vec2i& size, int components, vec2i direction, int radius,
+			ImageBlurType type, FloatDataStorage* scratch = nullptr);
+		static void blur(BinaryDataStorage& data, const vec2i& size, int components, int radius,
+			ImageBlurType type, FloatDataStorage* scratch = nullptr);
+		static void blur(FloatDataStorage& data, const vec2i& size, int components, int radius,
+			ImageBlurType type, FloatDataStorage* scratch = nullptr);
+
 		static void median(BinaryDataStorage& data, const vec2i& size, int components, int radius);
 
 		static void normalMapFilter(BinaryDataStorage& data, const vec2i& size, int components, const vec2& scale);
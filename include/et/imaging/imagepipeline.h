@@ -0,0 +1,70 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/imaging/imageoperations.h>
+
+namespace et
+{
+	class ImagePipelineStage;
+
+	/*
+	 * Chains image operations and runs them over tiles in parallel (on the job system),
+	 * so intermediate results stay in cache instead of passing through the whole image each time.
+	 * Results match the same sequence of ImageOperations calls.
+	 *
+	 * Sources of transfer / draw stages and pixel filters are only referenced,
+	 * they should stay alive until execute() and should not be the processed image.
+	 *
+	 * Pixel filters are called from the calling thread, row by row over the whole image,
+	 * so the pipeline is split at them. Concurrent filters are processed within tiles instead:
+	 * they are called from several threads and could be called more than once for pixels
+	 * near tile borders, so they should not keep any state.
+	 */
+	class ImagePipeline
+	{
+	public:
+		ImagePipeline(const vec2i& size, int components);
+		~ImagePipeline();
+
+		ImagePipeline& transfer(const BinaryDataStorage& src, const vec2i& srcSize, int srcComponents, const vec2i& position);
+
+		ImagePipeline& draw(const BinaryDataStorage& src, const vec2i& srcSize, int srcComponents, const recti& destRect,
+			ImageBlendType blend, ImageFilteringType filter);
+
+		ImagePipeline& fill(const recti& r, const vec4ub& color);
+
+		ImagePipeline& pixelFilter(PixelFilter* filter, void* context, bool concurrent = false);
+		ImagePipeline& matrixFilter(const mat3i& m);
+		ImagePipeline& normalMapFilter(const vec2& scale);
+
+		void execute(BinaryDataStorage& data);
+
+		void clear();
+
+		size_t stagesCount() const
+			{ return _stages.size(); }
+
+		const vec2i& size() const
+			{ return _size; }
+
+		int components() const
+			{ return _components; }
+
+	private:
+		ImagePipeline& addStage(ImagePipelineStage*);
+		void executeTiled(size_t firstStage, size_t lastStage, const std::vector<recti>& tiles, BinaryDataStorage& data);
+
+		ET_DENY_COPY(ImagePipeline)
+
+	private:
+		std::vector<IntrusivePtr<ImagePipelineStage>> _stages;
+		vec2i _size;
+		int _components = 0;
+	};
+}
@@ -46,6 +46,11 @@ namespace et
 		Texture::Pointer texture;
 		TextureLoaderDelegate* delegate = nullptr;
 
+		/*
+		 * Set when request reloads texture managed by cache
+		 */
+		ObjectsCache* reloadingCache = nullptr;
+
 		TextureLoadingRequest(const std::string& name, const Texture::Pointer& tex, TextureLoaderDelegate* d);
 		~TextureLoadingRequest();
 		
@@ -69,10 +74,12 @@ namespace et
 		~TextureLoadingThread();
 
 		void addRequest(const std::string& fileName, Texture::Pointer texture, TextureLoaderDelegate* delegate);
+		void addReloadRequest(const std::string& fileName, Texture::Pointer texture, ObjectsCache& cache);
 
 	private:
 		uint64_t main();
 		TextureLoadingRequest* dequeRequest();
+		void enqueueRequest(TextureLoadingRequest*);
 
 	private:
 		TextureLoadingThreadDelegate* _delegate;
@@ -22,8 +22,16 @@ namespace et
 		std::string serialize(const et::Dictionary&, size_t = 0);
 		std::string serialize(const et::ArrayValue&, size_t = 0);
 		
+		/*
+		 * Single pass parser, which builds values directly from the input
+		 */
 		et::ValueBase::Pointer deserialize(const char*, size_t, et::ValueClass&, bool printErrors = true);
 		et::ValueBase::Pointer deserialize(const char*, et::ValueClass&, bool printErrors = true);
 		et::ValueBase::Pointer deserialize(const std::string&, et::ValueClass&, bool printErrors = true);
+
+		/*
+		 * Parses into jansson tree first and then converts it, kept for reference and comparison
+		 */
+		et::ValueBase::Pointer deserializeWithJansson(const char*, size_t, et::ValueClass&, bool printErrors = true);
 	}
 }
@@ -38,6 +38,18 @@ namespace et
 		s3d::ElementContainer::Pointer load(et::RenderContext*, s3d::Storage&, ObjectsCache&);
 		void loadAsync(et::RenderContext*, s3d::Storage&, ObjectsCache& cahce);
 
+		/*
+		 * Reads geometry from file into vertex storage and index array,
+		 * without resolving file name, loading materials or creating rendering objects.
+		 */
+		void parse();
+
+		const VertexStorage::Pointer& vertexStorage() const
+			{ return _vertexData; }
+
+		const IndexArray::Pointer& indexArray() const
+			{ return _indices; }
+
 		ET_DECLARE_EVENT1(loaded, s3d::ElementContainer::Pointer)
 
 	private:
@@ -49,10 +61,10 @@ namespace et
 			uint32_t start = 0;
 			uint32_t count = 0;
 			et::vec3 center;
-			s3d::Material::Pointer material;
+			std::string materialName;
 
-			OBJMeshIndexBounds(const std::string& n, uint32_t s, uint32_t c, s3d::Material::Pointer m, const vec3& aCenter) :
-				name(n), start(s), count(c), material(m), center(aCenter) { }
+			OBJMeshIndexBounds(const std::string& n, uint32_t s, uint32_t c, const std::string& m, const vec3& aCenter) :
+				name(n), start(s), count(c), center(aCenter), materialName(m) { }
 		};
 		typedef std::vector<OBJMeshIndexBounds> OBJMeshIndexBoundsList;
 		typedef std::vector<OBJVertex> VertexList;
@@ -85,7 +97,7 @@ namespace et
 		};
 
 	private:
-		void loadData(bool async, s3d::Storage&, ObjectsCache& cache);
+		void loadData();
 		void processLoadedData();
 		
 		s3d::ElementContainer::Pointer generateVertexBuffers(s3d::Storage&);
@@ -104,8 +116,9 @@ namespace et
 		std::ifstream inputFile;
 		std::ifstream materialFile;
 
-		s3d::Material::Pointer _lastMaterial;
+		IntrusivePtr<s3d::Material> _lastMaterial;
 		s3d::Material::List _materials;
+		StringList _materialLibraries;
 		OBJMeshIndexBoundsList _meshes;
 		
         IndexArray::Pointer _indices;
@@ -54,6 +54,11 @@
 #	define ET_PLATFORM_ANDROID			1
 #	define CurrentPlatform				Platform_Android
 #
+#elif defined(__linux__)
+#
+#	define ET_PLATFORM_LINUX			1
+#	define CurrentPlatform				Platform_Linux
+#
 #else
 #
 #	error Unable to determine current platform
@@ -94,7 +99,8 @@ namespace et
 		Platform_Windows,
 		Platform_iOS,
 		Platform_Mac,
-		Platform_Android
+		Platform_Android,
+		Platform_Linux
 	};
 	
 	enum Architecture
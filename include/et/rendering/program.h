@@ -88,7 +88,9 @@ namespace et
 		void setUniform(int, uint32_t, const uint32_t, bool);
 		void setUniform(int, uint32_t, const int64_t, bool);
 		void setUniform(int, uint32_t, const uint64_t, bool);
+#	if (!ET_PLATFORM_LINUX) /* On Linux uint64_t is unsigned long */
 		void setUniform(int, uint32_t, const unsigned long, bool);
+#	endif
 		
 		void setUniform(int, uint32_t, const float, bool force = false);
 		
@@ -19,6 +19,7 @@
 #include <et/rendering/vertexbufferfactory.h>
 #include <et/timers/notifytimer.h>
 #include <et/app/events.h>
+#include <et/app/frametimehistogram.h>
 
 namespace et
 {
@@ -31,6 +32,7 @@ namespace et
 		size_t averageDIPPerSecond = 0;
 		size_t averagePolygonsPerSecond = 0;
 		uint64_t averageFrameTimeInMicroseconds = 0;
+		FrameTimeHistogram frameTimeHistogram;
 	};
 
 	class RenderContextPrivate;
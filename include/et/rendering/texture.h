@@ -74,6 +74,12 @@ namespace et
 		const TextureDescription::Pointer description() const
 			{ return _desc; }
 
+		uint64_t estimatedMemoryUsage() const override
+		{
+			return static_cast<uint64_t>(_desc->dataSizeForAllMipLevels()) *
+				static_cast<uint64_t>(etMax(1u, _desc->layersCount));
+		}
+
 	private:
 		void generateTexture(RenderContext* rc);
 		void buildProperies();
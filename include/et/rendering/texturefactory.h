@@ -64,6 +64,7 @@ namespace et
 		friend class TextureFactoryPrivate;
 		
 		void reloadObject(LoadableObject::Pointer, ObjectsCache&);
+		bool reloadObjectAsync(LoadableObject::Pointer, ObjectsCache&);
 		void textureLoadingThreadDidLoadTextureData(TextureLoadingRequest* request);
 		
 	private:
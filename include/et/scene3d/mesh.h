@@ -67,6 +67,7 @@ namespace et
 			void setVertexBuffer(VertexBuffer::Pointer);
 			void setIndexBuffer(IndexBuffer::Pointer);
 			void setVertexArrayObject(VertexArrayObject);
+			void releaseVertexArrayObject();
 
 			void serialize(Dictionary, const std::string&) override;
 			void deserialize(Dictionary, SerializationHelper*) override;
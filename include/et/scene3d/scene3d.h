@@ -35,6 +35,18 @@ namespace et
 			void deserializeWithOptions(et::RenderContext*, Dictionary, const std::string& basePath,
 				ObjectsCache&, uint32_t options);
 
+			/*
+			 * Writes hierarchy, materials and geometry into single packed file,
+			 * uncompressed geometry is used in place from memory-mapped file on loading.
+			 */
+			bool serializeToContainer(const std::string& fileName, SceneSectionCompression);
+
+			bool deserializeFromContainer(et::RenderContext*, const std::string& fileName,
+				ObjectsCache&, uint32_t options);
+
+			void deserializeFromContainer(et::RenderContext*, SceneContainer::Pointer, Dictionary,
+				const std::string& basePath, ObjectsCache&, uint32_t options);
+
 			Storage& storage()
 				{ return _storage; }
 
@@ -45,6 +57,7 @@ namespace et
 			ET_DECLARE_EVENT1(deserializationFinished, bool)
 
 		private:
+			void finishDeserialization(et::RenderContext*, Dictionary, uint32_t options);
 			void buildVertexBuffers(et::RenderContext*);
 			void cleanupGeometry();
 			void cleanUpSupportMehses();
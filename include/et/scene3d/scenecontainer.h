@@ -0,0 +1,124 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/core/dictionary.h>
+#include <et/core/mappedfile.h>
+
+namespace et
+{
+	namespace s3d
+	{
+		/*
+		 * Single file scene container:
+		 *	header, table of contents, sections aligned to the page size.
+		 * Uncompressed sections are used in place from memory-mapped file.
+		 */
+		enum class SceneSectionType : uint32_t
+		{
+			Hierarchy,
+			Materials,
+			VertexData,
+			IndexData,
+		};
+
+		enum class SceneSectionCompression : uint32_t
+		{
+			None,
+			Zlib,
+		};
+
+		struct SceneContainerHeader
+		{
+			char magic[4];
+			uint32_t version = 0;
+			uint32_t sectionsCount = 0;
+			uint32_t alignment = 0;
+			uint64_t tableOffset = 0;
+			uint64_t fileSize = 0;
+		};
+
+		struct SceneSectionHeader
+		{
+			SceneSectionType type = SceneSectionType::Hierarchy;
+			SceneSectionCompression compression = SceneSectionCompression::None;
+			uint64_t offset = 0;
+			uint64_t storedSize = 0;
+			uint64_t size = 0;
+		};
+
+		class SceneContainerWriter
+		{
+		public:
+			/*
+			 * Returns index of the section, which could be stored in hierarchy to reference it.
+			 * Falls back to uncompressed section if compression does not reduce size.
+			 */
+			uint32_t addSection(SceneSectionType, const char* data, size_t size, SceneSectionCompression);
+
+			uint32_t addSection(SceneSectionType type, const BinaryDataStorage& data, SceneSectionCompression c)
+				{ return addSection(type, data.binary(), data.dataSize(), c); }
+
+			bool writeToFile(const std::string&);
+
+		private:
+			struct Section
+			{
+				SceneSectionHeader header;
+				BinaryDataStorage data;
+			};
+
+		private:
+			std::vector<Section> _sections;
+		};
+
+		class SceneContainer : public Shared
+		{
+		public:
+			ET_DECLARE_POINTER(SceneContainer)
+
+			static bool isSceneContainer(const std::string& fileName);
+
+		public:
+			SceneContainer(const std::string& fileName);
+
+			bool valid() const
+				{ return _valid; }
+
+			size_t sectionsCount() const
+				{ return _sections.size(); }
+
+			const SceneSectionHeader& section(size_t index) const
+				{ return _sections.at(index); }
+
+			/*
+			 * Returns index of first section of given type or -1
+			 */
+			int32_t findSection(SceneSectionType) const;
+
+			/*
+			 * Uncompressed sections are returned as views of mapped memory (copy-on-write),
+			 * compressed sections are decompressed into new storage.
+			 */
+			BinaryDataStorage sectionData(size_t index);
+
+			bool readHierarchy(Dictionary&);
+
+			bool sectionStoredInPlace(size_t index) const
+				{ return _sections.at(index).compression == SceneSectionCompression::None; }
+
+			const MappedFile::Pointer& mappedFile() const
+				{ return _file; }
+
+		private:
+			MappedFile::Pointer _file;
+			std::vector<SceneSectionHeader> _sections;
+			bool _valid = false;
+		};
+	}
+}
@@ -0,0 +1,115 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/scene3d/scene3d.h>
+
+namespace et
+{
+	namespace s3d
+	{
+		class SceneStreamingThread;
+		struct SceneStreamingState;
+		struct SceneStreamingPayload;
+
+		/*
+		 * Progressive loading of the scene container:
+		 *	hierarchy, bounds and materials are loaded by open(),
+		 *	vertex and index data are loaded by background threads in order of priority,
+		 *	meshes become renderable when their geometry is uploaded on the main run loop.
+		 * Textures are loaded asynchronously by texture factory.
+		 * All methods should be called from the main thread.
+		 */
+		class SceneStreamer : public Shared
+		{
+		public:
+			ET_DECLARE_POINTER(SceneStreamer)
+
+			struct Statistics
+			{
+				size_t payloadsLoaded = 0;
+				size_t payloadsUnloaded = 0;
+				size_t residentMemory = 0;
+				size_t peakResidentMemory = 0;
+				size_t readyMeshes = 0;
+				size_t totalMeshes = 0;
+			};
+
+		public:
+			SceneStreamer(RenderContext*, uint32_t threadsCount = 2);
+			~SceneStreamer();
+
+			bool open(const std::string& fileName, ObjectsCache&, uint32_t options);
+
+			const Scene::Pointer& scene() const
+				{ return _scene; }
+
+			/*
+			 * Geometry closer to the viewer is loaded first
+			 */
+			void setViewerPosition(const vec3&);
+
+			/*
+			 * Loads geometry of the mesh before anything else, requested geometry is never unloaded
+			 */
+			void request(const Mesh::Pointer&);
+
+			bool meshReady(const Mesh::Pointer&) const;
+
+			/*
+			 * Zero budget means unlimited, otherwise geometry far from the viewer
+			 * is unloaded when resident memory exceeds the budget
+			 */
+			void setMemoryBudget(size_t bytes);
+
+			/*
+			 * Unloads geometry far from the viewer until resident memory fits into given size
+			 */
+			void releaseMemory(size_t residentMemory);
+
+			void handleMemoryPressure()
+				{ releaseMemory(_statistics.residentMemory / 2); }
+
+			const Statistics& statistics() const
+				{ return _statistics; }
+
+		public:
+			ET_DECLARE_EVENT1(meshDidBecomeReady, Mesh::Pointer)
+			ET_DECLARE_EVENT1(meshDidUnload, Mesh::Pointer)
+
+		private:
+			friend struct SceneStreamingState;
+
+			void payloadDidLoad(SceneStreamingPayload*);
+			void makeResident(SceneStreamingPayload*);
+			void unload(SceneStreamingPayload*);
+			void updatePriorities();
+			void enqueue(SceneStreamingPayload*);
+			void unloadUntil(size_t residentMemory);
+
+		private:
+			ET_DENY_COPY(SceneStreamer)
+
+		private:
+			RenderContext* _rc = nullptr;
+			IntrusivePtr<SceneStreamingState> _state;
+			std::vector<SceneStreamingThread*> _threads;
+			std::vector<IntrusivePtr<SceneStreamingPayload>> _payloads;
+			std::map<std::string, SceneStreamingPayload*> _payloadsByName;
+			SceneStreamingPayload* _indexPayload = nullptr;
+
+			Scene::Pointer _scene;
+			SceneContainer::Pointer _container;
+			IndexBuffer::Pointer _indexBuffer;
+			Statistics _statistics;
+			vec3 _viewerPosition;
+			size_t _memoryBudget = 0;
+			bool _hasViewerPosition = false;
+		};
+	}
+}
@@ -39,6 +39,16 @@ namespace et
 			virtual ~SerializationHelper() { }
 		};
 
+		/*
+		 * Format of the files written along with the scene (material libraries).
+		 * Both formats are recognized on loading.
+		 */
+		enum class StorageFormat
+		{
+			Json,
+			Binary
+		};
+
 		enum
 		{
 			DeserializeOption_KeepGeometry = 0x0001,
@@ -46,6 +56,13 @@ namespace et
 			
 			DeserializeOption_CreateTextures = 0x0010,
 			DeserializeOption_CreateVertexBuffers = 0x0020,
+
+			/*
+			 * Geometry is not loaded, vertex storages and index array are created empty
+			 * and filled later by SceneStreamer. Implies keeping geometry.
+			 */
+			DeserializeOption_StreamGeometry = 0x0040,
+			DeserializeOption_LoadTexturesAsync = 0x0080,
 			
 			DeserializeOption_KeepAndCreateEverything =
 				DeserializeOption_KeepGeometry | DeserializeOption_KeepSupportMeshes | 
@@ -84,6 +101,7 @@ namespace et
 		extern const std::string kVertexStorages;
 		extern const std::string kIndexArray;
 		extern const std::string kBinary;
+		extern const std::string kSection;
 		extern const std::string kVertexDeclaration;
 		extern const std::string kUsage;
 		extern const std::string kType;
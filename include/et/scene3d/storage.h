@@ -10,6 +10,7 @@
 #include <et/vertexbuffer/indexarray.h>
 #include <et/vertexbuffer/vertexstorage.h>
 #include <et/scene3d/material.h>
+#include <et/scene3d/scenecontainer.h>
 
 namespace et
 {
@@ -25,6 +26,22 @@ namespace et
 			void deserializeWithOptions(RenderContext*, Dictionary, SerializationHelper*, ObjectsCache&,
 				uint32_t);
 
+			/*
+			 * Materials, vertex and index data are stored as sections of the container,
+			 * returned dictionary references them by section indices.
+			 */
+			Dictionary serializeToContainer(SceneContainerWriter&, const std::string&, SceneSectionCompression);
+
+			void deserializeFromContainer(RenderContext*, Dictionary, SceneContainer::Pointer, SerializationHelper*,
+				ObjectsCache&, uint32_t);
+
+			/*
+			 * Creates geometry described by entries of serialized storage,
+			 * does not modify storage and could be called from any thread.
+			 */
+			static VertexStorage::Pointer loadVertexStorage(Dictionary, SceneContainer::Pointer);
+			static IndexArray::Pointer loadIndexArray(Dictionary, SceneContainer::Pointer);
+
 			std::vector<VertexStorage::Pointer>& vertexStorages()
 				{ return _vertexStorages; }
 
@@ -56,6 +73,7 @@ namespace et
 				{ _materials.insert({m->name(), m}); }
 
 			void addVertexStorage(const VertexStorage::Pointer&);
+			void replaceVertexStorage(const VertexStorage::Pointer&, const VertexStorage::Pointer&);
 
 			void setIndexArray(const IndexArray::Pointer&);
 			
@@ -66,15 +84,27 @@ namespace et
 			
 			void flush();
 
+			StorageFormat serializationFormat() const
+				{ return _serializationFormat; }
+
+			void setSerializationFormat(StorageFormat format)
+				{ _serializationFormat = format; }
+
 		private:
 			Storage* duplicate()
 				{ return nullptr; }
 
+			Dictionary serializeMaterials(const std::string&);
+			Dictionary serializeIndexArray(size_t& indexesDataSize);
+
+			void deserializeMaterials(RenderContext*, Dictionary, SerializationHelper*, ObjectsCache&, uint32_t);
+
 		private:
 			std::vector<VertexStorage::Pointer> _vertexStorages;
 			IndexArray::Pointer _indexArray;
 			Material::Map _materials;
 			std::vector<Texture::Pointer> _textures;
+			StorageFormat _serializationFormat = StorageFormat::Json;
 		};
 	}
 }
@@ -0,0 +1,146 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <mutex>
+#include <et/core/singleton.h>
+#include <et/app/runloop.h>
+
+namespace et
+{
+	class Job : public Shared
+	{
+	public:
+		ET_DECLARE_POINTER(Job)
+
+		using Function = std::function<void()>;
+
+	public:
+		Job(Function func) :
+			_function(func) { }
+
+		bool finished() const
+			{ return _finished.load(); }
+
+	private:
+		friend class JobSystem;
+		friend class JobSystemPrivate;
+
+		ET_DENY_COPY(Job)
+
+	private:
+		Function _function;
+		Function _completion;
+		RunLoop* _completionRunLoop = nullptr;
+		Job::Pointer _parent;
+
+		std::mutex _continuationsLock;
+		std::vector<Job::Pointer> _continuations;
+
+		/*
+		 * Job itself and all unfinished children
+		 */
+		std::atomic<int> _unfinishedJobs{1};
+
+		/*
+		 * Unfinished dependencies and one for not being submitted yet
+		 */
+		std::atomic<int> _pendingDependencies{1};
+
+		std::atomic<bool> _finished{false};
+	};
+
+	/*
+	 * Engine-wide pool of worker threads, sized to the number of cores.
+	 * Each worker owns a deque of jobs (LIFO for owner, FIFO for thieves),
+	 * idle workers steal jobs from others.
+	 */
+	class JobSystemPrivate;
+	class JobSystem : public Singleton<JobSystem>
+	{
+	public:
+		Job::Pointer createJob(Job::Function);
+
+		/*
+		 * Parent job will not be considered finished until all of its children are finished
+		 */
+		Job::Pointer createChildJob(Job::Pointer parent, Job::Function);
+
+		/*
+		 * Job will not start until dependency is finished.
+		 * Should be called before job is submitted with run().
+		 */
+		void addDependency(Job::Pointer job, Job::Pointer dependency);
+
+		void addContinuation(Job::Pointer job, Job::Pointer continuation)
+			{ addDependency(continuation, job); }
+
+		/*
+		 * Callback is invoked in provided run loop when job and all of its children are finished
+		 */
+		void setCompletionCallback(Job::Pointer job, Job::Function callback, RunLoop& runLoop);
+
+		void run(Job::Pointer);
+		Job::Pointer run(Job::Function);
+
+		/*
+		 * Executes other jobs while waiting for job to finish
+		 */
+		void wait(Job::Pointer);
+
+		size_t workersCount() const;
+
+		/*
+		 * Calls func(begin, end) for subranges of [begin, end), not larger than grainSize
+		 * and waits for all of them to finish
+		 */
+		template <typename F>
+		void parallelFor(size_t begin, size_t end, size_t grainSize, F func);
+
+		template <typename F>
+		void parallelFor(size_t begin, size_t end, F func)
+			{ parallelFor(begin, end, 0, func); }
+
+	private:
+		JobSystem();
+		~JobSystem();
+
+		ET_SINGLETON_COPY_DENY(JobSystem)
+
+	private:
+		ET_DECLARE_PIMPL(JobSystem, 256)
+	};
+
+	inline JobSystem& jobSystem()
+		{ return JobSystem::instance(); }
+
+	template <typename F>
+	void JobSystem::parallelFor(size_t begin, size_t end, size_t grainSize, F func)
+	{
+		if (end <= begin) return;
+
+		size_t rangeSize = end - begin;
+		if (grainSize == 0)
+			grainSize = etMax(size_t(1), rangeSize / (4 * (workersCount() + 1)));
+
+		if (rangeSize <= grainSize)
+		{
+			func(begin, end);
+			return;
+		}
+
+		auto root = createJob([](){ });
+		for (size_t i = begin; i < end; i += grainSize)
+		{
+			size_t rangeEnd = etMin(end, i + grainSize);
+			run(createChildJob(root, [&func, i, rangeEnd]() { func(i, rangeEnd); }));
+		}
+		run(root);
+		wait(root);
+	}
+}
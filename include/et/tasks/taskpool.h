@@ -8,32 +8,116 @@
 #pragma once
 
 #include <et/tasks/tasks.h>
-#include <et/threading/criticalsection.h>
+#include <et/threading/mpscqueue.h>
 
 namespace et
 {
+	/*
+	 * Tasks could be added from any thread, update() and nextTaskTime()
+	 * should be called only from the thread which owns the pool.
+	 * Delay is counted from the first update after task was added.
+	 * Time is kept in double, so schedule does not lose precision with uptime.
+	 */
 	class TaskPool
 	{
+	public:
+		enum : size_t
+		{
+			incomingTasksCapacity = 1024
+		};
+
+		/*
+		 * Drain times are in nanoseconds
+		 */
+		struct Statistics
+		{
+			size_t queueDepth = 0;
+			size_t peakQueueDepth = 0;
+			size_t scheduledTasks = 0;
+			uint64_t drainedTasks = 0;
+			uint64_t overflowedTasks = 0;
+			uint64_t lastDrainTime = 0;
+			uint64_t peakDrainTime = 0;
+			uint64_t totalDrainTime = 0;
+		};
+
 	public:
 		TaskPool();
 		~TaskPool();
 		
-		void update(float t);
+		void update(double t);
 		void addTask(Task* t, float delay = 0.0f);
+		void addTask(TaskFunction func, float delay = 0.0f);
 		
 		bool hasTasks();
+
+		/*
+		 * Returns execution time of the earliest scheduled task
+		 * or std::numeric_limits<double>::max() if there are no tasks
+		 */
+		double nextTaskTime();
+
+		/*
+		 * Could be called from any thread
+		 */
+		Statistics statistics() const;
+		void resetStatistics();
 				
 	private:
+		struct ScheduledTask
+		{
+			TaskFunction function;
+			Task* task = nullptr;
+			double executionTime = 0.0;
+			uint64_t sequenceNumber = 0;
+		};
+
+		struct ScheduledTaskExecutesLater
+		{
+			bool operator () (const ScheduledTask& l, const ScheduledTask& r) const
+			{
+				return (l.executionTime == r.executionTime) ?
+					(l.sequenceNumber > r.sequenceNumber) : (l.executionTime > r.executionTime);
+			}
+		};
+
+		struct OverflowNode
+		{
+			ScheduledTask task;
+			OverflowNode* next = nullptr;
+		};
+
+		void pushTask(ScheduledTask&&);
 		void joinTasks();
-		
+		void executeTask(ScheduledTask&);
+		void releaseTask(ScheduledTask&);
+
 		ET_DENY_COPY(TaskPool)
 		
 	private:
-		CriticalSection _csModifying;
-		TaskList _tasks;
-		TaskList _tasksToAdd;
-		float _lastTime;
-	};
+		MPSCQueue<ScheduledTask> _incomingTasks;
 
+		/*
+		 * Lock-free stack, used only when incoming queue is full
+		 */
+		std::atomic<OverflowNode*> _overflowTasks{nullptr};
+		
+		/*
+		 * Binary min-heap ordered by execution time and then by order of addition
+		 */
+		std::vector<ScheduledTask> _tasks;
+		std::vector<ScheduledTask> _tasksToExecute;
+
+		std::atomic<uint64_t> _sequenceNumber{0};
+		std::atomic<size_t> _tasksCount{0};
+		double _lastTime = 0.0;
 
+		std::atomic<size_t> _peakQueueDepth{0};
+		std::atomic<size_t> _scheduledTasks{0};
+		std::atomic<uint64_t> _drainedTasks{0};
+		std::atomic<uint64_t> _overflowedTasks{0};
+		std::atomic<uint64_t> _lastDrainTime{0};
+		std::atomic<uint64_t> _peakDrainTime{0};
+		std::atomic<uint64_t> _totalDrainTime{0};
+	};
 }
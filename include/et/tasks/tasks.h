@@ -7,7 +7,7 @@
 
 #pragma once
 
-#include <et/core/et.h>
+#include <et/core/inplacefunction.h>
 
 namespace et
 {
@@ -19,17 +19,16 @@ namespace et
 		virtual void execute() = 0;
 
 	private:
-		float executionTime() const 
-			{ return _executionTime; }
-
-		void setExecutionTime(float t)
-			{ _executionTime = t; }
-
 		friend class TaskPool;
 
 	private:
-		float _executionTime = 0.0f;
+		std::atomic<bool> _scheduled{false};
 	};
 	
 	typedef std::vector<Task*> TaskList;
+
+	/*
+	 * Lightweight task, stored by value in the run loop queue
+	 */
+	using TaskFunction = InplaceFunction<void()>;
 }
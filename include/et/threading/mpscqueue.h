@@ -0,0 +1,113 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/core/tools.h>
+
+namespace et
+{
+	/*
+	 * Bounded lock-free multiple producers / single consumer queue
+	 * (based on Dmitry Vyukov's bounded queue). Capacity is rounded up to power of two.
+	 * push() could be called from any thread, pop() only from the consumer thread.
+	 */
+	template <typename T>
+	class MPSCQueue
+	{
+	public:
+		MPSCQueue(size_t capacity) :
+			_cells(roundToHighestPowerOfTwo(capacity)), _mask(_cells.size() - 1)
+		{
+			for (size_t i = 0, e = _cells.size(); i < e; ++i)
+				_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		/*
+		 * Returns false if queue is full
+		 */
+		bool push(T&& value)
+		{
+			size_t position = _enqueuePosition.load(std::memory_order_relaxed);
+			Cell* cell = nullptr;
+			for (;;)
+			{
+				cell = _cells.data() + (position & _mask);
+				size_t sequence = cell->sequence.load(std::memory_order_acquire);
+				intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+				if (difference == 0)
+				{
+					if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (difference < 0)
+				{
+					return false;
+				}
+				else
+				{
+					position = _enqueuePosition.load(std::memory_order_relaxed);
+				}
+			}
+
+			cell->value = std::move(value);
+			cell->sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		/*
+		 * Returns false if queue is empty
+		 */
+		bool pop(T& value)
+		{
+			size_t position = _dequeuePosition.load(std::memory_order_relaxed);
+			Cell* cell = _cells.data() + (position & _mask);
+
+			size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1) < 0)
+				return false;
+
+			value = std::move(cell->value);
+			cell->sequence.store(position + _mask + 1, std::memory_order_release);
+			_dequeuePosition.store(position + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		/*
+		 * Number of elements pushed, but not popped yet. Approximate if called concurrently.
+		 */
+		size_t size() const
+		{
+			size_t enqueued = _enqueuePosition.load(std::memory_order_relaxed);
+			size_t dequeued = _dequeuePosition.load(std::memory_order_relaxed);
+			return (enqueued > dequeued) ? (enqueued - dequeued) : 0;
+		}
+
+		bool empty() const
+			{ return size() == 0; }
+
+		size_t capacity() const
+			{ return _cells.size(); }
+
+	private:
+		ET_DENY_COPY(MPSCQueue)
+
+		struct Cell
+		{
+			std::atomic<size_t> sequence{0};
+			T value;
+		};
+
+	private:
+		std::vector<Cell> _cells;
+		size_t _mask = 0;
+		char _enqueuePadding[64];
+		std::atomic<size_t> _enqueuePosition{0};
+		char _dequeuePadding[64];
+		std::atomic<size_t> _dequeuePosition{0};
+	};
+}
@@ -25,7 +25,7 @@ namespace et
 
 		void run();
 		void suspend();
-		void resume();
+		virtual void resume();
 		void stop();
 		void join();
 
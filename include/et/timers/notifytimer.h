@@ -28,6 +28,11 @@ namespace et
 		void start(TimerPool::Pointer, float period, int64_t repeatCount = DontRepear);
 		void update(float);
 
+		bool requiresContinuousUpdates() const
+			{ return false; }
+
+		float nextUpdateTime() const;
+
 		ET_DECLARE_EVENT1(expired, NotifyTimer*)
 
 	private:
@@ -37,6 +37,20 @@ namespace et
 		friend class TimerPool;
 
 		virtual void update(float) {  }
+
+		/*
+		 * Objects which require continuous updates are updated every frame,
+		 * others only when time reaches nextUpdateTime()
+		 */
+		virtual bool requiresContinuousUpdates() const
+			{ return true; }
+
+		/*
+		 * Time of the next required update, objects which should be updated
+		 * every frame return zero
+		 */
+		virtual float nextUpdateTime() const
+			{ return 0.0f; }
 		
 		virtual void startUpdates(TimerPool* timerPool = nullptr);
 		virtual TimerPool* timerPool();
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <unordered_map>
 #include <et/core/et.h>
 #include <et/threading/criticalsection.h>
 #include <et/timers/timedobject.h>
@@ -14,15 +15,30 @@
 namespace et
 {
 	class RunLoop;
+
+	/*
+	 * Objects which require continuous updates are kept in a dense list and updated every frame,
+	 * objects with deadlines (timers) are kept in hierarchical timing wheel and updated only when due.
+	 * Objects are updated outside of the lock, so they could attach and detach other objects.
+	 */
 	class TimerPool : public Object
 	{
 	public:
 		ET_DECLARE_POINTER(TimerPool)
+
+		enum : uint64_t
+		{
+			WheelLevels = 4,
+			WheelSlotBits = 8,
+			WheelSlots = 1 << WheelSlotBits,
+			WheelSlotMask = WheelSlots - 1,
+		};
 		
 	public:
 		TimerPool(RunLoop* owner);
+		~TimerPool();
 
-		void update(float t);
+		void update(double t);
 		float actualTime() const;
 
 		void retain();
@@ -35,39 +51,51 @@ namespace et
 		
 		bool hasObjects();
 
+		/*
+		 * Returns the earliest time when one of the objects should be updated
+		 * or std::numeric_limits<double>::max() if there are no objects.
+		 * Could be earlier than actual deadline, but never later.
+		 */
+		double nextUpdateTime();
+
 	private:
 		ET_DENY_COPY(TimerPool)
-		
-		enum QueueAction
-		{
-			QueueAction_Add,
-			QueueAction_Update,
-			QueueAction_Remove
-		};
 
-		struct QueueEntry
+		struct Entry
 		{
-		public:
-			TimedObject* object;
-			QueueAction action;
+			TimedObject* object = nullptr;
+			uint64_t registration = 0;
+			uint64_t tick = 0;
+			bool continuous = false;
 
-		public:
-			QueueEntry(TimedObject* o, QueueAction a) : 
-					object(o), action(a) { }
+			Entry() = default;
 
-			bool operator == (const QueueEntry& e)
-				{ return (e.object == object) && (e.action == action); }
+			Entry(TimedObject* o, uint64_t r, bool c) :
+				object(o), registration(r), continuous(c) { }
 		};
 
-		typedef std::vector<QueueEntry> TimerPoolQueue;
+		using EntryList = std::vector<Entry>;
+
+		bool registered(const Entry&) const;
+		void unregister(const Entry&);
+
+		void schedule(Entry);
+		void advance(uint64_t targetTick);
+		void rebuildWheel(uint64_t targetTick);
+
+		uint64_t tickForDeadline(double) const;
 
 	private:
-		TimerPoolQueue _timedObjects;
-		TimerPoolQueue _queue;
+		std::unordered_map<TimedObject*, uint64_t> _registeredObjects;
+		EntryList _continuousObjects;
+		EntryList _wheel[WheelLevels][WheelSlots];
+		EntryList _distantObjects;
+		EntryList _dueObjects;
+		EntryList _updatedObjects;
 		CriticalSection _lock;
-		RunLoop* _owner;
+		RunLoop* _owner = nullptr;
 
-		bool _initialized;
-		bool _updating;
+		uint64_t _registrationCounter = 0;
+		uint64_t _currentTick = 0;
 	};
 }
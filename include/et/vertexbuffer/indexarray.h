@@ -8,6 +8,7 @@
 #pragma once
 
 #include <et/core/containers.h>
+#include <et/core/mappedfile.h>
 #include <et/rendering/rendering.h>
 
 namespace et
@@ -25,6 +26,12 @@ namespace et
 
 	public:
 		IndexArray(IndexArrayFormat format, size_t size, PrimitiveType primitiveType);
+
+		/*
+		 * Uses memory of the mapped file (copy-on-write) as index data, without copying
+		 */
+		IndexArray(IndexArrayFormat format, PrimitiveType primitiveType, MappedFile::Pointer file,
+			size_t offset, size_t size);
 		
 		void linearize(size_t size);
 		void linearize(size_t indexFrom, size_t indexTo, uint32_t startIndex);
@@ -137,6 +144,7 @@ namespace et
 		
 	private:
 		BinaryDataStorage _data;
+		MappedFile::Pointer _mappedFile;
 		size_t _actualSize = 0;
 		IndexArrayFormat _format = IndexArrayFormat::Format_16bit;
 		PrimitiveType _primitiveType = PrimitiveType::Points;
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <et/core/mappedfile.h>
 #include <et/core/rawdataaccessor.h>
 #include <et/vertexbuffer/vertexarray.h>
 #include <et/vertexbuffer/vertexdeclaration.h>
@@ -27,6 +28,12 @@ namespace et
 	public:
 		VertexStorage(const VertexDeclaration&, size_t);
 		VertexStorage(const VertexArray::Pointer&);
+
+		/*
+		 * Uses memory of the mapped file (copy-on-write) as vertex data, without copying
+		 */
+		VertexStorage(const VertexDeclaration&, MappedFile::Pointer, size_t offset, size_t capacity);
+
 		~VertexStorage();
 		
 		template <VertexAttributeType T>
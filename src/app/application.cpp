@@ -5,6 +5,8 @@
  *
  */
 
+#include <et/core/arenaallocator.h>
+#include <et/core/profiler.h>
 #include <et/rendering/rendercontext.h>
 #include <et/app/application.h>
 
@@ -13,6 +15,13 @@ using namespace et;
 namespace et
 {
 	uint32_t randomInteger(uint32_t limit);
+
+	/*
+	 * Remaining time before the deadline which is spent spinning instead of sleeping,
+	 * added to the observed sleep overshoot
+	 */
+	static const uint64_t framePacingSpinIntervalNSec = 50000;
+	static const uint64_t framePacingMaxSleepOvershootNSec = 4000000;
 }
 
 Application::Application()
@@ -20,7 +29,7 @@ Application::Application()
 	sharedObjectFactory();
 	log::addOutput(log::ConsoleOutput::Pointer::create());
 
-	_lastQueuedTimeMSec = queryContiniousTimeInMilliSeconds();
+	_lastQueuedTimeNSec = queryContiniousTimeInNanoSeconds();
 	
 	threading::setMainThreadIdentifier(threading::currentThread());
 
@@ -109,8 +118,14 @@ void Application::performRendering()
 
 bool Application::shouldPerformRendering()
 {
-	uint64_t currentTime = queryContiniousTimeInMilliSeconds();
-	uint64_t elapsedTime = currentTime - _lastQueuedTimeMSec;
+	return (_parameters.framePacing == FramePacing::Precise) ?
+		shouldPerformRenderingPrecise() : shouldPerformRenderingCoarse();
+}
+
+bool Application::shouldPerformRenderingCoarse()
+{
+	uint64_t currentTime = queryContiniousTimeInNanoSeconds() / 1000000;
+	uint64_t elapsedTime = currentTime - _lastQueuedTimeNSec / 1000000;
 
 	if (elapsedTime < _fpsLimitMSec)
 	{
@@ -121,28 +136,119 @@ bool Application::shouldPerformRendering()
 		
 		return false;
 	}
-	_lastQueuedTimeMSec = queryContiniousTimeInMilliSeconds();
+	_lastQueuedTimeNSec = queryContiniousTimeInNanoSeconds();
 	
 	return !_suspended;
 }
 
+bool Application::shouldPerformRenderingPrecise()
+{
+	uint64_t currentTime = queryContiniousTimeInNanoSeconds();
+
+	if ((_frameIntervalNSec > 0) && (currentTime < _nextFrameTimeNSec))
+	{
+		uint64_t remainingTime = _nextFrameTimeNSec - currentTime;
+		uint64_t spinInterval = _sleepOvershootNSec + framePacingSpinIntervalNSec;
+		if (remainingTime > spinInterval)
+		{
+			/*
+			 * Sleep most of the remaining time and let platform process events,
+			 * overshoot estimate grows immediately and decays slowly
+			 */
+			uint64_t sleepInterval = remainingTime - spinInterval;
+			threading::sleepUSec(sleepInterval / 1000);
+
+			uint64_t actualSleepInterval = queryContiniousTimeInNanoSeconds() - currentTime;
+			uint64_t overshoot = (actualSleepInterval > sleepInterval) ? actualSleepInterval - sleepInterval : 0;
+			_sleepOvershootNSec = etMin(framePacingMaxSleepOvershootNSec,
+				etMax(overshoot, _sleepOvershootNSec - _sleepOvershootNSec / 16));
+			return false;
+		}
+
+		do
+		{
+			std::this_thread::yield();
+			currentTime = queryContiniousTimeInNanoSeconds();
+		}
+		while (currentTime < _nextFrameTimeNSec);
+	}
+
+	/*
+	 * Keep cadence if frame was slightly late, resynchronize if a whole frame was missed
+	 */
+	_nextFrameTimeNSec += _frameIntervalNSec;
+	if (_nextFrameTimeNSec <= currentTime)
+		_nextFrameTimeNSec = currentTime + _frameIntervalNSec;
+
+	_lastQueuedTimeNSec = currentTime;
+
+	return !_suspended;
+}
+
 void Application::performUpdateAndRender()
 {
 	ET_ASSERT(_running && !_suspended);
+	ET_PROFILE_ZONE("app::frame");
 	
-	_runLoop.update(_lastQueuedTimeMSec);
+	threadFrameArena().reset();
+
+	if (_lastFrameTimeNSec > 0)
+		_frameTimeHistogram.addSample((_lastQueuedTimeNSec - _lastFrameTimeNSec) / 1000);
+	_lastFrameTimeNSec = _lastQueuedTimeNSec;
+	
+	_runLoop.updateNSec(_lastQueuedTimeNSec);
+	performFixedUpdates();
 
 #if !defined(ET_CONSOLE_APPLICATION)
 	performRendering();
 #endif
 }
 
+void Application::performFixedUpdates()
+{
+	double currentTime = _runLoop.preciseTime();
+	double elapsedTime = currentTime - _lastFixedUpdateTime;
+	_lastFixedUpdateTime = currentTime;
+
+	double step = _parameters.fixedTimeStep;
+	if (step <= 0.0)
+	{
+		_interpolationAlpha = 1.0f;
+		return;
+	}
+
+	_fixedUpdateAccumulator += elapsedTime;
+
+	uint32_t performedSteps = 0;
+	while ((_fixedUpdateAccumulator >= step) && (performedSteps < _parameters.maxFixedStepsPerFrame))
+	{
+		_delegate->fixedUpdate(static_cast<float>(step));
+		_fixedUpdateAccumulator -= step;
+		++performedSteps;
+	}
+
+	/*
+	 * Drop time which could not be simulated within the limit, to avoid spiral of death
+	 */
+	if (_fixedUpdateAccumulator >= step)
+		_fixedUpdateAccumulator = std::fmod(_fixedUpdateAccumulator, step);
+
+	_interpolationAlpha = static_cast<float>(_fixedUpdateAccumulator / step);
+}
+
 void Application::setFrameRateLimit(size_t value)
 {
+	_frameIntervalNSec = (value == 0) ? 0 : 1000000000 / value;
 	_fpsLimitMSec = (value == 0) ? 0 : 1000 / value;
 	_fpsLimitMSecFractPart = (value == 0) ? 0 : (1000000 / value - 1000 * _fpsLimitMSec);
 }
 
+void Application::setFixedTimeStep(double value)
+{
+	_parameters.fixedTimeStep = value;
+	_fixedUpdateAccumulator = 0.0;
+}
+
 void Application::setActive(bool active)
 {
 	if (!_running || (_active == active)) return;
@@ -207,8 +313,10 @@ void Application::resume()
 
 	platformResume();
 
-	_lastQueuedTimeMSec = queryContiniousTimeInMilliSeconds();
-	_runLoop.update(_lastQueuedTimeMSec);
+	_lastQueuedTimeNSec = queryContiniousTimeInNanoSeconds();
+	_nextFrameTimeNSec = _lastQueuedTimeNSec;
+	_lastFrameTimeNSec = 0;
+	_runLoop.updateNSec(_lastQueuedTimeNSec);
 	_runLoop.resume();
 }
 
@@ -302,29 +410,6 @@ const ApplicationIdentifier& Application::identifier() const
  * Service
  */
 
-namespace
-{
-	static std::map<threading::ThreadIdentifier, RunLoop*> allRunLoops;
-	bool removeRunLoopFromMap(RunLoop* ptr)
-	{
-		bool found = false;
-		auto i = allRunLoops.begin();
-		while (i != allRunLoops.end())
-		{
-			if (i->second == ptr)
-			{
-				found = true;
-				i = allRunLoops.erase(i);
-			}
-			else
-			{
-				++i;
-			}
-		}
-		return found;
-	}
-}
-
 RunLoop& et::mainRunLoop()
 {
 	return application().mainRunLoop();
@@ -335,44 +420,11 @@ RunLoop& et::backgroundRunLoop()
 	return application().backgroundRunLoop();
 }
 
-RunLoop& et::currentRunLoop()
-{
-	auto threadId = threading::currentThread();
-	
-	if (allRunLoops.count(threadId) > 0)
-		return mainRunLoop();
-	
-	return *(allRunLoops.at(threadId));
-}
-
 TimerPool::Pointer& et::mainTimerPool()
 {
 	return application().mainRunLoop().firstTimerPool();
 }
 
-TimerPool::Pointer et::currentTimerPool()
-{
-	return currentRunLoop().firstTimerPool();
-}
-
-void et::registerRunLoop(RunLoop& runLoop)
-{
-	auto currentThread = threading::currentThread();
-	ET_ASSERT(allRunLoops.count(currentThread) == 0);
-
-	removeRunLoopFromMap(&runLoop);
-	allRunLoops.insert({currentThread, &runLoop});
-}
-
-void et::unregisterRunLoop(RunLoop& runLoop)
-{
-	auto success = removeRunLoopFromMap(&runLoop);
-	if (!success)
-	{
-		log::error("Attempt to unregister non-registered RunLoop");
-	}
-}
-
 const std::string et::kSystemEventType = "kSystemEventType";
 const std::string et::kSystemEventRemoteNotification = "kSystemEventRemoteNotification";
 const std::string et::kSystemEventRemoteNotificationStatusChanged = "kSystemEventRemoteNotificationStatusChanged";
@@ -9,6 +9,15 @@
 #include <et/app/application.h>
 #include <et/app/backgroundthread.h>
 
+namespace et
+{
+	/*
+	 * Minimal interval between updates, used for timed objects
+	 * which are updated every frame (animations)
+	 */
+	static const double backgroundUpdateInterval = 0.001;
+}
+
 using namespace et;
 
 BackgroundRunLoop::BackgroundRunLoop() :
@@ -17,10 +26,8 @@ BackgroundRunLoop::BackgroundRunLoop() :
 void BackgroundRunLoop::setOwner(BackgroundThread* owner)
 	{ _owner = owner; }
 
-void BackgroundRunLoop::addTask(Task* t, float delay)
+void BackgroundRunLoop::wakeUp()
 {
-	updateTime(queryContiniousTimeInMilliSeconds());
-	RunLoop::addTask(t, delay);
 	_owner->resume();
 }
 
@@ -29,21 +36,45 @@ BackgroundThread::BackgroundThread()
 	_runLoop.setOwner(this);
 }
 
+void BackgroundThread::resume()
+{
+	{
+		std::lock_guard<std::mutex> lock(_wakeLock);
+		_wakeRequested = true;
+	}
+	_wakeCondition.notify_one();
+}
+
 uint64_t BackgroundThread::main()
 {
 	registerRunLoop(_runLoop);	
 	while (running())
 	{
-		if (_runLoop.hasTasks() || _runLoop.firstTimerPool()->hasObjects())
-		{
-			_runLoop.update(queryContiniousTimeInMilliSeconds());
-			threading::sleepMSec(1);
-		}
-		else
-		{
-			suspend();
-		}
+		_runLoop.updateNSec(queryContiniousTimeInNanoSeconds());
+		waitForEvents();
 	}
 	unregisterRunLoop(_runLoop);
 	return 0;
 }
+
+void BackgroundThread::waitForEvents()
+{
+	double nextTime = etMin(_runLoop.nextTaskTime(), _runLoop.nextTimerTime());
+	auto wakeCondition = [this]() { return _wakeRequested || !running(); };
+	
+	std::unique_lock<std::mutex> lock(_wakeLock);
+	if (nextTime == std::numeric_limits<double>::max())
+	{
+		_wakeCondition.wait(lock, wakeCondition);
+	}
+	else
+	{
+		/*
+		 * Tasks added while updating set wake flag, so anything due now
+		 * is either updated every frame or belongs to a paused run loop
+		 */
+		auto interval = std::chrono::duration<double>(etMax(backgroundUpdateInterval, nextTime - _runLoop.preciseTime()));
+		_wakeCondition.wait_for(lock, std::chrono::duration_cast<std::chrono::microseconds>(interval), wakeCondition);
+	}
+	_wakeRequested = false;
+}
@@ -10,32 +10,13 @@
 
 using namespace et;
 
-/*
- * Invocation Task
- */
-
-InvocationTask::InvocationTask(PureInvocationTarget* invocation) :
-	_invocation(invocation)
-{
-}
-
-InvocationTask::~InvocationTask()
-{
-	etDestroyObject(_invocation);
-}
-
-void InvocationTask::execute() 
-{
-	_invocation->invoke(); 
-}
-
 /*
  * Invocation (0)
  */
 
 void Invocation::invoke()
 {
-	_target->invoke();	 
+	_target();	 
 }
 
 void Invocation::invokeInMainRunLoop(float delay)
@@ -55,7 +36,7 @@ void Invocation::invokeInBackground(float delay)
 
 void Invocation::invokeInRunLoop(RunLoop& rl, float delay)
 {
-	rl.addTask(etCreateObject<InvocationTask>(_target->copy()), delay);
+	rl.addTask(_target, delay);
 }
 
 /*
@@ -64,7 +45,7 @@ void Invocation::invokeInRunLoop(RunLoop& rl, float delay)
 
 void Invocation1::invoke()
 { 
-	_target->invoke();	 
+	_target();	 
 }
 
 void Invocation1::invokeInMainRunLoop(float delay)
@@ -84,7 +65,7 @@ void Invocation1::invokeInBackground(float delay)
 
 void Invocation1::invokeInRunLoop(RunLoop& rl, float delay)
 {
-	rl.addTask(etCreateObject<InvocationTask>(_target->copy()), delay);
+	rl.addTask(_target, delay);
 }
 
 /*
@@ -93,7 +74,7 @@ void Invocation1::invokeInRunLoop(RunLoop& rl, float delay)
 
 void Invocation2::invoke()
 { 
-	_target->invoke();	 
+	_target();	 
 }
 
 void Invocation2::invokeInMainRunLoop(float delay)
@@ -113,5 +94,5 @@ void Invocation2::invokeInBackground(float delay)
 
 void Invocation2::invokeInRunLoop(RunLoop& rl, float delay)
 {
-	rl.addTask(etCreateObject<InvocationTask>(_target->copy()), delay);
+	rl.addTask(_target, delay);
 }
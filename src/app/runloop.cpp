@@ -5,7 +5,9 @@
  *
  */
 
+#include <et/core/profiler.h>
 #include <et/app/runloop.h>
+#include <et/app/application.h>
 #include <et/tasks/tasks.h>
 
 using namespace et;
@@ -21,19 +23,42 @@ RunLoop::~RunLoop()
 
 void RunLoop::update(uint64_t t)
 {
-	updateTime(t);
+	updateNSec(t * 1000000);
+}
+
+void RunLoop::updateNSec(uint64_t t)
+{
+	ET_PROFILE_ZONE("runloop::update");
+
+	updateTimeNSec(t);
 
 	if (_active) 
 	{
-		_taskPool.update(_time);
+		double currentTime = preciseTime();
+		_taskPool.update(currentTime);
 		for (auto& tp : _timerPools)
-			tp->update(_time);
+			tp->update(currentTime);
 	}
 }
 
 void RunLoop::addTask(Task* t, float delay)
 {
 	_taskPool.addTask(t, delay);
+	wakeUp();
+}
+
+void RunLoop::addTask(TaskFunction func, float delay)
+{
+	_taskPool.addTask(std::move(func), delay);
+	wakeUp();
+}
+
+double RunLoop::nextTimerTime()
+{
+	double result = std::numeric_limits<double>::max();
+	for (auto& tp : _timerPools)
+		result = etMin(result, tp->nextUpdateTime());
+	return result;
 }
 
 void RunLoop::attachTimerPool(const TimerPool::Pointer& pool)
@@ -82,22 +107,88 @@ void RunLoop::resume()
 	if (_active) return;
 
 	_active = true;
-	_activityTimeMSec = _actualTimeMSec;
+	_activityTimeNSec = _actualTimeNSec;
 }
 
 void RunLoop::updateTime(uint64_t t)
 {
-	_actualTimeMSec = t;
+	updateTimeNSec(t * 1000000);
+}
+
+void RunLoop::updateTimeNSec(uint64_t t)
+{
+	_actualTimeNSec = t;
 	
 	if (!_started)
 	{
 		_started = true;
-		_activityTimeMSec = _actualTimeMSec;
+		_activityTimeNSec = _actualTimeNSec;
 	}
 
-	if (_active) 
+	if (_active && (t > _activityTimeNSec))
+	{
+		_activeTimeNSec += t - _activityTimeNSec;
+		_activityTimeNSec = t;
+		_time = static_cast<double>(_activeTimeNSec) / 1.0e9;
+	}
+}
+
+/*
+ * Registry of run loops by thread, does not depend on Application
+ */
+
+namespace
+{
+	static std::map<threading::ThreadIdentifier, RunLoop*> allRunLoops;
+	bool removeRunLoopFromMap(RunLoop* ptr)
+	{
+		bool found = false;
+		auto i = allRunLoops.begin();
+		while (i != allRunLoops.end())
+		{
+			if (i->second == ptr)
+			{
+				found = true;
+				i = allRunLoops.erase(i);
+			}
+			else
+			{
+				++i;
+			}
+		}
+		return found;
+	}
+}
+
+RunLoop& et::currentRunLoop()
+{
+	auto threadId = threading::currentThread();
+	
+	if (allRunLoops.count(threadId) > 0)
+		return mainRunLoop();
+	
+	return *(allRunLoops.at(threadId));
+}
+
+TimerPool::Pointer et::currentTimerPool()
+{
+	return currentRunLoop().firstTimerPool();
+}
+
+void et::registerRunLoop(RunLoop& runLoop)
+{
+	auto currentThread = threading::currentThread();
+	ET_ASSERT(allRunLoops.count(currentThread) == 0);
+
+	removeRunLoopFromMap(&runLoop);
+	allRunLoops.insert({currentThread, &runLoop});
+}
+
+void et::unregisterRunLoop(RunLoop& runLoop)
+{
+	auto success = removeRunLoopFromMap(&runLoop);
+	if (!success)
 	{
-		_time += static_cast<float>(t - _activityTimeMSec) / 1000.0f;
-		_activityTimeMSec = t;
+		log::error("Attempt to unregister non-registered RunLoop");
 	}
 }
@@ -0,0 +1,219 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/core/arenaallocator.h>
+
+namespace et
+{
+	struct ArenaAllocator::Page
+	{
+		Page* next = nullptr;
+		char* begin = nullptr;
+		char* end = nullptr;
+		char* position = nullptr;
+
+		size_t size() const
+			{ return static_cast<size_t>(end - begin); }
+
+		size_t used() const
+			{ return static_cast<size_t>(position - begin); }
+	};
+
+	enum : size_t
+	{
+		arenaPageHeaderSize = 64
+	};
+
+	static_assert(sizeof(ArenaAllocator::Page) <= arenaPageHeaderSize, "Arena page header does not fit into reserved space");
+}
+
+using namespace et;
+
+inline char* alignPointerUp(char* ptr, size_t alignment)
+{
+	auto m = static_cast<uintptr_t>(alignment - 1);
+	return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(ptr) + m) & ~m);
+}
+
+ArenaAllocator::ArenaAllocator(size_t pageSize) :
+	_pageSize(pageSize)
+{
+}
+
+ArenaAllocator::~ArenaAllocator()
+{
+	auto page = _firstPage;
+	while (page != nullptr)
+	{
+		auto nextPage = page->next;
+		::free(page);
+		page = nextPage;
+	}
+}
+
+void* ArenaAllocator::allocate(size_t sz)
+	{ return allocate(sz, defaultAlignment); }
+
+void* ArenaAllocator::allocate(size_t sz, size_t alignment)
+{
+	ET_ASSERT((alignment > 0) && ((alignment & (alignment - 1)) == 0));
+
+	if (_currentPage != nullptr)
+	{
+		char* result = alignPointerUp(_currentPage->position, alignment);
+		if (result + sz <= _currentPage->end)
+		{
+			_currentPage->position = result + sz;
+			_peakAllocatedSize = etMax(_peakAllocatedSize, allocatedSize());
+			return result;
+		}
+	}
+
+	/*
+	 * Pages after current one are left from previous rewinds and could be reused,
+	 * otherwise new page is inserted right after current
+	 */
+	auto nextPage = (_currentPage == nullptr) ? _firstPage : _currentPage->next;
+	if ((nextPage == nullptr) || (nextPage->size() < sz + alignment))
+	{
+		auto page = createPage(etMax(_pageSize, sz + alignment));
+		page->next = nextPage;
+
+		if (_currentPage == nullptr)
+			_firstPage = page;
+		else
+			_currentPage->next = page;
+
+		nextPage = page;
+	}
+
+	if (_currentPage != nullptr)
+		_previousPagesSize += _currentPage->used();
+
+	_currentPage = nextPage;
+	_currentPage->position = _currentPage->begin;
+
+	char* result = alignPointerUp(_currentPage->position, alignment);
+	_currentPage->position = result + sz;
+	_peakAllocatedSize = etMax(_peakAllocatedSize, allocatedSize());
+
+	return result;
+}
+
+void ArenaAllocator::release(void*)
+{
+}
+
+bool ArenaAllocator::validatePointer(void* ptr, bool abortOnFail)
+{
+	auto charPtr = static_cast<char*>(ptr);
+
+	auto page = _firstPage;
+	while (page != nullptr)
+	{
+		if ((charPtr >= page->begin) && (charPtr < page->end))
+			return true;
+
+		page = page->next;
+	}
+
+	if (abortOnFail)
+	{
+		ET_FAIL_FMT("Pointer (0x%016llx) was not allocated via this arena.", reinterpret_cast<uint64_t>(ptr));
+	}
+
+	return false;
+}
+
+ArenaAllocator::Marker ArenaAllocator::marker() const
+{
+	Marker result;
+	result.page = _currentPage;
+	result.position = (_currentPage == nullptr) ? nullptr : _currentPage->position;
+	result.previousPagesSize = _previousPagesSize;
+	return result;
+}
+
+void ArenaAllocator::rewind(const Marker& m)
+{
+	if (m.page == nullptr)
+	{
+		reset();
+		return;
+	}
+
+	ET_ASSERT((m.position >= m.page->begin) && (m.position <= m.page->end));
+
+	_currentPage = m.page;
+	_currentPage->position = m.position;
+	_previousPagesSize = m.previousPagesSize;
+}
+
+void ArenaAllocator::reset()
+{
+	_currentPage = _firstPage;
+	_previousPagesSize = 0;
+
+	if (_currentPage != nullptr)
+		_currentPage->position = _currentPage->begin;
+}
+
+void ArenaAllocator::releaseUnusedPages()
+{
+	auto page = (_currentPage == nullptr) ? _firstPage : _currentPage->next;
+
+	while (page != nullptr)
+	{
+		auto nextPage = page->next;
+		_capacity -= page->size();
+		::free(page);
+		page = nextPage;
+	}
+
+	if (_currentPage == nullptr)
+		_firstPage = nullptr;
+	else
+		_currentPage->next = nullptr;
+}
+
+size_t ArenaAllocator::allocatedSize() const
+	{ return _previousPagesSize + ((_currentPage == nullptr) ? 0 : _currentPage->used()); }
+
+void ArenaAllocator::printInfo() const
+{
+	size_t pagesCount = 0;
+	for (auto page = _firstPage; page != nullptr; page = page->next)
+		++pagesCount;
+
+	log::info("Arena allocator has %zu pages:", pagesCount);
+	log::info("{");
+	log::info("\tallocated : %zu (%zuKb)", allocatedSize(), allocatedSize() / 1024);
+	log::info("\tpeak : %zu (%zuKb)", _peakAllocatedSize, _peakAllocatedSize / 1024);
+	log::info("\tcapacity : %zu (%zuKb)", _capacity, _capacity / 1024);
+	log::info("}");
+}
+
+ArenaAllocator::Page* ArenaAllocator::createPage(size_t dataSize)
+{
+	auto memory = static_cast<char*>(::malloc(arenaPageHeaderSize + dataSize));
+	ET_ASSERT(memory != nullptr);
+
+	auto page = new (memory) Page();
+	page->begin = memory + arenaPageHeaderSize;
+	page->end = page->begin + dataSize;
+	page->position = page->begin;
+
+	_capacity += dataSize;
+
+	return page;
+}
+
+ArenaAllocator& et::threadFrameArena()
+{
+	static thread_local ArenaAllocator arena;
+	return arena;
+}
@@ -0,0 +1,432 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <mutex>
+#include <condition_variable>
+#include <et/core/tools.h>
+
+namespace et
+{
+	namespace log
+	{
+		enum : size_t
+		{
+			AsyncMessageSize = 512,
+			AsyncMessageTextSize = AsyncMessageSize - sizeof(char*) - sizeof(uint32_t),
+		};
+
+		/*
+		 * Messages which do not fit into text are formatted into memory from shared block allocator,
+		 * it is released by the writer thread
+		 */
+		struct AsyncMessage
+		{
+			char* longText = nullptr;
+			Level level = Level::Info;
+			char text[AsyncMessageTextSize];
+		};
+
+		/*
+		 * Single producer (owning thread) / single consumer (writer thread) ring buffer
+		 */
+		struct AsyncMessageBuffer
+		{
+			std::vector<AsyncMessage> messages;
+			size_t mask = 0;
+			uint64_t identifier = 0;
+			std::atomic<size_t> writePosition{0};
+			std::atomic<size_t> readPosition{0};
+			std::atomic<bool> abandoned{false};
+
+			AsyncMessageBuffer(size_t capacity) :
+				messages(roundToHighestPowerOfTwo(capacity)), mask(messages.size() - 1) { }
+
+			AsyncMessage* beginWrite()
+			{
+				size_t position = writePosition.load(std::memory_order_relaxed);
+				size_t consumed = readPosition.load(std::memory_order_acquire);
+				return (position - consumed > mask) ? nullptr : messages.data() + (position & mask);
+			}
+
+			void endWrite()
+				{ writePosition.store(writePosition.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+			bool empty() const
+			{
+				return readPosition.load(std::memory_order_relaxed) ==
+					writePosition.load(std::memory_order_acquire);
+			}
+		};
+
+		/*
+		 * Marks buffer of the exiting thread, so writer could release it when drained
+		 */
+		struct AsyncMessageBufferOwner
+		{
+			AsyncMessageBuffer* buffer = nullptr;
+
+			~AsyncMessageBufferOwner()
+			{
+				if (buffer != nullptr)
+					buffer->abandoned.store(true, std::memory_order_release);
+			}
+		};
+
+		struct ActiveProducerScope
+		{
+			std::atomic<uint32_t>& counter;
+
+			ActiveProducerScope(std::atomic<uint32_t>& c) :
+				counter(c) { counter.fetch_add(1); }
+
+			~ActiveProducerScope()
+				{ counter.fetch_sub(1); }
+		};
+
+		class AsyncWriter
+		{
+		public:
+			~AsyncWriter();
+
+			void start(const AsyncOutputOptions&);
+			void stop();
+			void flush();
+
+			bool push(Level, const char*, va_list);
+
+		public:
+			std::atomic<bool> enabled{false};
+			std::atomic<uint64_t> droppedMessages{0};
+
+		private:
+			void writerMain();
+			void drain();
+			bool flushed(const std::vector<std::pair<uint64_t, size_t>>&);
+			AsyncMessageBuffer* currentThreadBuffer();
+
+		private:
+			AsyncOutputOptions _options;
+			std::thread _thread;
+
+			std::mutex _buffersLock;
+			std::vector<AsyncMessageBuffer*> _buffers;
+			uint64_t _lastBufferIdentifier = 0;
+
+			std::mutex _wakeLock;
+			std::condition_variable _wakeCondition;
+			std::condition_variable _drainCondition;
+			bool _wakeRequested = false;
+			bool _running = false;
+
+			std::atomic<uint32_t> _activeProducers{0};
+			uint64_t _reportedDroppedMessages = 0;
+		};
+
+		/*
+		 * Constructed on first use, so it is destroyed (and drained) before log outputs
+		 */
+		static AsyncWriter& asyncWriter()
+		{
+			static AsyncWriter writer;
+			return writer;
+		}
+
+		static thread_local AsyncMessageBufferOwner currentThreadBufferOwner;
+		static thread_local bool insideAsyncWriter = false;
+
+		static void passMessageToOutput(Output::Pointer& output, Level level, const char* format, ...)
+		{
+			va_list args;
+			va_start(args, format);
+			switch (level)
+			{
+				case Level::Debug:
+					output->debug(format, args);
+					break;
+				case Level::Warning:
+					output->warning(format, args);
+					break;
+				case Level::Error:
+					output->error(format, args);
+					break;
+				default:
+					output->info(format, args);
+			}
+			va_end(args);
+		}
+	}
+}
+
+using namespace et;
+using namespace et::log;
+
+/*
+ * AsyncWriter
+ */
+AsyncWriter::~AsyncWriter()
+{
+	stop();
+
+	for (auto buffer : _buffers)
+		etDestroyObject(buffer);
+}
+
+void AsyncWriter::start(const AsyncOutputOptions& options)
+{
+	stop();
+
+	_options = options;
+	_running = true;
+	_thread = std::thread(&AsyncWriter::writerMain, this);
+	enabled.store(true, std::memory_order_release);
+}
+
+void AsyncWriter::stop()
+{
+	if (!_thread.joinable()) return;
+
+	/*
+	 * Producers which have seen enabled output should finish, so the final drain includes their messages
+	 */
+	enabled.store(false);
+	while (_activeProducers.load() > 0)
+		std::this_thread::yield();
+
+	{
+		std::lock_guard<std::mutex> lock(_wakeLock);
+		_running = false;
+	}
+	_wakeCondition.notify_one();
+	_thread.join();
+}
+
+/*
+ * Waits until every buffer is read up to its write position at the moment of the call,
+ * so messages pushed later from other threads could not be taken into account instead
+ */
+void AsyncWriter::flush()
+{
+	std::vector<std::pair<uint64_t, size_t>> targets;
+	{
+		std::lock_guard<std::mutex> lock(_buffersLock);
+		targets.reserve(_buffers.size());
+		for (auto buffer : _buffers)
+			targets.emplace_back(buffer->identifier, buffer->writePosition.load(std::memory_order_acquire));
+	}
+
+	std::unique_lock<std::mutex> lock(_wakeLock);
+	_wakeRequested = true;
+	_wakeCondition.notify_one();
+	_drainCondition.wait(lock, [this, &targets]()
+		{ return !_running || flushed(targets); });
+}
+
+/*
+ * Buffers are released only when drained, so missing buffer is flushed
+ */
+bool AsyncWriter::flushed(const std::vector<std::pair<uint64_t, size_t>>& targets)
+{
+	std::lock_guard<std::mutex> lock(_buffersLock);
+	for (const auto& target : targets)
+	{
+		for (auto buffer : _buffers)
+		{
+			if ((buffer->identifier == target.first) && (buffer->readPosition.load(std::memory_order_acquire) < target.second))
+				return false;
+		}
+	}
+	return true;
+}
+
+AsyncMessageBuffer* AsyncWriter::currentThreadBuffer()
+{
+	if (currentThreadBufferOwner.buffer == nullptr)
+	{
+		auto buffer = etCreateObject<AsyncMessageBuffer>(_options.messagesPerThread);
+		{
+			std::lock_guard<std::mutex> lock(_buffersLock);
+			buffer->identifier = ++_lastBufferIdentifier;
+			_buffers.push_back(buffer);
+		}
+		currentThreadBufferOwner.buffer = buffer;
+	}
+	return currentThreadBufferOwner.buffer;
+}
+
+bool AsyncWriter::push(Level level, const char* format, va_list args)
+{
+	if (insideAsyncWriter || !enabled.load(std::memory_order_acquire))
+		return false;
+
+	ActiveProducerScope producerScope(_activeProducers);
+	if (!enabled.load())
+		return false;
+
+	AsyncMessageBuffer* buffer = currentThreadBuffer();
+	AsyncMessage* message = buffer->beginWrite();
+	while (message == nullptr)
+	{
+		if (_options.overflowPolicy == OverflowPolicy::Drop)
+		{
+			droppedMessages.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_wakeLock);
+			_wakeRequested = true;
+		}
+		_wakeCondition.notify_one();
+		std::this_thread::yield();
+
+		if (!enabled.load(std::memory_order_acquire))
+			return false;
+
+		message = buffer->beginWrite();
+	}
+
+	va_list formatArgs;
+	va_copy(formatArgs, args);
+	int length = vsnprintf(message->text, sizeof(message->text), format, formatArgs);
+	va_end(formatArgs);
+
+	message->level = level;
+	message->longText = nullptr;
+	if (length >= static_cast<int>(sizeof(message->text)))
+	{
+		message->longText = static_cast<char*>(sharedBlockAllocator().allocate(static_cast<size_t>(length) + 1));
+		vsnprintf(message->longText, static_cast<size_t>(length) + 1, format, args);
+	}
+	buffer->endWrite();
+	return true;
+}
+
+void AsyncWriter::drain()
+{
+	std::vector<AsyncMessageBuffer*> buffers;
+	{
+		std::lock_guard<std::mutex> lock(_buffersLock);
+		buffers = _buffers;
+	}
+
+	auto& outputs = sharedLogOutputs();
+
+	size_t written = 0;
+	for (auto buffer : buffers)
+	{
+		size_t position = buffer->readPosition.load(std::memory_order_relaxed);
+		size_t end = buffer->writePosition.load(std::memory_order_acquire);
+		for (; position != end; ++position)
+		{
+			AsyncMessage& message = buffer->messages[position & buffer->mask];
+			const char* text = (message.longText == nullptr) ? message.text : message.longText;
+			for (auto& output : outputs)
+				passMessageToOutput(output, message.level, "%s", text);
+
+			if (message.longText != nullptr)
+			{
+				sharedBlockAllocator().release(message.longText);
+				message.longText = nullptr;
+			}
+			buffer->readPosition.store(position + 1, std::memory_order_release);
+			++written;
+		}
+	}
+
+	uint64_t dropped = droppedMessages.load(std::memory_order_relaxed);
+	if (dropped > _reportedDroppedMessages)
+	{
+		for (auto& output : outputs)
+		{
+			passMessageToOutput(output, Level::Warning, "%llu log messages were dropped",
+				static_cast<unsigned long long>(dropped - _reportedDroppedMessages));
+		}
+		_reportedDroppedMessages = dropped;
+	}
+
+	if (written > 0)
+	{
+		for (auto& output : outputs)
+			output->flush();
+	}
+
+	/*
+	 * Buffers of exited threads are released once everything is written
+	 */
+	std::lock_guard<std::mutex> lock(_buffersLock);
+	auto i = _buffers.begin();
+	while (i != _buffers.end())
+	{
+		if ((*i)->abandoned.load(std::memory_order_acquire) && (*i)->empty())
+		{
+			etDestroyObject(*i);
+			i = _buffers.erase(i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+void AsyncWriter::writerMain()
+{
+	insideAsyncWriter = true;
+
+	auto interval = std::chrono::milliseconds(etMax(1u, _options.flushIntervalMSec));
+
+	std::unique_lock<std::mutex> lock(_wakeLock);
+	while (_running)
+	{
+		_wakeCondition.wait_for(lock, interval, [this]() { return _wakeRequested || !_running; });
+		_wakeRequested = false;
+
+		lock.unlock();
+		drain();
+		lock.lock();
+
+		_drainCondition.notify_all();
+	}
+	lock.unlock();
+
+	drain();
+	_drainCondition.notify_all();
+}
+
+/*
+ * Public interface
+ */
+void et::log::enableAsyncOutput(const AsyncOutputOptions& options)
+{
+	asyncWriter().start(options);
+}
+
+void et::log::disableAsyncOutput()
+{
+	asyncWriter().stop();
+}
+
+bool et::log::asyncOutputEnabled()
+{
+	return asyncWriter().enabled.load(std::memory_order_acquire);
+}
+
+void et::log::flushAsyncOutput()
+{
+	if (asyncOutputEnabled())
+		asyncWriter().flush();
+}
+
+uint64_t et::log::droppedMessagesCount()
+{
+	return asyncWriter().droppedMessages.load(std::memory_order_relaxed);
+}
+
+bool et::log::pushAsyncMessage(Level level, const char* format, va_list args)
+{
+	return asyncWriter().push(level, format, args);
+}
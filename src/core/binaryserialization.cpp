@@ -0,0 +1,449 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/core/memorytags.h>
+#include <et/core/profiler.h>
+#include <et/core/binaryserialization.h>
+
+using namespace et;
+
+namespace
+{
+	const uint8_t binaryHeader[] = { 'E', 'T', 'B', 'D' };
+
+	enum : uint8_t
+	{
+		BinaryVersion = 1,
+	};
+
+	enum : size_t
+	{
+		MaxNestingDepth = 512,
+	};
+
+	enum Tag : uint8_t
+	{
+		Tag_Float,
+		Tag_Integer,
+		Tag_Boolean,
+		Tag_String,
+		Tag_Array,
+		Tag_Dictionary,
+		Tag_FloatArray,
+	};
+
+	class Writer
+	{
+	public:
+		void writeValue(const ValueBase::Pointer& value)
+		{
+			if (value.invalid())
+			{
+				_body.push_back(Tag_Dictionary);
+				writeVarint(_body, 0);
+				return;
+			}
+
+			switch (value->valueClass())
+			{
+				case ValueClass_Float:
+				{
+					_body.push_back(Tag_Float);
+					writeFloat(FloatValue(value)->content);
+					break;
+				}
+
+				case ValueClass_Integer:
+				{
+					int64_t i = IntegerValue(value)->content;
+					_body.push_back(Tag_Integer);
+					writeVarint(_body, (static_cast<uint64_t>(i) << 1) ^ static_cast<uint64_t>(i >> 63));
+					break;
+				}
+
+				case ValueClass_Boolean:
+				{
+					_body.push_back(Tag_Boolean);
+					_body.push_back(BooleanValue(value)->content ? 1 : 0);
+					break;
+				}
+
+				case ValueClass_String:
+				{
+					_body.push_back(Tag_String);
+					writeVarint(_body, stringIndex(StringValue(value)->content));
+					break;
+				}
+
+				case ValueClass_Array:
+				{
+					writeArray(ArrayValue(value));
+					break;
+				}
+
+				case ValueClass_Dictionary:
+				{
+					Dictionary dictionary(value);
+					_body.push_back(Tag_Dictionary);
+					writeVarint(_body, dictionary->content.size());
+					for (const auto& kv : dictionary->content)
+					{
+						writeVarint(_body, stringIndex(kv.first));
+						writeValue(kv.second);
+					}
+					break;
+				}
+
+				default:
+					ET_FAIL_FMT("Unsupported value class: %d", value->valueClass());
+			}
+		}
+
+		BinaryDataStorage finish()
+		{
+			std::vector<uint8_t> strings;
+			writeVarint(strings, _strings.size());
+			for (const std::string* s : _strings)
+			{
+				writeVarint(strings, s->size());
+				strings.insert(strings.end(), s->begin(), s->end());
+			}
+
+			size_t headerSize = sizeof(binaryHeader) + 1;
+			BinaryDataStorage result(headerSize + strings.size() + _body.size());
+			etCopyMemory(result.data(), binaryHeader, sizeof(binaryHeader));
+			result[sizeof(binaryHeader)] = BinaryVersion;
+			etCopyMemory(result.element_ptr(headerSize), strings.data(), strings.size());
+			etCopyMemory(result.element_ptr(headerSize + strings.size()), _body.data(), _body.size());
+			return result;
+		}
+
+	private:
+		static void writeVarint(std::vector<uint8_t>& output, uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				output.push_back(static_cast<uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+			output.push_back(static_cast<uint8_t>(value));
+		}
+
+		void writeFloat(float value)
+		{
+			uint32_t bits = 0;
+			etCopyMemory(&bits, &value, sizeof(bits));
+			_body.push_back(static_cast<uint8_t>(bits));
+			_body.push_back(static_cast<uint8_t>(bits >> 8));
+			_body.push_back(static_cast<uint8_t>(bits >> 16));
+			_body.push_back(static_cast<uint8_t>(bits >> 24));
+		}
+
+		void writeArray(const ArrayValue& array)
+		{
+			bool floatsOnly = !array->content.empty();
+			for (const auto& element : array->content)
+			{
+				if (element.invalid() || (element->valueClass() != ValueClass_Float))
+				{
+					floatsOnly = false;
+					break;
+				}
+			}
+
+			_body.push_back(floatsOnly ? Tag_FloatArray : Tag_Array);
+			writeVarint(_body, array->content.size());
+
+			if (floatsOnly)
+			{
+				_body.reserve(_body.size() + sizeof(float) * array->content.size());
+				for (const auto& element : array->content)
+					writeFloat(FloatValue(element)->content);
+			}
+			else
+			{
+				for (const auto& element : array->content)
+					writeValue(element);
+			}
+		}
+
+		uint64_t stringIndex(const std::string& s)
+		{
+			auto i = _stringIndices.find(s);
+			if (i != _stringIndices.end())
+				return i->second;
+
+			uint64_t index = _strings.size();
+			auto inserted = _stringIndices.emplace(s, index);
+			_strings.push_back(&inserted.first->first);
+			return index;
+		}
+
+	private:
+		std::vector<uint8_t> _body;
+		std::vector<const std::string*> _strings;
+		std::unordered_map<std::string, uint64_t> _stringIndices;
+	};
+
+	class Reader
+	{
+	public:
+		Reader(const char* data, size_t length) :
+			_position(reinterpret_cast<const uint8_t*>(data)),
+			_end(reinterpret_cast<const uint8_t*>(data) + length) { }
+
+		ValueBase::Pointer read(ValueClass& c)
+		{
+			c = ValueClass_Invalid;
+
+			if (!binary::isBinaryData(reinterpret_cast<const char*>(_position), static_cast<size_t>(_end - _position)))
+			{
+				fail("invalid header");
+				return Dictionary();
+			}
+			_position += sizeof(binaryHeader) + 1;
+
+			uint64_t stringsCount = readVarint();
+			if (stringsCount > static_cast<uint64_t>(_end - _position))
+				fail("invalid string table");
+
+			_strings.reserve(static_cast<size_t>(failed() ? 0 : stringsCount));
+			for (uint64_t i = 0; !failed() && (i < stringsCount); ++i)
+			{
+				uint64_t length = readVarint();
+				if (!ensureAvailable(length)) break;
+
+				_strings.emplace_back(reinterpret_cast<const char*>(_position), static_cast<size_t>(length));
+				_position += length;
+			}
+
+			if (failed())
+				return Dictionary();
+
+			uint8_t rootTag = (_position < _end) ? *_position : 0;
+			if ((rootTag != Tag_Dictionary) && (rootTag != Tag_Array) && (rootTag != Tag_FloatArray))
+			{
+				fail("root should be dictionary or array");
+				return Dictionary();
+			}
+
+			auto result = readValue(0);
+			if (!failed() && (_position != _end))
+				fail("unexpected data after root value");
+
+			if (failed())
+				return Dictionary();
+
+			c = result->valueClass();
+			return result;
+		}
+
+		bool failed() const
+			{ return _error != nullptr; }
+
+		const char* error() const
+			{ return _error; }
+
+	private:
+		void fail(const char* message)
+		{
+			if (_error == nullptr)
+				_error = message;
+			_position = _end;
+		}
+
+		bool ensureAvailable(uint64_t bytes)
+		{
+			if (bytes > static_cast<uint64_t>(_end - _position))
+			{
+				fail("unexpected end of data");
+				return false;
+			}
+			return true;
+		}
+
+		uint64_t readVarint()
+		{
+			uint64_t result = 0;
+			for (uint32_t shift = 0; shift < 64; shift += 7)
+			{
+				if (_position >= _end)
+				{
+					fail("unexpected end of data");
+					return 0;
+				}
+
+				uint8_t byte = *_position++;
+				result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+				if ((byte & 0x80) == 0)
+					return result;
+			}
+			fail("invalid varint");
+			return 0;
+		}
+
+		float readFloat()
+		{
+			uint32_t bits = static_cast<uint32_t>(_position[0]) | (static_cast<uint32_t>(_position[1]) << 8) |
+				(static_cast<uint32_t>(_position[2]) << 16) | (static_cast<uint32_t>(_position[3]) << 24);
+			_position += sizeof(bits);
+
+			float result = 0.0f;
+			etCopyMemory(&result, &bits, sizeof(result));
+			return result;
+		}
+
+		const std::string& readString()
+		{
+			uint64_t index = readVarint();
+			if (index < _strings.size())
+				return _strings[static_cast<size_t>(index)];
+
+			fail("invalid string index");
+			return emptyString;
+		}
+
+		ValueBase::Pointer readValue(size_t depth)
+		{
+			if (depth > MaxNestingDepth)
+			{
+				fail("maximum nesting depth exceeded");
+				return Dictionary();
+			}
+
+			if (!ensureAvailable(1))
+				return Dictionary();
+
+			switch (*_position++)
+			{
+				case Tag_Float:
+				{
+					if (!ensureAvailable(sizeof(float)))
+						return FloatValue();
+					return FloatValue(readFloat());
+				}
+
+				case Tag_Integer:
+				{
+					uint64_t encoded = readVarint();
+					return IntegerValue(static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1));
+				}
+
+				case Tag_Boolean:
+				{
+					if (!ensureAvailable(1))
+						return BooleanValue();
+					return BooleanValue(*_position++ ? 1 : 0);
+				}
+
+				case Tag_String:
+					return StringValue(readString());
+
+				case Tag_FloatArray:
+				{
+					ArrayValue result;
+					uint64_t count = readVarint();
+					if ((count > static_cast<uint64_t>(_end - _position) / sizeof(float)) || !ensureAvailable(count * sizeof(float)))
+					{
+						fail("unexpected end of data");
+						return result;
+					}
+
+					result->content.reserve(static_cast<size_t>(count));
+					for (uint64_t i = 0; i < count; ++i)
+						result->content.push_back(FloatValue(readFloat()));
+					return result;
+				}
+
+				case Tag_Array:
+				{
+					ArrayValue result;
+					uint64_t count = readVarint();
+					if (!ensureAvailable(count))
+						return result;
+
+					result->content.reserve(static_cast<size_t>(count));
+					for (uint64_t i = 0; !failed() && (i < count); ++i)
+						result->content.push_back(readValue(depth + 1));
+					return result;
+				}
+
+				case Tag_Dictionary:
+				{
+					Dictionary result;
+					uint64_t count = readVarint();
+					if ((count > static_cast<uint64_t>(_end - _position) / 2) || !ensureAvailable(2 * count))
+					{
+						fail("unexpected end of data");
+						return result;
+					}
+
+					auto& content = result->content;
+					content.reserve(static_cast<size_t>(count));
+					for (uint64_t i = 0; !failed() && (i < count); ++i)
+					{
+						const std::string& key = readString();
+						content[key] = readValue(depth + 1);
+					}
+					return result;
+				}
+
+				default:
+				{
+					fail("invalid value tag");
+					return Dictionary();
+				}
+			}
+		}
+
+	private:
+		const uint8_t* _position = nullptr;
+		const uint8_t* _end = nullptr;
+		std::vector<std::string> _strings;
+		const char* _error = nullptr;
+	};
+}
+
+BinaryDataStorage et::binary::serialize(const Dictionary& dictionary)
+{
+	Writer writer;
+	writer.writeValue(dictionary);
+	return writer.finish();
+}
+
+BinaryDataStorage et::binary::serialize(const ArrayValue& array)
+{
+	Writer writer;
+	writer.writeValue(array);
+	return writer.finish();
+}
+
+ValueBase::Pointer et::binary::deserialize(const char* data, size_t length, ValueClass& c, bool printErrors)
+{
+	ET_MEMORY_TAG("binary");
+	ET_PROFILE_ZONE("binary::deserialize");
+
+	Reader reader(data, length);
+	auto result = reader.read(c);
+
+	if (reader.failed() && printErrors)
+		log::error("Binary deserialization error: %s", reader.error());
+
+	return result;
+}
+
+ValueBase::Pointer et::binary::deserialize(const BinaryDataStorage& data, ValueClass& c, bool printErrors)
+{
+	return deserialize(data.binary(), data.dataSize(), c, printErrors);
+}
+
+bool et::binary::isBinaryData(const char* data, size_t length)
+{
+	return (data != nullptr) && (length > sizeof(binaryHeader)) &&
+		(memcmp(data, binaryHeader, sizeof(binaryHeader)) == 0) &&
+		(static_cast<uint8_t>(data[sizeof(binaryHeader)]) == BinaryVersion);
+}
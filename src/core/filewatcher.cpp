@@ -0,0 +1,327 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <unordered_map>
+#include <unordered_set>
+#include <et/core/filewatcher.h>
+
+#if defined(__linux__)
+#	include <sys/inotify.h>
+#	include <unistd.h>
+#	include <errno.h>
+#	define ET_FILE_WATCHER_INOTIFY 1
+#else
+#	define ET_FILE_WATCHER_INOTIFY 0
+#endif
+
+namespace et
+{
+	class FileWatcherPrivate
+	{
+	public:
+		FileWatcherPrivate();
+		~FileWatcherPrivate();
+
+		bool addNativeWatch(const std::string& path);
+		void removeNativeWatch(const std::string& path);
+		void releaseNativeFolder(int descriptor, std::unordered_set<std::string>& changes);
+		void pollNative(StringList&);
+		void pollFileDates(StringList&);
+
+		void watchByPolling(const std::string& path);
+
+	public:
+		/*
+		 * Paths which could not be watched natively (or lost their native watch) are polled
+		 */
+		struct WatchedPath
+		{
+			size_t references = 0;
+			uint64_t fileDate = 0;
+			bool polled = false;
+		};
+
+		struct WatchedFolder
+		{
+			std::string path;
+			std::unordered_map<std::string, std::unordered_set<std::string>> files;
+		};
+
+		std::unordered_map<std::string, WatchedPath> watchedPaths;
+		std::unordered_map<std::string, int> folderDescriptors;
+		std::unordered_map<int, WatchedFolder> folders;
+		int nativeDescriptor = -1;
+	};
+}
+
+using namespace et;
+
+FileWatcher::FileWatcher()
+{
+	ET_PIMPL_INIT(FileWatcher)
+}
+
+FileWatcher::~FileWatcher()
+{
+	ET_PIMPL_FINALIZE(FileWatcher)
+}
+
+void FileWatcher::watch(const std::string& path)
+{
+	if (path.empty())
+		return;
+
+	auto& entry = _private->watchedPaths[path];
+	if (entry.references++ > 0)
+		return;
+
+	if ((_private->nativeDescriptor == -1) || !_private->addNativeWatch(path))
+		_private->watchByPolling(path);
+}
+
+void FileWatcher::unwatch(const std::string& path)
+{
+	auto i = _private->watchedPaths.find(path);
+	if (i == _private->watchedPaths.end())
+		return;
+
+	ET_ASSERT(i->second.references > 0);
+	if (--i->second.references > 0)
+		return;
+
+	bool polled = i->second.polled;
+	_private->watchedPaths.erase(i);
+
+	if (!polled)
+		_private->removeNativeWatch(path);
+}
+
+void FileWatcher::unwatchAll()
+{
+	for (const auto& entry : _private->watchedPaths)
+	{
+		if (!entry.second.polled)
+			_private->removeNativeWatch(entry.first);
+	}
+	_private->watchedPaths.clear();
+}
+
+void FileWatcher::poll(StringList& changedPaths)
+{
+	if (_private->nativeDescriptor != -1)
+		_private->pollNative(changedPaths);
+
+	_private->pollFileDates(changedPaths);
+}
+
+bool FileWatcher::usesNativeNotifications() const
+{
+	return _private->nativeDescriptor != -1;
+}
+
+size_t FileWatcher::watchedPathsCount() const
+{
+	return _private->watchedPaths.size();
+}
+
+/*
+ * Private
+ */
+void FileWatcherPrivate::watchByPolling(const std::string& path)
+{
+	auto& entry = watchedPaths[path];
+	entry.polled = true;
+	entry.fileDate = getFileDate(path);
+}
+
+void FileWatcherPrivate::pollFileDates(StringList& changedPaths)
+{
+	for (auto& entry : watchedPaths)
+	{
+		if (!entry.second.polled)
+			continue;
+
+		uint64_t fileDate = getFileDate(entry.first);
+		if (entry.second.fileDate != fileDate)
+		{
+			entry.second.fileDate = fileDate;
+			changedPaths.push_back(entry.first);
+
+			/*
+			 * Folder could appear again (or watches could become available), try to watch it natively
+			 */
+			if ((nativeDescriptor != -1) && addNativeWatch(entry.first))
+				entry.second.polled = false;
+		}
+	}
+}
+
+#if (ET_FILE_WATCHER_INOTIFY)
+
+static const uint32_t inotifyWatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_ATTRIB |
+	IN_DELETE_SELF | IN_MOVE_SELF;
+
+FileWatcherPrivate::FileWatcherPrivate()
+{
+	nativeDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (nativeDescriptor == -1)
+		log::warning("[FileWatcher] Unable to initialize inotify (%d), falling back to polling.", errno);
+}
+
+FileWatcherPrivate::~FileWatcherPrivate()
+{
+	if (nativeDescriptor != -1)
+		close(nativeDescriptor);
+}
+
+bool FileWatcherPrivate::addNativeWatch(const std::string& path)
+{
+	std::string folder = getFilePath(path);
+	if (folder.empty())
+		folder = "." + std::string(1, pathDelimiter);
+
+	int descriptor = -1;
+
+	auto existing = folderDescriptors.find(folder);
+	if (existing == folderDescriptors.end())
+	{
+		descriptor = inotify_add_watch(nativeDescriptor, folder.c_str(), inotifyWatchMask);
+		if (descriptor == -1)
+		{
+			log::warning("[FileWatcher] Unable to watch folder %s (%d), falling back to polling.", folder.c_str(), errno);
+			return false;
+		}
+		folderDescriptors.insert({folder, descriptor});
+		folders[descriptor].path = folder;
+	}
+	else
+	{
+		descriptor = existing->second;
+	}
+
+	folders[descriptor].files[getFileName(path)].insert(path);
+	return true;
+}
+
+void FileWatcherPrivate::removeNativeWatch(const std::string& path)
+{
+	std::string folder = getFilePath(path);
+	if (folder.empty())
+		folder = "." + std::string(1, pathDelimiter);
+
+	auto descriptor = folderDescriptors.find(folder);
+	if (descriptor == folderDescriptors.end())
+		return;
+
+	auto& watchedFolder = folders[descriptor->second];
+
+	auto file = watchedFolder.files.find(getFileName(path));
+	if (file != watchedFolder.files.end())
+	{
+		file->second.erase(path);
+		if (file->second.empty())
+			watchedFolder.files.erase(file);
+	}
+
+	if (watchedFolder.files.empty())
+	{
+		inotify_rm_watch(nativeDescriptor, descriptor->second);
+		folders.erase(descriptor->second);
+		folderDescriptors.erase(descriptor);
+	}
+}
+
+/*
+ * Folder was removed or moved, its files are reported as changed and polled until it appears again
+ */
+void FileWatcherPrivate::releaseNativeFolder(int descriptor, std::unordered_set<std::string>& changes)
+{
+	auto folder = folders.find(descriptor);
+	if (folder == folders.end())
+		return;
+
+	for (const auto& file : folder->second.files)
+	{
+		for (const auto& path : file.second)
+		{
+			changes.insert(path);
+			watchByPolling(path);
+		}
+	}
+
+	folderDescriptors.erase(folder->second.path);
+	folders.erase(folder);
+}
+
+void FileWatcherPrivate::pollNative(StringList& changedPaths)
+{
+	std::unordered_set<std::string> changes;
+	bool overflow = false;
+
+	alignas(inotify_event) char buffer[4096];
+	for (;;)
+	{
+		ssize_t bytesRead = read(nativeDescriptor, buffer, sizeof(buffer));
+		if (bytesRead <= 0)
+			break;
+
+		for (ssize_t offset = 0; offset < bytesRead; )
+		{
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+			offset += sizeof(inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				overflow = true;
+				continue;
+			}
+
+			if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF))
+			{
+				if ((event->mask & IN_MOVE_SELF) && (folders.count(event->wd) > 0))
+					inotify_rm_watch(nativeDescriptor, event->wd);
+
+				releaseNativeFolder(event->wd, changes);
+				continue;
+			}
+
+			if (event->len == 0)
+				continue;
+
+			auto folder = folders.find(event->wd);
+			if (folder == folders.end())
+				continue;
+
+			auto file = folder->second.files.find(event->name);
+			if (file != folder->second.files.end())
+				changes.insert(file->second.begin(), file->second.end());
+		}
+	}
+
+	/*
+	 * Events were lost, report everything as changed
+	 */
+	if (overflow)
+	{
+		for (const auto& entry : watchedPaths)
+			changes.insert(entry.first);
+	}
+
+	changedPaths.insert(changedPaths.end(), changes.begin(), changes.end());
+}
+
+#else
+
+FileWatcherPrivate::FileWatcherPrivate() { }
+FileWatcherPrivate::~FileWatcherPrivate() { }
+
+bool FileWatcherPrivate::addNativeWatch(const std::string&) { return false; }
+void FileWatcherPrivate::removeNativeWatch(const std::string&) { }
+void FileWatcherPrivate::releaseNativeFolder(int, std::unordered_set<std::string>&) { }
+void FileWatcherPrivate::pollNative(StringList&) { }
+
+#endif
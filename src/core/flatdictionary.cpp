@@ -0,0 +1,520 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/core/flatdictionary.h>
+
+using namespace et;
+
+/*
+ * Layout (all values are little-endian 32-bit words, nodes are aligned to 4 bytes):
+ *	header:			'ETFD', version, root offset, total size
+ *	float:			class, bits
+ *	integer:		class, low word, high word
+ *	boolean:		class, value
+ *	string:			class, length, characters, '\0', padding
+ *	array:			class, count, offsets of elements
+ *	dictionary:		class, count, (offset of key string, offset of value) pairs sorted by key
+ */
+namespace
+{
+	const char flatHeader[] = { 'E', 'T', 'F', 'D' };
+
+	enum : uint32_t
+	{
+		FlatVersion = 1,
+		FlatHeaderSize = 16,
+		MaxNestingDepth = 512,
+	};
+
+	inline uint32_t readWord(const char* base, uint32_t offset)
+	{
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(base + offset);
+		return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+			(static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+	}
+
+	inline int compareKey(const char* base, uint32_t keyOffset, const char* key, size_t keyLength)
+	{
+		size_t storedLength = readWord(base, keyOffset + 4);
+		int result = memcmp(base + keyOffset + 8, key, etMin(storedLength, keyLength));
+		if (result != 0)
+			return result;
+		return (storedLength < keyLength) ? -1 : ((storedLength > keyLength) ? 1 : 0);
+	}
+
+	class FlatWriter
+	{
+	public:
+		FlatWriter() :
+			_data(FlatHeaderSize, 0) { }
+
+		BinaryDataStorage finish(uint32_t rootOffset)
+		{
+			etCopyMemory(_data.data(), flatHeader, sizeof(flatHeader));
+			setWord(4, FlatVersion);
+			setWord(8, rootOffset);
+			setWord(12, static_cast<uint32_t>(_data.size()));
+
+			BinaryDataStorage result(_data.size());
+			etCopyMemory(result.data(), _data.data(), _data.size());
+			return result;
+		}
+
+		uint32_t writeValue(const ValueBase::Pointer& value)
+		{
+			ValueClass vc = value.valid() ? value->valueClass() : ValueClass_Dictionary;
+
+			switch (vc)
+			{
+				case ValueClass_Float:
+				{
+					float f = FloatValue(value)->content;
+					uint32_t bits = 0;
+					etCopyMemory(&bits, &f, sizeof(bits));
+					uint32_t offset = beginNode(vc);
+					appendWord(bits);
+					return offset;
+				}
+
+				case ValueClass_Integer:
+				{
+					uint64_t i = static_cast<uint64_t>(IntegerValue(value)->content);
+					uint32_t offset = beginNode(vc);
+					appendWord(static_cast<uint32_t>(i));
+					appendWord(static_cast<uint32_t>(i >> 32));
+					return offset;
+				}
+
+				case ValueClass_Boolean:
+				{
+					uint32_t offset = beginNode(vc);
+					appendWord(BooleanValue(value)->content ? 1 : 0);
+					return offset;
+				}
+
+				case ValueClass_String:
+					return writeString(StringValue(value)->content);
+
+				case ValueClass_Array:
+				{
+					ArrayValue array(value);
+
+					std::vector<uint32_t> elements;
+					elements.reserve(array->content.size());
+					for (const auto& element : array->content)
+						elements.push_back(writeValue(element));
+
+					uint32_t offset = beginNode(vc);
+					appendWord(static_cast<uint32_t>(elements.size()));
+					for (uint32_t element : elements)
+						appendWord(element);
+					return offset;
+				}
+
+				case ValueClass_Dictionary:
+				{
+					using Entry = std::pair<const std::string*, const ValueBase::Pointer*>;
+
+					std::vector<Entry> entries;
+					if (value.valid())
+					{
+						Dictionary dictionary(value);
+						entries.reserve(dictionary->content.size());
+						for (const auto& kv : dictionary->content)
+							entries.emplace_back(&kv.first, &kv.second);
+					}
+
+					std::sort(entries.begin(), entries.end(), [](const Entry& l, const Entry& r)
+						{ return *l.first < *r.first; });
+
+					std::vector<uint32_t> offsets;
+					offsets.reserve(2 * entries.size());
+					for (const auto& entry : entries)
+					{
+						offsets.push_back(writeString(*entry.first));
+						offsets.push_back(writeValue(*entry.second));
+					}
+
+					uint32_t offset = beginNode(vc);
+					appendWord(static_cast<uint32_t>(entries.size()));
+					for (uint32_t o : offsets)
+						appendWord(o);
+					return offset;
+				}
+
+				default:
+					ET_FAIL_FMT("Unsupported value class: %d", vc);
+			}
+
+			return 0;
+		}
+
+	private:
+		uint32_t writeString(const std::string& s)
+		{
+			auto i = _strings.find(s);
+			if (i != _strings.end())
+				return i->second;
+
+			uint32_t offset = beginNode(ValueClass_String);
+			appendWord(static_cast<uint32_t>(s.size()));
+			_data.insert(_data.end(), s.begin(), s.end());
+			_data.push_back(0);
+			while (_data.size() % 4 != 0)
+				_data.push_back(0);
+
+			_strings.emplace(s, offset);
+			return offset;
+		}
+
+		uint32_t beginNode(ValueClass vc)
+		{
+			ET_ASSERT(_data.size() < std::numeric_limits<uint32_t>::max());
+
+			uint32_t offset = static_cast<uint32_t>(_data.size());
+			appendWord(static_cast<uint32_t>(vc));
+			return offset;
+		}
+
+		void appendWord(uint32_t value)
+		{
+			_data.push_back(static_cast<uint8_t>(value));
+			_data.push_back(static_cast<uint8_t>(value >> 8));
+			_data.push_back(static_cast<uint8_t>(value >> 16));
+			_data.push_back(static_cast<uint8_t>(value >> 24));
+		}
+
+		void setWord(size_t offset, uint32_t value)
+		{
+			_data[offset + 0] = static_cast<uint8_t>(value);
+			_data[offset + 1] = static_cast<uint8_t>(value >> 8);
+			_data[offset + 2] = static_cast<uint8_t>(value >> 16);
+			_data[offset + 3] = static_cast<uint8_t>(value >> 24);
+		}
+
+	private:
+		std::vector<uint8_t> _data;
+		std::unordered_map<std::string, uint32_t> _strings;
+	};
+
+	/*
+	 * Checks all offsets and sizes once, so queries could read without bounds checks.
+	 * Number of visited nodes is limited to prevent blowup on crafted data with shared nodes.
+	 */
+	class FlatValidator
+	{
+	public:
+		FlatValidator(const char* base, uint32_t size) :
+			_base(base), _size(size), _visitsLeft(size / 4) { }
+
+		bool validateNode(uint32_t offset, uint32_t depth)
+		{
+			if ((depth > MaxNestingDepth) || (_visitsLeft-- == 0))
+				return false;
+
+			if ((offset < FlatHeaderSize) || (offset % 4 != 0) || !available(offset, 8))
+				return false;
+
+			uint32_t payload = readWord(_base, offset + 4);
+			switch (readWord(_base, offset))
+			{
+				case ValueClass_Float:
+				case ValueClass_Boolean:
+					return true;
+
+				case ValueClass_Integer:
+					return available(offset, 12);
+
+				case ValueClass_String:
+					return validateString(offset);
+
+				case ValueClass_Array:
+				{
+					if (!available(offset + 8, 4ull * payload))
+						return false;
+
+					for (uint32_t i = 0; i < payload; ++i)
+					{
+						if (!validateNode(readWord(_base, offset + 8 + 4 * i), depth + 1))
+							return false;
+					}
+					return true;
+				}
+
+				case ValueClass_Dictionary:
+				{
+					if (!available(offset + 8, 8ull * payload))
+						return false;
+
+					for (uint32_t i = 0; i < payload; ++i)
+					{
+						uint32_t keyOffset = readWord(_base, offset + 8 + 8 * i);
+						if ((keyOffset < FlatHeaderSize) || (keyOffset % 4 != 0) || !available(keyOffset, 8) ||
+							(readWord(_base, keyOffset) != ValueClass_String) || !validateString(keyOffset))
+						{
+							return false;
+						}
+
+						if (!validateNode(readWord(_base, offset + 12 + 8 * i), depth + 1))
+							return false;
+					}
+					return true;
+				}
+
+				default:
+					return false;
+			}
+		}
+
+	private:
+		bool available(uint64_t offset, uint64_t bytes) const
+			{ return offset + bytes <= _size; }
+
+		bool validateString(uint32_t offset) const
+		{
+			uint64_t length = readWord(_base, offset + 4);
+			return available(offset + 8, length + 1) && (_base[offset + 8 + length] == 0);
+		}
+
+	private:
+		const char* _base = nullptr;
+		uint32_t _size = 0;
+		uint32_t _visitsLeft = 0;
+	};
+}
+
+/*
+ * FlatValue
+ */
+uint32_t FlatValue::readUInt32(uint32_t offset) const
+{
+	return readWord(_base, offset);
+}
+
+ValueClass FlatValue::valueClass() const
+{
+	return valid() ? static_cast<ValueClass>(readUInt32(_offset)) : ValueClass_Invalid;
+}
+
+float FlatValue::floatValue(float def) const
+{
+	if (valueClass() != ValueClass_Float)
+		return def;
+
+	uint32_t bits = readUInt32(_offset + 4);
+	float result = 0.0f;
+	etCopyMemory(&result, &bits, sizeof(result));
+	return result;
+}
+
+int64_t FlatValue::integerValue(int64_t def) const
+{
+	if (valueClass() != ValueClass_Integer)
+		return def;
+
+	uint64_t value = static_cast<uint64_t>(readUInt32(_offset + 4)) |
+		(static_cast<uint64_t>(readUInt32(_offset + 8)) << 32);
+	return static_cast<int64_t>(value);
+}
+
+bool FlatValue::booleanValue(bool def) const
+{
+	return (valueClass() == ValueClass_Boolean) ? (readUInt32(_offset + 4) != 0) : def;
+}
+
+const char* FlatValue::stringValue(const char* def) const
+{
+	return (valueClass() == ValueClass_String) ? (_base + _offset + 8) : def;
+}
+
+size_t FlatValue::stringLength() const
+{
+	return (valueClass() == ValueClass_String) ? readUInt32(_offset + 4) : 0;
+}
+
+ValueBase::Pointer FlatValue::toValue() const
+{
+	switch (valueClass())
+	{
+		case ValueClass_Float:
+			return FloatValue(floatValue());
+
+		case ValueClass_Integer:
+			return IntegerValue(integerValue());
+
+		case ValueClass_Boolean:
+			return BooleanValue(booleanValue() ? 1 : 0);
+
+		case ValueClass_String:
+			return StringValue(std::string(stringValue(), stringLength()));
+
+		case ValueClass_Array:
+			return FlatArray(*this).toArray();
+
+		case ValueClass_Dictionary:
+			return FlatDictionary(*this).toDictionary();
+
+		default:
+			return ValueBase::Pointer();
+	}
+}
+
+/*
+ * FlatArray
+ */
+FlatArray::FlatArray(const FlatValue& value) :
+	FlatValue((value.valueClass() == ValueClass_Array) ? value : FlatValue()) { }
+
+size_t FlatArray::size() const
+{
+	return valid() ? readUInt32(_offset + 4) : 0;
+}
+
+FlatValue FlatArray::operator [] (size_t index) const
+{
+	return (index < size()) ? FlatValue(_base, readUInt32(_offset + 8 + 4 * static_cast<uint32_t>(index))) : FlatValue();
+}
+
+ArrayValue FlatArray::toArray() const
+{
+	ArrayValue result;
+
+	size_t count = size();
+	result->content.reserve(count);
+	for (size_t i = 0; i < count; ++i)
+		result->content.push_back((*this)[i].toValue());
+
+	return result;
+}
+
+/*
+ * FlatDictionary
+ */
+FlatDictionary::FlatDictionary(const FlatValue& value) :
+	FlatValue((value.valueClass() == ValueClass_Dictionary) ? value : FlatValue()) { }
+
+size_t FlatDictionary::size() const
+{
+	return valid() ? readUInt32(_offset + 4) : 0;
+}
+
+FlatValue FlatDictionary::objectForKey(const char* key, size_t keyLength) const
+{
+	size_t first = 0;
+	size_t last = size();
+	while (first < last)
+	{
+		size_t middle = first + (last - first) / 2;
+		uint32_t entryOffset = _offset + 8 + 8 * static_cast<uint32_t>(middle);
+
+		int comparison = compareKey(_base, readUInt32(entryOffset), key, keyLength);
+		if (comparison == 0)
+			return FlatValue(_base, readUInt32(entryOffset + 4));
+
+		if (comparison < 0)
+			first = middle + 1;
+		else
+			last = middle;
+	}
+	return FlatValue();
+}
+
+FlatValue FlatDictionary::keyAtIndex(size_t index) const
+{
+	return (index < size()) ? FlatValue(_base, readUInt32(_offset + 8 + 8 * static_cast<uint32_t>(index))) : FlatValue();
+}
+
+FlatValue FlatDictionary::valueAtIndex(size_t index) const
+{
+	return (index < size()) ? FlatValue(_base, readUInt32(_offset + 12 + 8 * static_cast<uint32_t>(index))) : FlatValue();
+}
+
+Dictionary FlatDictionary::toDictionary() const
+{
+	Dictionary result;
+
+	size_t count = size();
+	result->content.reserve(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		FlatValue key = keyAtIndex(i);
+		result->content.emplace(std::string(key.stringValue(), key.stringLength()), valueAtIndex(i).toValue());
+	}
+
+	return result;
+}
+
+/*
+ * FlatDocument
+ */
+BinaryDataStorage FlatDocument::build(const Dictionary& dictionary)
+{
+	FlatWriter writer;
+	uint32_t root = writer.writeValue(dictionary);
+	return writer.finish(root);
+}
+
+BinaryDataStorage FlatDocument::build(const ArrayValue& array)
+{
+	FlatWriter writer;
+	uint32_t root = writer.writeValue(array);
+	return writer.finish(root);
+}
+
+bool FlatDocument::isFlatData(const char* data, size_t size)
+{
+	return (data != nullptr) && (size >= FlatHeaderSize) &&
+		(memcmp(data, flatHeader, sizeof(flatHeader)) == 0) && (readWord(data, 4) == FlatVersion);
+}
+
+FlatDocument::FlatDocument(const char* data, size_t size)
+{
+	validate(data, size);
+}
+
+FlatDocument::FlatDocument(BinaryDataStorage&& data) :
+	_storage(std::move(data))
+{
+	validate(_storage.binary(), _storage.dataSize());
+}
+
+FlatDocument::FlatDocument(MappedFile::Pointer file) :
+	_mappedFile(file)
+{
+	if (_mappedFile.valid() && _mappedFile->valid())
+	{
+		_mappedFile->advise(MappedFile::Access::Random);
+		validate(_mappedFile->data(), _mappedFile->size());
+	}
+}
+
+void FlatDocument::validate(const char* data, size_t size)
+{
+	if (!isFlatData(data, size))
+	{
+		log::error("Invalid flat document header");
+		return;
+	}
+
+	uint32_t declaredSize = readWord(data, 12);
+	if ((declaredSize > size) || (declaredSize < FlatHeaderSize))
+	{
+		log::error("Flat document is truncated: %u bytes expected, %llu available",
+			declaredSize, static_cast<uint64_t>(size));
+		return;
+	}
+
+	FlatValidator validator(data, declaredSize);
+	uint32_t rootOffset = readWord(data, 8);
+	if (!validator.validateNode(rootOffset, 0))
+	{
+		log::error("Flat document is corrupted");
+		return;
+	}
+
+	_root = FlatValue(data, rootOffset);
+}
@@ -0,0 +1,210 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/core/mappedfile.h>
+
+#if (!ET_PLATFORM_WIN)
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+using namespace et;
+
+MappedFile::MappedFile(const std::string& path, Access access, Protection protection) :
+	_protection(protection)
+{
+	bool copyOnWrite = (protection == Protection::CopyOnWrite);
+
+#if (ET_PLATFORM_WIN)
+
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		(access == Access::Random) ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER fileSize = { };
+	if (GetFileSizeEx(file, &fileSize) && (fileSize.QuadPart > 0))
+	{
+		HANDLE mapping = CreateFileMappingA(file, nullptr, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+		if (mapping != nullptr)
+		{
+			_data = static_cast<const char*>(MapViewOfFile(mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+			_size = (_data == nullptr) ? 0 : static_cast<size_t>(fileSize.QuadPart);
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+
+#else
+
+	int file = open(path.c_str(), O_RDONLY);
+	if (file == -1)
+		return;
+
+	struct stat fileInfo = { };
+	if ((fstat(file, &fileInfo) == 0) && (fileInfo.st_size > 0))
+	{
+		int protectionFlags = copyOnWrite ? (PROT_READ | PROT_WRITE) : PROT_READ;
+		void* mapped = mmap(nullptr, static_cast<size_t>(fileInfo.st_size), protectionFlags, MAP_PRIVATE, file, 0);
+		if (mapped != MAP_FAILED)
+		{
+			_data = static_cast<const char*>(mapped);
+			_size = static_cast<size_t>(fileInfo.st_size);
+		}
+	}
+	close(file);
+
+#endif
+
+	if (_data != nullptr)
+		advise(access);
+}
+
+MappedFile::~MappedFile()
+{
+	if (_data == nullptr) return;
+
+#if (ET_PLATFORM_WIN)
+	UnmapViewOfFile(_data);
+#else
+	munmap(const_cast<char*>(_data), _size);
+#endif
+}
+
+BinaryDataStorage MappedFile::view(size_t offset, size_t size) const
+{
+	if ((offset > _size) || (size > _size - offset))
+	{
+		log::error("Requested view [%llu, %llu) is outside of the mapped file (%llu bytes)",
+			static_cast<uint64_t>(offset), static_cast<uint64_t>(offset + size), static_cast<uint64_t>(_size));
+		return BinaryDataStorage();
+	}
+
+	return BinaryDataStorage(reinterpret_cast<const unsigned char*>(_data + offset), size);
+}
+
+BinaryDataStorage MappedFile::mutableView(size_t offset, size_t size)
+{
+	if ((_protection != Protection::CopyOnWrite) || (offset > _size) || (size > _size - offset))
+	{
+		log::error("Unable to provide mutable view [%llu, %llu) of the mapped file (%llu bytes)",
+			static_cast<uint64_t>(offset), static_cast<uint64_t>(offset + size), static_cast<uint64_t>(_size));
+		return BinaryDataStorage();
+	}
+
+	return BinaryDataStorage(reinterpret_cast<unsigned char*>(const_cast<char*>(_data + offset)), size);
+}
+
+void MappedFile::advise(Access access, size_t offset, size_t size) const
+{
+#if (ET_PLATFORM_WIN)
+
+	(void)access;
+	(void)offset;
+	(void)size;
+
+#else
+
+	if ((_data == nullptr) || (offset >= _size))
+		return;
+
+	/*
+	 * madvise requires page-aligned address
+	 */
+	uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+	uintptr_t begin = reinterpret_cast<uintptr_t>(_data + offset) & ~(pageSize - 1);
+	uintptr_t end = reinterpret_cast<uintptr_t>(_data + offset + etMin(size, _size - offset));
+
+	int advice = MADV_NORMAL;
+	switch (access)
+	{
+		case Access::Sequential:
+			advice = MADV_SEQUENTIAL;
+			break;
+		case Access::Random:
+			advice = MADV_RANDOM;
+			break;
+		case Access::WillNeed:
+			advice = MADV_WILLNEED;
+			break;
+		case Access::DontNeed:
+			advice = MADV_DONTNEED;
+			break;
+		default:
+			break;
+	}
+
+	madvise(reinterpret_cast<void*>(begin), static_cast<size_t>(end - begin), advice);
+
+#endif
+}
+
+/*
+ * MemoryStreamBuffer
+ */
+MemoryStreamBuffer::MemoryStreamBuffer(const char* data, size_t size)
+{
+	char* begin = const_cast<char*>(data);
+	setg(begin, begin, begin + size);
+}
+
+MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekoff(off_type offset, std::ios_base::seekdir direction,
+	std::ios_base::openmode mode)
+{
+	if ((mode & std::ios_base::in) == 0)
+		return pos_type(off_type(-1));
+
+	char* base = eback();
+	if (direction == std::ios_base::cur)
+		base = gptr();
+	else if (direction == std::ios_base::end)
+		base = egptr();
+
+	off_type position = static_cast<off_type>(base - eback()) + offset;
+	if ((position < 0) || (position > static_cast<off_type>(egptr() - eback())))
+		return pos_type(off_type(-1));
+
+	setg(eback(), eback() + position, egptr());
+	return pos_type(position);
+}
+
+MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekpos(pos_type position, std::ios_base::openmode mode)
+{
+	return seekoff(off_type(position), std::ios_base::beg, mode);
+}
+
+std::streamsize MemoryStreamBuffer::xsgetn(char_type* output, std::streamsize count)
+{
+	std::streamsize available = static_cast<std::streamsize>(egptr() - gptr());
+	std::streamsize toCopy = etMin(count, available);
+	if (toCopy > 0)
+	{
+		etCopyMemory(output, gptr(), static_cast<size_t>(toCopy));
+		setg(eback(), gptr() + toCopy, egptr());
+	}
+	return toCopy;
+}
+
+std::streamsize MemoryStreamBuffer::showmanyc()
+{
+	std::streamsize available = static_cast<std::streamsize>(egptr() - gptr());
+	return (available > 0) ? available : -1;
+}
+
+/*
+ * MappedFileStream
+ */
+MappedFileStream::MappedFileStream(MappedFile::Pointer file) :
+	std::istream(nullptr), _file(file), _buffer(file->data(), file->size())
+{
+	rdbuf(&_buffer);
+	if (!_file->valid())
+		setstate(std::ios_base::failbit);
+}
@@ -8,6 +8,12 @@
 #include <et/core/et.h>
 #include <et/threading/criticalsection.h>
 #include <et/core/staticdatastorage.h>
+#include <et/core/memorytags.h>
+#include <unordered_set>
+
+#if (!ET_PLATFORM_WIN)
+#	include <sys/mman.h>
+#endif
 
 namespace et
 {
@@ -24,9 +30,23 @@ namespace et
 		notAllocatedValue = 0xffffffff,
 		defaultChunkSize = 16 * megabytes,
 		minimumAllocationSize = 32,
-		smallBlockSize = 60,
-		mediumBlockSize = 124,
+		
+		smallBlockPageSize = 64 * 1024,
+		smallBlockPageHeaderSize = 64,
+		smallBlockGranularity = 16,
+		smallBlockClassesCount = 8,
+		maximumSmallBlockSize = 256,
+		smallBlockClassLookupSize = maximumSmallBlockSize / smallBlockGranularity + 1,
 	};
+	
+	static const uint32_t smallBlockSizes[smallBlockClassesCount] =
+		{ 16, 32, 48, 64, 96, 128, 192, 256 };
+	
+	/*
+	 * Maps (size + 15) / 16 to index in smallBlockSizes
+	 */
+	static const uint8_t smallBlockClassLookup[smallBlockClassLookupSize] =
+		{ 0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7 };
 
 	struct MemoryChunkInfo
 	{
@@ -37,7 +57,7 @@ namespace et
 				uint32_t allocated;
 				uint32_t begin;
 				uint32_t length;
-				uint32_t dummy;
+				uint32_t tag;
 			};
 			
 			struct
@@ -48,7 +68,7 @@ namespace et
 		};
 
 		MemoryChunkInfo() : 
-			allocated(notAllocatedValue), begin(0), length(0), dummy(0) { }
+			allocated(notAllocatedValue), begin(0), length(0), tag(memory::NotAccountedTag) { }
 		
 		void swapWith(MemoryChunkInfo* info)
 		{
@@ -70,8 +90,8 @@ namespace et
 		
 		~MemoryChunk();
 		
-		bool allocate(uint32_t size, void*& result);
-		bool free(char*);
+		bool allocate(uint32_t size, uint32_t tag, void*& result);
+		bool free(char*, uint32_t& freedSize, uint32_t& freedTag);
 		
 		bool containsPointer(char*);
 		
@@ -109,108 +129,90 @@ namespace et
 	};
 	
 	
-	template <int blockSize>
+	struct SmallMemoryBlockNode
+	{
+		SmallMemoryBlockNode* next = nullptr;
+	};
+	
+	struct SmallMemoryBlockPage
+	{
+		SmallMemoryBlockPage* next = nullptr;
+		SmallMemoryBlockPage* previous = nullptr;
+		SmallMemoryBlockNode* freeBlocks = nullptr;
+		char* blocksBegin = nullptr;
+		char* unusedBlocks = nullptr;
+		char* blocksEnd = nullptr;
+		uint32_t blockSize = 0;
+		uint32_t capacity = 0;
+		uint32_t allocatedBlocks = 0;
+		uint32_t sizeClass = 0;
+		
+		bool full() const
+			{ return allocatedBlocks == capacity; }
+		
+		bool empty() const
+			{ return allocatedBlocks == 0; }
+		
+		uint8_t* blockTags() const
+			{ return reinterpret_cast<uint8_t*>(blocksEnd); }
+	};
+	
+	static_assert(sizeof(SmallMemoryBlockPage) <= smallBlockPageHeaderSize,
+		"Small memory block page header does not fit into reserved space");
+	
+	using SmallMemoryBlockPageSet = std::unordered_set<uintptr_t>;
+	
+	/*
+	 * Free-list slab for a single size class. Pages are obtained directly from the OS,
+	 * aligned to their size, so that owning page could be found by masking pointer.
+	 * Each page keeps intrusive list of released blocks and a bump pointer into
+	 * never used region, so both allocation and deallocation are O(1).
+	 * Memory tag of each block is stored in a byte array after the blocks.
+	 */
 	class SmallMemoryBlockAllocator
 	{
 	public:
-		enum
-		{
-			BlockSize = blockSize
-		};
+		SmallMemoryBlockAllocator() = default;
+		~SmallMemoryBlockAllocator();
 		
-		SmallMemoryBlockAllocator()
-		{
-			auto sizeToAllocate = blocksCount * sizeof(SmallMemoryBlock);
-			blocks = reinterpret_cast<SmallMemoryBlock*>(calloc(1, sizeToAllocate));
-			firstBlock = blocks;
-			currentBlock = firstBlock;
-			lastBlock = firstBlock + blocksCount;
-		}
+		void setSizeClass(uint32_t sizeClass, uint32_t blockSize)
+			{ _sizeClass = sizeClass; _blockSize = blockSize; }
 		
-		~SmallMemoryBlockAllocator()
-		{
-			log::ConsoleOutput lOut;
-			for (auto i = firstBlock; i != lastBlock; ++i)
-			{
-				if (i->blockAllocated)
-					lOut.info("Memory leak detected: %d bytes, offset %lld", blockSize, (int64_t)(i - firstBlock));
-			}
-			::free(blocks);
-		}
+		bool allocate(void*& result, uint32_t tag, SmallMemoryBlockPageSet& pages);
+		uint32_t free(SmallMemoryBlockPage* page, void* ptr, SmallMemoryBlockPageSet& pages);
 		
-		bool allocate(void*& result)
-		{
-			auto startBlock = currentBlock;
-			
-			while (currentBlock->blockAllocated)
-			{
-				currentBlock = advance(currentBlock);
-				if (currentBlock == startBlock)
-				{
-					_haveFreeBlocks = false;
-					log::warning("Small memory block (%d) filled.", blockSize);
-					return false;
-				}
-			}
-			
-			currentBlock->blockAllocated = 1;
-			result = currentBlock->data;
-			currentBlock = advance(currentBlock);
-			
-			return true;
-		}
+		void flushUnusedPages(SmallMemoryBlockPageSet& pages);
 		
-		void free(void* ptr)
-		{
-			SmallMemoryBlock* block = reinterpret_cast<SmallMemoryBlock*>(ptr);
-			
-			if ((ptr < firstBlock) || (ptr > lastBlock))
-				ET_FAIL_FMT("Pointer being freed (0x%016llx) was not allocated via this allocator.", (int64_t)ptr);
-			
-			block->blockAllocated = 0;
-			
-			if (!_haveFreeBlocks)
-				currentBlock = block;
-
-			_haveFreeBlocks = true;
-		}
+		uint32_t blockSize() const
+			{ return _blockSize; }
 		
-		bool containsPointer(void* ptr)
-		{
-			SmallMemoryBlock* block = reinterpret_cast<SmallMemoryBlock*>(ptr);
-			return (block >= firstBlock) && (block < lastBlock);
-		}
+		uint32_t pagesCount() const
+			{ return _pagesCount; }
+		
+		uint32_t allocatedBlocks() const
+			{ return _allocatedBlocks; }
 		
-		bool haveFreeBlocks()
-			{ return _haveFreeBlocks; }
+		uint32_t blocksCapacity() const
+			{ return _blocksCapacity; }
 		
 	private:
-		enum
-		{
-			blocksCount = 8 * megabytes / (blockSize + 4)
-		};
+		SmallMemoryBlockPage* createPage(SmallMemoryBlockPageSet& pages);
+		void releasePage(SmallMemoryBlockPage* page, SmallMemoryBlockPageSet& pages);
 		
-		struct SmallMemoryBlock
-		{
-			static_assert((blockSize + sizeof(uint32_t)) % 32 == 0,
-				"Invalid block size will cause troubles allocating aligned objects");
-			
-			char data[blockSize];
-			uint32_t blockAllocated = 0;
-		};
+		void insertPage(SmallMemoryBlockPage*& list, SmallMemoryBlockPage* page);
+		void removePage(SmallMemoryBlockPage*& list, SmallMemoryBlockPage* page);
 		
-		SmallMemoryBlock* advance(SmallMemoryBlock* b)
-		{
-			++b;
-			return (b == lastBlock) ? firstBlock : b;
-		}
+		ET_DENY_COPY(SmallMemoryBlockAllocator)
 		
-	public:
-		SmallMemoryBlock* blocks = nullptr;
-		SmallMemoryBlock* firstBlock = nullptr;
-		SmallMemoryBlock* lastBlock = nullptr;
-		SmallMemoryBlock* currentBlock = nullptr;
-		bool _haveFreeBlocks = true;
+	private:
+		SmallMemoryBlockPage* _availablePages = nullptr;
+		SmallMemoryBlockPage* _fullPages = nullptr;
+		SmallMemoryBlockPage* _reservedPage = nullptr;
+		uint32_t _sizeClass = 0;
+		uint32_t _blockSize = 0;
+		uint32_t _pagesCount = 0;
+		uint32_t _allocatedBlocks = 0;
+		uint32_t _blocksCapacity = 0;
 	};
 	
 	class BlockMemoryAllocatorPrivate
@@ -227,12 +229,15 @@ namespace et
 		
 		void printInfo();
 		
+	private:
+		SmallMemoryBlockPage* smallBlockPageForPointer(void*);
+		
 	private:
 		CriticalSection _csLock;
 		std::list<MemoryChunk> _chunks;
 		
-		SmallMemoryBlockAllocator<smallBlockSize> _allocatorSmall;
-		SmallMemoryBlockAllocator<mediumBlockSize> _allocatorMedium;
+		SmallMemoryBlockPageSet _smallBlockPages;
+		SmallMemoryBlockAllocator _smallBlockAllocators[smallBlockClassesCount];
 	};
 }
 
@@ -242,7 +247,7 @@ inline uint32_t alignUpTo(uint32_t sz, uint32_t al)
 {
 	ET_ASSERT(sz > 0);
 	auto m = al-1;
-	return sz + m & (~m);
+	return (sz + m) & ~m;
 }
 
 inline uint32_t alignDownTo(uint32_t sz, uint32_t al)
@@ -251,6 +256,11 @@ inline uint32_t alignDownTo(uint32_t sz, uint32_t al)
 	return sz & (~(al-1));
 }
 
+static void* allocateSmallBlockPage();
+static void releaseSmallBlockPage(void*);
+static void* allocateAlignedMemory(size_t size, size_t alignment);
+static void releaseAlignedMemory(void*);
+
 BlockMemoryAllocator::BlockMemoryAllocator()
 {
 	ET_PIMPL_INIT(BlockMemoryAllocator)
@@ -262,7 +272,7 @@ BlockMemoryAllocator::~BlockMemoryAllocator()
 }
 
 void* BlockMemoryAllocator::allocate(size_t sz)
-	{ return _private->alloc(alignUpTo(sz & 0xffffffff, minimumAllocationSize)); }
+	{ return _private->alloc(static_cast<uint32_t>(sz & 0xffffffff)); }
 
 void BlockMemoryAllocator::release(void* ptr)
 	{ _private->free(ptr); }
@@ -276,38 +286,98 @@ void BlockMemoryAllocator::printInfo() const
 void BlockMemoryAllocator::flushUnusedBlocks()
 	{ _private->flushUnusedBlocks(); }
 
+/*
+ * Default allocator stores size and memory tag in a header before allocated block
+ */
+struct DefaultAllocationHeader
+{
+	uint64_t size;
+	uint32_t tag;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(DefaultAllocationHeader) == 16, "Default allocation header should preserve alignment");
+
+void* DefaultMemoryAllocator::allocate(size_t sz)
+{
+	auto header = static_cast<DefaultAllocationHeader*>(malloc(sizeof(DefaultAllocationHeader) + sz));
+	if (header == nullptr)
+		return nullptr;
+	
+	header->size = sz;
+	header->tag = memory::tagForNewAllocation();
+	memory::recordAllocation(header->tag, sz, header + 1);
+	
+	return header + 1;
+}
+
+void DefaultMemoryAllocator::release(void* ptr)
+{
+	if (ptr == nullptr) return;
+	
+	auto header = static_cast<DefaultAllocationHeader*>(ptr) - 1;
+	memory::recordDeallocation(header->tag, static_cast<size_t>(header->size), ptr);
+	::free(header);
+}
+
+void DefaultMemoryAllocator::printInfo() const
+{
+	log::info("Process memory usage: %zu (%zuKb)", memoryUsage(), memoryUsage() / 1024);
+	memory::printTagStatistics();
+}
+
 /*
  * Private
  */
 
 BlockMemoryAllocatorPrivate::BlockMemoryAllocatorPrivate()
 {
+	for (uint32_t i = 0; i < smallBlockClassesCount; ++i)
+		_smallBlockAllocators[i].setSizeClass(i, smallBlockSizes[i]);
+	
 	_chunks.emplace_back(defaultChunkSize);
 }
 
+SmallMemoryBlockPage* BlockMemoryAllocatorPrivate::smallBlockPageForPointer(void* ptr)
+{
+	auto pageAddress = reinterpret_cast<uintptr_t>(ptr) & ~static_cast<uintptr_t>(smallBlockPageSize - 1);
+	return (_smallBlockPages.count(pageAddress) > 0) ? reinterpret_cast<SmallMemoryBlockPage*>(pageAddress) : nullptr;
+}
+
 void* BlockMemoryAllocatorPrivate::alloc(uint32_t allocSize)
 {
 	CriticalSectionScope lock(_csLock);
 	
 	void* result = nullptr;
+	uint32_t tag = memory::tagForNewAllocation();
 	
-	if ((allocSize <= smallBlockSize) && _allocatorSmall.haveFreeBlocks() && _allocatorSmall.allocate(result))
-		return result;
+	if (allocSize <= maximumSmallBlockSize)
+	{
+		auto sizeClass = smallBlockClassLookup[(allocSize + smallBlockGranularity - 1) / smallBlockGranularity];
+		auto& allocator = _smallBlockAllocators[sizeClass];
+		if (allocator.allocate(result, tag, _smallBlockPages))
+		{
+			memory::recordAllocation(tag, allocator.blockSize(), result);
+			return result;
+		}
+	}
 	
-	if ((allocSize <= mediumBlockSize) && _allocatorMedium.haveFreeBlocks() && _allocatorMedium.allocate(result))
-		return result;
+	allocSize = alignUpTo(etMax(allocSize, 1u), minimumAllocationSize);
 	
+	bool allocated = false;
 	for (MemoryChunk& chunk : _chunks)
 	{
-		if (chunk.allocate(allocSize, result))
-			return result;
+		allocated = chunk.allocate(allocSize, tag, result);
+		if (allocated) break;
 	}
 	
-	_chunks.emplace_back(alignUpTo(allocSize, defaultChunkSize));
-	
-	auto& lastChunk = _chunks.back();
-	lastChunk.allocate(allocSize, result);
+	if (!allocated)
+	{
+		_chunks.emplace_back(alignUpTo(allocSize, defaultChunkSize));
+		_chunks.back().allocate(allocSize, tag, result);
+	}
 	
+	memory::recordAllocation(tag, allocSize, result);
 	return result;
 }
 
@@ -318,11 +388,16 @@ bool BlockMemoryAllocatorPrivate::validate(void* ptr, bool abortOnFail)
 	
 	CriticalSectionScope lock(_csLock);
 	
-	if (_allocatorSmall.containsPointer(ptr))
-		return true;
-	
-	if (_allocatorMedium.containsPointer(ptr))
-		return true;
+	auto page = smallBlockPageForPointer(ptr);
+	if (page != nullptr)
+	{
+		auto charPtr = static_cast<char*>(ptr);
+		if ((charPtr >= page->blocksBegin) && (charPtr < page->unusedBlocks) &&
+			((charPtr - page->blocksBegin) % page->blockSize == 0))
+		{
+			return true;
+		}
+	}
 
 	auto charPtr = static_cast<char*>(ptr);
 	for (MemoryChunk& chunk : _chunks)
@@ -334,7 +409,7 @@ bool BlockMemoryAllocatorPrivate::validate(void* ptr, bool abortOnFail)
 	if (abortOnFail)
 	{
 		uint64_t address = reinterpret_cast<uint64_t>(ptr);
-		ET_FAIL_FMT("Pointer being freed (0x%016llx) was not allocated via this allocator.", address);
+		ET_FAIL_FMT("Pointer being freed (0x%016llx) was not allocated via this allocator.", static_cast<unsigned long long>(address));
 	}
 	
 	return false;
@@ -344,6 +419,9 @@ void BlockMemoryAllocatorPrivate::flushUnusedBlocks()
 {
 	CriticalSectionScope lock(_csLock);
 	
+	for (auto& allocator : _smallBlockAllocators)
+		allocator.flushUnusedPages(_smallBlockPages);
+	
 	uint32_t blocksFlushed = 0;
 	uint32_t memoryReleased = 0;
 	
@@ -386,24 +464,29 @@ void BlockMemoryAllocatorPrivate::free(void* ptr)
 	
 	CriticalSectionScope lock(_csLock);
 	
-	if (_allocatorSmall.containsPointer(ptr))
-	{
-		_allocatorSmall.free(ptr);
-	}
-	else if (_allocatorMedium.containsPointer(ptr))
+	auto page = smallBlockPageForPointer(ptr);
+	if (page != nullptr)
 	{
-		_allocatorMedium.free(ptr);
+		uint32_t blockSize = page->blockSize;
+		uint32_t tag = _smallBlockAllocators[page->sizeClass].free(page, ptr, _smallBlockPages);
+		memory::recordDeallocation(tag, blockSize, ptr);
 	}
 	else
 	{
+		uint32_t freedSize = 0;
+		uint32_t freedTag = memory::NotAccountedTag;
+		
 		auto charPtr = static_cast<char*>(ptr);
 		for (MemoryChunk& chunk : _chunks)
 		{
-			if (chunk.free(charPtr))
+			if (chunk.free(charPtr, freedSize, freedTag))
+			{
+				memory::recordDeallocation(freedTag, freedSize, ptr);
 				return;
+			}
 		}
 		
-		ET_FAIL_FMT("Pointer being freed (0x%016llx) was not allocated via this allocator.", (int64_t)ptr);
+		ET_FAIL_FMT("Pointer being freed (0x%016llx) was not allocated via this allocator.", static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(ptr)));
 	}
 }
 
@@ -447,27 +530,18 @@ void BlockMemoryAllocatorPrivate::printInfo()
 		log::info("\t}");
 	}
 	
-	uint32_t allocatedBlocks = 0;
-
-	log::info("\t0...48 bytes");
-	log::info("\t{");
-	allocatedBlocks = 0;
-	for (auto i = _allocatorSmall.firstBlock; i != _allocatorSmall.lastBlock; ++i)
-		allocatedBlocks += i->blockAllocated;
-	log::info("\t\tallocated blocks : %u of %lld", allocatedBlocks, (int64_t)(_allocatorSmall.lastBlock - _allocatorSmall.firstBlock));
-	log::info("\t\tcurrent offset : %lld", (int64_t)(_allocatorSmall.currentBlock - _allocatorSmall.firstBlock));
-	log::info("\t},");
-	
-	log::info("\t48...96");
-	log::info("\t{");
-	allocatedBlocks = 0;
-	for (auto i = _allocatorMedium.firstBlock; i != _allocatorMedium.lastBlock; ++i)
-		allocatedBlocks += i->blockAllocated;
-	log::info("\t\tallocated blocks : %u of %lld", allocatedBlocks,  (int64_t)(_allocatorMedium.lastBlock - _allocatorMedium.firstBlock));
-	log::info("\t\tcurrent offset : %lld", (int64_t)(_allocatorMedium.currentBlock - _allocatorMedium.firstBlock));
-	log::info("\t}");
+	for (const auto& allocator : _smallBlockAllocators)
+	{
+		log::info("\t%u bytes", allocator.blockSize());
+		log::info("\t{");
+		log::info("\t\tallocated blocks : %u of %u", allocator.allocatedBlocks(), allocator.blocksCapacity());
+		log::info("\t\tpages : %u (%uKb)", allocator.pagesCount(), allocator.pagesCount() * smallBlockPageSize / 1024);
+		log::info("\t},");
+	}
 	
 	log::info("}");
+	
+	memory::printTagStatistics();
 }
 
 /*
@@ -488,21 +562,7 @@ MemoryChunk::MemoryChunk(uint32_t capacity) :
 	actualDataOffset = alignUpTo(maxInfoChunks * sizeof(MemoryChunkInfo), minimumAllocationSize);
 	size_t sizeToAllocate = alignUpTo(actualDataOffset + capacity, minimumAllocationSize);
 	
-#if (ET_PLATFORM_APPLE)
-	
-	void* allocatedPtr = nullptr;
-	posix_memalign(&allocatedPtr, minimumAllocationSize, sizeToAllocate);
-	allocatedMemoryBegin = static_cast<char*>(allocatedPtr);
-	
-#elif (ET_PLATFORM_WIN)
-	
-	allocatedMemoryBegin = static_cast<char*>(_aligned_malloc(sizeToAllocate, minimumAllocationSize));
-	
-#else
-#
-#	error Use any available aligned malloc
-#
-#endif
+	allocatedMemoryBegin = static_cast<char*>(allocateAlignedMemory(sizeToAllocate, minimumAllocationSize));
 	
 	allocatedMemoryEnd = allocatedMemoryBegin + actualDataOffset + capacity;
 	firstInfo = reinterpret_cast<MemoryChunkInfo*>(allocatedMemoryBegin);
@@ -535,15 +595,11 @@ MemoryChunk::~MemoryChunk()
 			++info;
 		}
 		
-#	if (ET_PLATFORM_WIN)
-		_aligned_free(allocatedMemoryBegin);
-#	else
-		::free(allocatedMemoryBegin);
-#	endif
+		releaseAlignedMemory(allocatedMemoryBegin);
 	}
 }
 
-bool MemoryChunk::allocate(uint32_t sizeToAllocate, void*& result)
+bool MemoryChunk::allocate(uint32_t sizeToAllocate, uint32_t tag, void*& result)
 {
 	MemoryChunkInfo* info = firstInfo;
 	while (info < lastInfo)
@@ -555,6 +611,7 @@ bool MemoryChunk::allocate(uint32_t sizeToAllocate, void*& result)
 			
 			info->allocated = allocatedValue;
 			info->length = sizeToAllocate;
+			info->tag = tag;
 			
 			if (remaining > minimumAllocationSize)
 			{
@@ -575,6 +632,7 @@ bool MemoryChunk::allocate(uint32_t sizeToAllocate, void*& result)
 				nextInfo->allocated = notAllocatedValue;
 				nextInfo->begin = info->begin + info->length;
 				nextInfo->length = remaining;
+				nextInfo->tag = memory::NotAccountedTag;
 			}
 			
 			result = allocatedMemoryBegin + actualDataOffset + info->begin;
@@ -597,6 +655,7 @@ bool MemoryChunk::allocate(uint32_t sizeToAllocate, void*& result)
 
 inline void MemoryChunk::validateInfo(et::MemoryChunkInfo* info)
 {
+	(void)info;
 	ET_ASSERT((info->allocated == allocatedValue) || (info->allocated == notAllocatedValue));
 	ET_ASSERT(info->begin < size);
 	ET_ASSERT(info->length <= size);
@@ -619,7 +678,7 @@ bool MemoryChunk::containsPointer(char* ptr)
 	return false;
 }
 
-bool MemoryChunk::free(char* ptr)
+bool MemoryChunk::free(char* ptr, uint32_t& freedSize, uint32_t& freedTag)
 {
 	if ((ptr < allocatedMemoryBegin + actualDataOffset) || (ptr >= allocatedMemoryEnd)) return false;
 	uint32_t offset = static_cast<uint32_t>(ptr - (allocatedMemoryBegin + actualDataOffset));
@@ -632,7 +691,7 @@ bool MemoryChunk::free(char* ptr)
 		{
 			if (i->allocated == notAllocatedValue)
 			{
-				ET_FAIL_FMT("Pointer being freed (0x%016llx) was already deleted from this memory chunk.", reinterpret_cast<uint64_t>(ptr));
+				ET_FAIL_FMT("Pointer being freed (0x%016llx) was already deleted from this memory chunk.", static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(ptr)));
 				return false;
 			}
 			else
@@ -644,7 +703,11 @@ bool MemoryChunk::free(char* ptr)
 					log::info("Deallocated %u bytes (%uKb, %uMb)", i->length, i->length / 1024, i->length / megabytes);
 #			endif
 				
+				freedSize = i->length;
+				freedTag = i->tag;
+				
 				i->allocated = notAllocatedValue;
+				i->tag = memory::NotAccountedTag;
 				compress();
 				return true;
 			}
@@ -686,3 +749,266 @@ void MemoryChunk::compress()
 		}
 	}
 }
+
+/*
+ * Small memory blocks
+ */
+SmallMemoryBlockAllocator::~SmallMemoryBlockAllocator()
+{
+	log::ConsoleOutput lOut;
+	
+	auto page = _availablePages;
+	while (page != nullptr)
+	{
+		auto nextPage = page->next;
+		if (!page->empty())
+			lOut.info("Memory leak detected: %u blocks of %u bytes", page->allocatedBlocks, _blockSize);
+		releaseSmallBlockPage(page);
+		page = nextPage;
+	}
+	
+	page = _fullPages;
+	while (page != nullptr)
+	{
+		auto nextPage = page->next;
+		lOut.info("Memory leak detected: %u blocks of %u bytes", page->allocatedBlocks, _blockSize);
+		releaseSmallBlockPage(page);
+		page = nextPage;
+	}
+	
+	if (_reservedPage != nullptr)
+		releaseSmallBlockPage(_reservedPage);
+}
+
+bool SmallMemoryBlockAllocator::allocate(void*& result, uint32_t tag, SmallMemoryBlockPageSet& pages)
+{
+	auto page = _availablePages;
+	
+	if (page == nullptr)
+	{
+		if (_reservedPage != nullptr)
+		{
+			page = _reservedPage;
+			_reservedPage = nullptr;
+		}
+		else
+		{
+			page = createPage(pages);
+			if (page == nullptr)
+				return false;
+		}
+		insertPage(_availablePages, page);
+	}
+	
+	if (page->freeBlocks != nullptr)
+	{
+		result = page->freeBlocks;
+		page->freeBlocks = page->freeBlocks->next;
+	}
+	else
+	{
+		ET_ASSERT(page->unusedBlocks + page->blockSize <= page->blocksEnd);
+		result = page->unusedBlocks;
+		page->unusedBlocks += page->blockSize;
+	}
+	
+	auto blockIndex = static_cast<uint32_t>(static_cast<char*>(result) - page->blocksBegin) / page->blockSize;
+	page->blockTags()[blockIndex] = static_cast<uint8_t>(tag);
+	
+	++page->allocatedBlocks;
+	++_allocatedBlocks;
+	
+	if (page->full())
+	{
+		removePage(_availablePages, page);
+		insertPage(_fullPages, page);
+	}
+	
+	return true;
+}
+
+uint32_t SmallMemoryBlockAllocator::free(SmallMemoryBlockPage* page, void* ptr, SmallMemoryBlockPageSet& pages)
+{
+	auto charPtr = static_cast<char*>(ptr);
+	auto blockOffset = static_cast<uint32_t>(charPtr - page->blocksBegin);
+	
+	if ((charPtr < page->blocksBegin) || (charPtr >= page->unusedBlocks) ||
+		(blockOffset % page->blockSize != 0) || page->empty())
+	{
+		ET_FAIL_FMT("Pointer being freed (0x%016llx) was not allocated via this allocator.", static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(ptr)));
+	}
+	
+	uint32_t tag = page->blockTags()[blockOffset / page->blockSize];
+	
+	if (page->full())
+	{
+		removePage(_fullPages, page);
+		insertPage(_availablePages, page);
+	}
+	
+	auto node = reinterpret_cast<SmallMemoryBlockNode*>(ptr);
+	node->next = page->freeBlocks;
+	page->freeBlocks = node;
+	
+	--page->allocatedBlocks;
+	--_allocatedBlocks;
+	
+	if (page->empty())
+	{
+		removePage(_availablePages, page);
+		
+		if (_reservedPage == nullptr)
+		{
+			page->freeBlocks = nullptr;
+			page->unusedBlocks = page->blocksBegin;
+			_reservedPage = page;
+		}
+		else
+		{
+			releasePage(page, pages);
+		}
+	}
+	
+	return tag;
+}
+
+void SmallMemoryBlockAllocator::flushUnusedPages(SmallMemoryBlockPageSet& pages)
+{
+	if (_reservedPage != nullptr)
+	{
+		releasePage(_reservedPage, pages);
+		_reservedPage = nullptr;
+	}
+}
+
+SmallMemoryBlockPage* SmallMemoryBlockAllocator::createPage(SmallMemoryBlockPageSet& pages)
+{
+	void* pageMemory = allocateSmallBlockPage();
+	if (pageMemory == nullptr)
+	{
+		log::warning("Unable to allocate page for small memory blocks (%u).", _blockSize);
+		return nullptr;
+	}
+	
+	auto page = new (pageMemory) SmallMemoryBlockPage();
+	page->blockSize = _blockSize;
+	page->sizeClass = _sizeClass;
+	page->capacity = (smallBlockPageSize - smallBlockPageHeaderSize) / (_blockSize + sizeof(uint8_t));
+	page->blocksBegin = static_cast<char*>(pageMemory) + smallBlockPageHeaderSize;
+	page->blocksEnd = page->blocksBegin + page->capacity * _blockSize;
+	page->unusedBlocks = page->blocksBegin;
+	
+	pages.insert(reinterpret_cast<uintptr_t>(pageMemory));
+	
+	++_pagesCount;
+	_blocksCapacity += page->capacity;
+	
+	return page;
+}
+
+void SmallMemoryBlockAllocator::releasePage(SmallMemoryBlockPage* page, SmallMemoryBlockPageSet& pages)
+{
+	ET_ASSERT(page->empty());
+	
+	pages.erase(reinterpret_cast<uintptr_t>(page));
+	
+	--_pagesCount;
+	_blocksCapacity -= page->capacity;
+	
+	releaseSmallBlockPage(page);
+}
+
+void SmallMemoryBlockAllocator::insertPage(SmallMemoryBlockPage*& list, SmallMemoryBlockPage* page)
+{
+	page->previous = nullptr;
+	page->next = list;
+	
+	if (list != nullptr)
+		list->previous = page;
+	
+	list = page;
+}
+
+void SmallMemoryBlockAllocator::removePage(SmallMemoryBlockPage*& list, SmallMemoryBlockPage* page)
+{
+	if (page->previous != nullptr)
+		page->previous->next = page->next;
+	else
+		list = page->next;
+	
+	if (page->next != nullptr)
+		page->next->previous = page->previous;
+	
+	page->next = nullptr;
+	page->previous = nullptr;
+}
+
+/*
+ * Platform-specific memory
+ */
+void* allocateSmallBlockPage()
+{
+#if (ET_PLATFORM_WIN)
+	
+	/*
+	 * VirtualAlloc returns memory aligned to allocation granularity (64Kb)
+	 */
+	return VirtualAlloc(nullptr, smallBlockPageSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	
+#else
+	
+	/*
+	 * mmap only guarantees alignment to system page, so reserve twice
+	 * the size and unmap unaligned head and tail
+	 */
+	size_t reservedSize = 2 * smallBlockPageSize;
+	void* reserved = mmap(nullptr, reservedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+	if (reserved == MAP_FAILED)
+		return nullptr;
+	
+	auto reservedBegin = static_cast<char*>(reserved);
+	auto reservedEnd = reservedBegin + reservedSize;
+	
+	auto mask = static_cast<uintptr_t>(smallBlockPageSize - 1);
+	auto alignedBegin = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(reservedBegin) + mask) & ~mask);
+	auto alignedEnd = alignedBegin + smallBlockPageSize;
+	
+	if (alignedBegin > reservedBegin)
+		munmap(reservedBegin, static_cast<size_t>(alignedBegin - reservedBegin));
+	
+	if (reservedEnd > alignedEnd)
+		munmap(alignedEnd, static_cast<size_t>(reservedEnd - alignedEnd));
+	
+	return alignedBegin;
+	
+#endif
+}
+
+void releaseSmallBlockPage(void* ptr)
+{
+#if (ET_PLATFORM_WIN)
+	VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+	munmap(ptr, smallBlockPageSize);
+#endif
+}
+
+void* allocateAlignedMemory(size_t size, size_t alignment)
+{
+#if (ET_PLATFORM_WIN)
+	return _aligned_malloc(size, alignment);
+#else
+	void* result = nullptr;
+	posix_memalign(&result, alignment, size);
+	return result;
+#endif
+}
+
+void releaseAlignedMemory(void* ptr)
+{
+#if (ET_PLATFORM_WIN)
+	_aligned_free(ptr);
+#else
+	::free(ptr);
+#endif
+}
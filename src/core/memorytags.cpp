@@ -0,0 +1,377 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <mutex>
+#include <unordered_map>
+#include <et/core/memorytags.h>
+#include <et/json/json.h>
+
+#if (ET_PLATFORM_ANDROID)
+#	include <unwind.h>
+#	include <dlfcn.h>
+#elif (!ET_PLATFORM_WIN)
+#	include <execinfo.h>
+#	include <dlfcn.h>
+#endif
+
+namespace et
+{
+	namespace memory
+	{
+		struct TagCounters
+		{
+			std::atomic<int64_t> currentBytes;
+			std::atomic<int64_t> peakBytes;
+			std::atomic<int64_t> liveAllocations;
+			std::atomic<uint64_t> totalAllocations;
+		};
+
+		using CallStackSampleMap = std::unordered_map<void*, CallStackSample>;
+
+		/*
+		 * All state here is used from inside of the allocator, including allocations
+		 * made during static initialization and after static destruction, so it is kept
+		 * in zero-initialized storage and never destroyed.
+		 */
+		static TagCounters tagCounters[MaxTagsCount];
+		static char tagNames[MaxTagsCount][MaxTagNameLength];
+		static std::atomic<uint32_t> registeredTags(0);
+		static std::atomic<bool> accountingDisabled(false);
+		static std::atomic<uint32_t> samplingInterval(0);
+		static std::atomic<uint32_t> samplingCounter(0);
+		static std::atomic<uint32_t> liveSamplesCount(0);
+		static std::mutex tagsLock;
+		static std::mutex samplesLock;
+		static CallStackSampleMap* samples = nullptr;
+		static thread_local uint32_t currentThreadTag = DefaultTag;
+
+		uint32_t captureCallStack(void** frames, uint32_t maxDepth);
+		std::string describeAddress(void*);
+	}
+}
+
+using namespace et;
+
+uint32_t memory::registerTag(const char* name)
+{
+	std::lock_guard<std::mutex> lock(tagsLock);
+
+	if (registeredTags == 0)
+	{
+		strncpy(tagNames[DefaultTag], "untagged", MaxTagNameLength - 1);
+		registeredTags = 1;
+	}
+
+	uint32_t tagsCount = registeredTags;
+	for (uint32_t i = 0; i < tagsCount; ++i)
+	{
+		if (strncmp(tagNames[i], name, MaxTagNameLength - 1) == 0)
+			return i;
+	}
+
+	if (tagsCount >= MaxTagsCount)
+	{
+		log::warning("Unable to register memory tag %s, maximum number of tags reached", name);
+		return DefaultTag;
+	}
+
+	strncpy(tagNames[tagsCount], name, MaxTagNameLength - 1);
+	registeredTags = tagsCount + 1;
+
+	return tagsCount;
+}
+
+std::string memory::tagName(uint32_t tag)
+{
+	if (tag == DefaultTag)
+		return "untagged";
+
+	std::lock_guard<std::mutex> lock(tagsLock);
+	return (tag < registeredTags) ? std::string(tagNames[tag]) : emptyString;
+}
+
+uint32_t memory::currentTag()
+{
+	return currentThreadTag;
+}
+
+uint32_t memory::setCurrentTag(uint32_t tag)
+{
+	ET_ASSERT(tag < MaxTagsCount);
+
+	uint32_t previousTag = currentThreadTag;
+	currentThreadTag = tag;
+	return previousTag;
+}
+
+void memory::setAccountingEnabled(bool enabled)
+{
+	accountingDisabled = !enabled;
+}
+
+bool memory::accountingEnabled()
+{
+	return !accountingDisabled;
+}
+
+void memory::setCallStackSamplingInterval(uint32_t interval)
+{
+	if (interval > 0)
+	{
+		std::lock_guard<std::mutex> lock(samplesLock);
+		if (samples == nullptr)
+			samples = new CallStackSampleMap();
+	}
+
+	samplingInterval = interval;
+}
+
+uint32_t memory::callStackSamplingInterval()
+{
+	return samplingInterval;
+}
+
+uint32_t memory::tagForNewAllocation()
+{
+	return accountingDisabled.load(std::memory_order_relaxed) ? NotAccountedTag : currentThreadTag;
+}
+
+void memory::recordAllocation(uint32_t tag, size_t size, void* ptr)
+{
+	if (tag >= MaxTagsCount) return;
+
+	auto& counters = tagCounters[tag];
+
+	int64_t currentBytes = counters.currentBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) +
+		static_cast<int64_t>(size);
+
+	int64_t peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+	while ((currentBytes > peakBytes) &&
+		!counters.peakBytes.compare_exchange_weak(peakBytes, currentBytes, std::memory_order_relaxed)) { }
+
+	counters.liveAllocations.fetch_add(1, std::memory_order_relaxed);
+	counters.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	uint32_t interval = samplingInterval.load(std::memory_order_relaxed);
+	if ((interval > 0) && ((samplingCounter.fetch_add(1, std::memory_order_relaxed) % interval) == 0))
+	{
+		CallStackSample sample;
+		sample.pointer = ptr;
+		sample.size = size;
+		sample.tag = tag;
+		sample.depth = captureCallStack(sample.frames, MaxCallStackDepth);
+
+		std::lock_guard<std::mutex> lock(samplesLock);
+		(*samples)[ptr] = sample;
+		liveSamplesCount = static_cast<uint32_t>(samples->size());
+	}
+}
+
+void memory::recordDeallocation(uint32_t tag, size_t size, void* ptr)
+{
+	if (tag >= MaxTagsCount) return;
+
+	auto& counters = tagCounters[tag];
+	counters.currentBytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+	counters.liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+
+	if (liveSamplesCount.load(std::memory_order_relaxed) > 0)
+	{
+		std::lock_guard<std::mutex> lock(samplesLock);
+		samples->erase(ptr);
+		liveSamplesCount = static_cast<uint32_t>(samples->size());
+	}
+}
+
+std::vector<memory::TagStatistics> memory::tagStatistics()
+{
+	std::vector<TagStatistics> result;
+
+	std::lock_guard<std::mutex> lock(tagsLock);
+
+	uint32_t tagsCount = etMax(1u, registeredTags.load());
+	result.reserve(tagsCount);
+
+	for (uint32_t i = 0; i < tagsCount; ++i)
+	{
+		const auto& counters = tagCounters[i];
+
+		result.emplace_back();
+		auto& stats = result.back();
+		stats.name = (i == DefaultTag) ? std::string("untagged") : std::string(tagNames[i]);
+		stats.currentBytes = counters.currentBytes.load(std::memory_order_relaxed);
+		stats.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+		stats.liveAllocations = counters.liveAllocations.load(std::memory_order_relaxed);
+		stats.totalAllocations = counters.totalAllocations.load(std::memory_order_relaxed);
+	}
+
+	return result;
+}
+
+std::vector<memory::CallStackSample> memory::liveCallStackSamples()
+{
+	std::vector<CallStackSample> result;
+
+	std::lock_guard<std::mutex> lock(samplesLock);
+	if (samples != nullptr)
+	{
+		result.reserve(samples->size());
+		for (const auto& s : *samples)
+			result.push_back(s.second);
+	}
+
+	return result;
+}
+
+void memory::printTagStatistics()
+{
+	log::info("Memory tags:");
+	log::info("{");
+	for (const auto& stats : tagStatistics())
+	{
+		log::info("\t%-16s : %lld bytes (%lldKb), peak: %lld bytes (%lldKb), live allocations: %lld (total: %llu)",
+			stats.name.c_str(), stats.currentBytes, stats.currentBytes / 1024, stats.peakBytes,
+			stats.peakBytes / 1024, stats.liveAllocations, stats.totalAllocations);
+	}
+	log::info("}");
+}
+
+void memory::printCallStackSamples()
+{
+	auto liveSamples = liveCallStackSamples();
+
+	log::info("Live sampled allocations: %zu", liveSamples.size());
+	for (const auto& sample : liveSamples)
+	{
+		log::info("\t0x%016llx : %zu bytes, tag: %s", reinterpret_cast<uint64_t>(sample.pointer),
+			sample.size, tagName(sample.tag).c_str());
+
+		for (uint32_t i = 0; i < sample.depth; ++i)
+			log::info("\t\t%s", describeAddress(sample.frames[i]).c_str());
+	}
+}
+
+std::string memory::snapshotJson(size_t serializationFlags)
+{
+	/*
+	 * Snapshot itself should not be attributed to the current tag
+	 */
+	TagScope snapshotTag(DefaultTag);
+
+	ArrayValue tags;
+	for (const auto& stats : tagStatistics())
+	{
+		Dictionary tag;
+		tag.setStringForKey("name", stats.name);
+		tag.setIntegerForKey("current_bytes", stats.currentBytes);
+		tag.setIntegerForKey("peak_bytes", stats.peakBytes);
+		tag.setIntegerForKey("live_allocations", stats.liveAllocations);
+		tag.setIntegerForKey("total_allocations", static_cast<int64_t>(stats.totalAllocations));
+		tags->content.push_back(tag);
+	}
+
+	ArrayValue sampledAllocations;
+	for (const auto& sample : liveCallStackSamples())
+	{
+		ArrayValue callStack;
+		for (uint32_t i = 0; i < sample.depth; ++i)
+			callStack->content.push_back(StringValue(describeAddress(sample.frames[i])));
+
+		Dictionary allocation;
+		allocation.setIntegerForKey("address", static_cast<int64_t>(reinterpret_cast<uintptr_t>(sample.pointer)));
+		allocation.setIntegerForKey("size", static_cast<int64_t>(sample.size));
+		allocation.setStringForKey("tag", tagName(sample.tag));
+		allocation.setArrayForKey("call_stack", callStack);
+		sampledAllocations->content.push_back(allocation);
+	}
+
+	Dictionary snapshot;
+	snapshot.setIntegerForKey("process_memory_usage", static_cast<int64_t>(memoryUsage()));
+	snapshot.setBooleanForKey("accounting_enabled", accountingEnabled() ? 1 : 0);
+	snapshot.setIntegerForKey("sampling_interval", static_cast<int64_t>(callStackSamplingInterval()));
+	snapshot.setArrayForKey("tags", tags);
+	snapshot.setArrayForKey("sampled_allocations", sampledAllocations);
+
+	return json::serialize(snapshot, serializationFlags);
+}
+
+/*
+ * Platform-specific call stacks
+ */
+#if (ET_PLATFORM_ANDROID)
+
+namespace
+{
+	struct UnwindState
+	{
+		void** current = nullptr;
+		void** end = nullptr;
+	};
+
+	_Unwind_Reason_Code unwindCallback(struct _Unwind_Context* context, void* arg)
+	{
+		UnwindState* state = static_cast<UnwindState*>(arg);
+		uintptr_t pc = _Unwind_GetIP(context);
+		if (pc != 0)
+		{
+			if (state->current == state->end)
+				return _URC_END_OF_STACK;
+
+			*state->current++ = reinterpret_cast<void*>(pc);
+		}
+		return _URC_NO_REASON;
+	}
+}
+
+#endif
+
+uint32_t memory::captureCallStack(void** frames, uint32_t maxDepth)
+{
+#if (ET_PLATFORM_WIN)
+
+	return CaptureStackBackTrace(2, maxDepth, frames, nullptr);
+
+#elif (ET_PLATFORM_ANDROID)
+
+	UnwindState state;
+	state.current = frames;
+	state.end = frames + maxDepth;
+	_Unwind_Backtrace(unwindCallback, &state);
+	return static_cast<uint32_t>(state.current - frames);
+
+#else
+
+	return static_cast<uint32_t>(backtrace(frames, static_cast<int>(maxDepth)));
+
+#endif
+}
+
+std::string memory::describeAddress(void* address)
+{
+	char buffer[512] = { };
+
+#if (ET_PLATFORM_WIN)
+
+	sprintf(buffer, "0x%016llx", reinterpret_cast<uint64_t>(address));
+
+#else
+
+	Dl_info info = { };
+	if ((dladdr(address, &info) != 0) && (info.dli_sname != nullptr))
+	{
+		snprintf(buffer, sizeof(buffer), "0x%016llx %s + %lld", reinterpret_cast<uint64_t>(address), info.dli_sname,
+			static_cast<int64_t>(static_cast<char*>(address) - static_cast<char*>(info.dli_saddr)));
+	}
+	else
+	{
+		sprintf(buffer, "0x%016llx", reinterpret_cast<uint64_t>(address));
+	}
+
+#endif
+
+	return buffer;
+}
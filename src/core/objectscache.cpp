@@ -5,6 +5,7 @@
  *
  */
 
+#include <et/core/tools.h>
 #include <et/core/objectscache.h>
 
 using namespace et;
@@ -19,30 +20,88 @@ ObjectsCache::~ObjectsCache()
 	clear();
 }
 
+ObjectsCache::Shard& ObjectsCache::shardForKey(const std::string& key)
+{
+	return _shards[std::hash<std::string>()(key) % ShardsCount];
+}
+
+void ObjectsCache::Shard::link(ObjectProperty& p)
+{
+	p.lruPrevious = nullptr;
+	p.lruNext = lruHead;
+	
+	if (lruHead != nullptr)
+		lruHead->lruPrevious = &p;
+	
+	lruHead = &p;
+	
+	if (lruTail == nullptr)
+		lruTail = &p;
+}
+
+void ObjectsCache::Shard::unlink(ObjectProperty& p)
+{
+	if (p.lruPrevious != nullptr)
+		p.lruPrevious->lruNext = p.lruNext;
+	else
+		lruHead = p.lruNext;
+	
+	if (p.lruNext != nullptr)
+		p.lruNext->lruPrevious = p.lruPrevious;
+	else
+		lruTail = p.lruPrevious;
+	
+	p.lruPrevious = nullptr;
+	p.lruNext = nullptr;
+}
+
+void ObjectsCache::Shard::touch(ObjectProperty& p, uint64_t accessTime)
+{
+	p.lastAccess = accessTime;
+	
+	if (lruHead != &p)
+	{
+		unlink(p);
+		link(p);
+	}
+}
+
+/*
+ * Objects referenced outside of the cache are skipped, they stay in place
+ * until they are released or accessed again
+ */
+ObjectsCache::ObjectProperty* ObjectsCache::Shard::leastRecentlyUsedCandidate()
+{
+	for (ObjectProperty* p = lruTail; p != nullptr; p = p->lruPrevious)
+	{
+		if ((p->memoryUsage > 0) && (p->object->atomicCounterValue() == 1))
+			return p;
+	}
+	return nullptr;
+}
+
 void ObjectsCache::manage(const LoadableObject::Pointer& o, const ObjectLoader::Pointer& loader)
 {
 	if (o.valid() && o->canBeReloaded())
 	{
-		CriticalSectionScope lock(_lock);
-		
-		if (_objects.count(o->origin()) > 0)
-		{
-			ObjectPropertyList& list = _objects[o->origin()];
-			list.push_back(ObjectProperty(o, loader));
-			ObjectProperty& newObject = list.back();
-			newObject.identifiers[o->origin()] = getFileProperty(o->origin());
-			for (auto& s : o->distributedOrigins())
-				newObject.identifiers[s] = getFileProperty(s);
-		}
-		else
 		{
-			ObjectPropertyList newList(1, ObjectProperty(o, loader));
-			ObjectProperty& newObject = newList.back();
-			newObject.identifiers[o->origin()] = getFileProperty(o->origin());
-			for (auto& s : o->distributedOrigins())
-				newObject.identifiers[s] = getFileProperty(s);
-			_objects.insert(std::make_pair(o->origin(), newList));
+			Shard& shard = shardForKey(o->origin());
+			CriticalSectionScope lock(shard.lock);
+			
+			auto entry = shard.objects.emplace(o->origin(), ObjectPropertyList()).first;
+			entry->second.push_back(ObjectProperty(o, loader));
+			
+			ObjectProperty& newObject = entry->second.back();
+			newObject.key = &entry->first;
+			newObject.memoryUsage = o->estimatedMemoryUsage();
+			newObject.lastAccess = _accessCounter.fetch_add(1);
+			_memoryUsage += newObject.memoryUsage;
+			shard.link(newObject);
+			
+			watchObject(o->origin(), newObject);
 		}
+		
+		enforceMemoryBudget();
 	}
 	else
 	{
@@ -52,25 +111,33 @@ void ObjectsCache::manage(const LoadableObject::Pointer& o, const ObjectLoader::
 
 std::vector<LoadableObject::Pointer> ObjectsCache::findObjects(const std::string& key)
 {
-	CriticalSectionScope lock(_lock);
-	auto i = _objects.find(key);
-	if (i == _objects.end())
+	Shard& shard = shardForKey(key);
+	CriticalSectionScope lock(shard.lock);
+	
+	auto i = shard.objects.find(key);
+	if (i == shard.objects.end())
 		return std::vector<LoadableObject::Pointer>();
 		
 	std::vector<LoadableObject::Pointer> result;
+	result.reserve(i->second.size());
 	
-	for (auto prop : i->second)
+	uint64_t accessTime = _accessCounter.fetch_add(1);
+	for (auto& prop : i->second)
+	{
+		shard.touch(prop, accessTime);
 		result.push_back(prop.object);
+	}
 	
 	return result;
 }
 
 LoadableObject::Pointer ObjectsCache::findAnyObject(const std::string& key, uint64_t* property)
 {
-	CriticalSectionScope lock(_lock);
+	Shard& shard = shardForKey(key);
+	CriticalSectionScope lock(shard.lock);
 	
-	auto i = _objects.find(key);
-	if (i == _objects.end())
+	auto i = shard.objects.find(key);
+	if (i == shard.objects.end())
 	{
 		if (property)
 			*property = 0;
@@ -79,80 +146,193 @@ LoadableObject::Pointer ObjectsCache::findAnyObject(const std::string& key, uint
 	}
 	else
 	{
+		auto& prop = i->second.front();
+		shard.touch(prop, _accessCounter.fetch_add(1));
+		
 		if (property)
-			*property = i->second.front().identifiers[key];
+		{
+			auto identifier = prop.identifiers.find(key);
+			*property = (identifier == prop.identifiers.end()) ? 0 : identifier->second;
+		}
 		
-		return i->second.front().object;
+		return prop.object;
 	}
 }
 
-
 void ObjectsCache::discard(const LoadableObject::Pointer& o)
 {
 	if (o.valid())
 	{
-		CriticalSectionScope lock(_lock);
-		if (_objects.count(o->origin()) == 0) return;
+		Shard& shard = shardForKey(o->origin());
+		CriticalSectionScope lock(shard.lock);
+		
+		auto entry = shard.objects.find(o->origin());
+		if (entry == shard.objects.end()) return;
 		
-		ObjectPropertyList& list = _objects[o->origin()];
+		ObjectPropertyList& list = entry->second;
 		for (auto i = list.begin(), e = list.end(); i != e; ++i)
 		{
 			if (i->object == o)
 			{
+				forgetObject(shard, o->origin(), *i);
 				list.erase(i);
 				break;
 			}
 		}
 		
 		if (list.empty())
-			_objects.erase(o->origin());
+			shard.objects.erase(entry);
 	}
 }
 
 void ObjectsCache::clear()
 {
+	for (auto& shard : _shards)
+	{
+		CriticalSectionScope lock(shard.lock);
+		shard.objects.clear();
+		shard.lruHead = nullptr;
+		shard.lruTail = nullptr;
+	}
+	
 	CriticalSectionScope lock(_lock);
-	_objects.clear();
+	_dependencies.clear();
+	_watcher.unwatchAll();
+	_pendingReloads.clear();
+	_memoryUsage = 0;
 }
 
 void ObjectsCache::flush()
 {
-	CriticalSectionScope lock(_lock);
-	
 	size_t objectsErased = 0;
 	
-	for (auto& lv : _objects)
+	for (auto& shard : _shards)
 	{
-		auto obj = lv.second.begin();
-		while (obj != lv.second.end())
+		CriticalSectionScope lock(shard.lock);
+		
+		auto i = shard.objects.begin();
+		while (i != shard.objects.end())
 		{
-			if (obj->object->atomicCounterValue() == 1)
+			auto obj = i->second.begin();
+			while (obj != i->second.end())
+			{
+				if (obj->object->atomicCounterValue() == 1)
+				{
+					forgetObject(shard, i->first, *obj);
+					obj = i->second.erase(obj);
+					++objectsErased;
+				}
+				else
+				{
+					++obj;
+				}
+			}
+			
+			if (i->second.empty())
 			{
-				obj = lv.second.erase(obj);
-				++objectsErased;
+				i = shard.objects.erase(i);
 			}
 			else
 			{
-				++obj;
+				++i;
 			}
 		}
 	}
 	
-	auto i = _objects.begin();
-	while (i != _objects.end())
+	if (objectsErased > 0)
+		log::info("[ObjectsCache] %llu objects flushed.", static_cast<uint64_t>(objectsErased));
+}
+
+void ObjectsCache::setMemoryBudget(uint64_t budget)
+{
+	_memoryBudget = budget;
+	enforceMemoryBudget();
+}
+
+void ObjectsCache::updateMemoryUsage(const LoadableObject::Pointer& o)
+{
+	if (o.invalid()) return;
+	
 	{
-		if (i->second.empty())
+		Shard& shard = shardForKey(o->origin());
+		CriticalSectionScope lock(shard.lock);
+		
+		auto entry = shard.objects.find(o->origin());
+		if (entry == shard.objects.end()) return;
+		
+		for (auto& p : entry->second)
 		{
-			i = _objects.erase(i);
+			if (p.object == o)
+			{
+				uint64_t memoryUsage = o->estimatedMemoryUsage();
+				_memoryUsage += memoryUsage;
+				_memoryUsage -= p.memoryUsage;
+				p.memoryUsage = memoryUsage;
+			}
 		}
-		else
+	}
+	
+	enforceMemoryBudget();
+}
+
+/*
+ * Each shard keeps its own recently used list, so lookups only touch the shard they lock.
+ * Eviction takes the oldest unreferenced object among the tails of all shards.
+ */
+void ObjectsCache::enforceMemoryBudget()
+{
+	uint64_t budget = _memoryBudget.load();
+	if ((budget == 0) || (_memoryUsage.load() <= budget)) return;
+	
+	size_t objectsEvicted = 0;
+	uint64_t bytesEvicted = 0;
+	
+	while (_memoryUsage.load() > budget)
+	{
+		size_t oldestShard = ShardsCount;
+		uint64_t oldestAccess = std::numeric_limits<uint64_t>::max();
+		
+		for (size_t s = 0; s < ShardsCount; ++s)
 		{
-			++i;
+			CriticalSectionScope lock(_shards[s].lock);
+			ObjectProperty* candidate = _shards[s].leastRecentlyUsedCandidate();
+			if ((candidate != nullptr) && (candidate->lastAccess < oldestAccess))
+			{
+				oldestAccess = candidate->lastAccess;
+				oldestShard = s;
+			}
 		}
+		
+		if (oldestShard == ShardsCount) break;
+		
+		Shard& shard = _shards[oldestShard];
+		CriticalSectionScope lock(shard.lock);
+		
+		/*
+		 * Shard could be changed since candidates were compared, then just look again
+		 */
+		ObjectProperty* candidate = shard.leastRecentlyUsedCandidate();
+		if ((candidate == nullptr) || (candidate->lastAccess != oldestAccess)) continue;
+		
+		auto entry = shard.objects.find(*candidate->key);
+		auto i = std::find_if(entry->second.begin(), entry->second.end(),
+			[candidate](const ObjectProperty& p) { return &p == candidate; });
+		
+		bytesEvicted += i->memoryUsage;
+		++objectsEvicted;
+		
+		forgetObject(shard, entry->first, *i);
+		entry->second.erase(i);
+		
+		if (entry->second.empty())
+			shard.objects.erase(entry);
 	}
 	
-	if (objectsErased > 0)
-		log::info("[ObjectsCache] %llu objects flushed.", static_cast<uint64_t>(objectsErased));
+	if (objectsEvicted > 0)
+	{
+		log::info("[ObjectsCache] %llu objects (%llu bytes) evicted to fit memory budget.",
+			static_cast<uint64_t>(objectsEvicted), bytesEvicted);
+	}
 }
 
 void ObjectsCache::startMonitoring()
@@ -187,62 +367,242 @@ uint64_t ObjectsCache::getFileProperty(const std::string& p)
 }
 
 uint64_t ObjectsCache::getObjectProperty(LoadableObject::Pointer ptr)
+{
+	Shard& shard = shardForKey(ptr->origin());
+	CriticalSectionScope lock(shard.lock);
+	
+	auto entry = shard.objects.find(ptr->origin());
+	if (entry == shard.objects.end())
+		return 0;
+	
+	for (auto& p : entry->second)
+	{
+		if (p.object == ptr)
+			return p.identifiers[ptr->origin()];
+	}
+	
+	return 0;
+}
+
+void ObjectsCache::watchObject(const std::string& key, ObjectProperty& p)
 {
 	CriticalSectionScope lock(_lock);
 	
-	for (auto& entry : _objects)
+	auto addIdentifier = [this, &key, &p](const std::string& path)
 	{
-		for (auto& p : entry.second)
+		if (p.identifiers.count(path) > 0) return;
+		
+		p.identifiers[path] = getFileProperty(path);
+		if (!path.empty())
 		{
-			if (p.object == ptr)
-				return p.identifiers[ptr->origin()];
+			_watcher.watch(path);
+			_dependencies[path][key] += 1;
 		}
-	}
+	};
 	
-	return 0;
+	addIdentifier(p.object->origin());
+	for (const auto& s : p.object->distributedOrigins())
+		addIdentifier(s);
+}
+
+void ObjectsCache::unwatchObject(const std::string& key, const ObjectProperty& p)
+{
+	CriticalSectionScope lock(_lock);
+	
+	for (const auto& identifier : p.identifiers)
+	{
+		_watcher.unwatch(identifier.first);
+		
+		auto dependency = _dependencies.find(identifier.first);
+		if (dependency == _dependencies.end()) continue;
+		
+		auto dependent = dependency->second.find(key);
+		if ((dependent != dependency->second.end()) && (--dependent->second == 0))
+			dependency->second.erase(dependent);
+		
+		if (dependency->second.empty())
+			_dependencies.erase(dependency);
+	}
+}
+
+void ObjectsCache::forgetObject(Shard& shard, const std::string& key, ObjectProperty& p)
+{
+	shard.unlink(p);
+	unwatchObject(key, p);
+	_memoryUsage -= p.memoryUsage;
 }
 
 void ObjectsCache::performUpdate()
 {
-	ObjectsCache& cache = *this;
+	struct ReloadRequest
+	{
+		std::string key;
+		LoadableObject::Pointer object;
+		ObjectLoader::Pointer loader;
+	};
+	std::vector<ReloadRequest> requests;
+	
+	std::vector<std::pair<std::string, StringList>> changes;
+	{
+		CriticalSectionScope lock(_lock);
+		
+		StringList changedFiles;
+		_watcher.poll(changedFiles);
+		
+		for (const auto& path : changedFiles)
+		{
+			auto dependency = _dependencies.find(path);
+			if (dependency == _dependencies.end()) continue;
+			
+			changes.emplace_back(path, StringList());
+			for (const auto& dependent : dependency->second)
+				changes.back().second.push_back(dependent.first);
+		}
+	}
 	
-	for (auto& entry : _objects)
+	for (const auto& change : changes)
 	{
-		for (auto& p : entry.second)
+		const std::string& path = change.first;
+		uint64_t property = getFileProperty(path);
+		
+		for (const auto& key : change.second)
 		{
-			if (p.loader.valid() && p.object->canBeReloaded())
+			Shard& shard = shardForKey(key);
+			CriticalSectionScope lock(shard.lock);
+			
+			auto entry = shard.objects.find(key);
+			if (entry == shard.objects.end()) continue;
+			
+			for (auto& p : entry->second)
 			{
-				bool shouldReload = false;
+				auto identifier = p.identifiers.find(path);
+				if (identifier == p.identifiers.end()) continue;
 				
-				const auto& origin = p.object->origin();
-				uint64_t originProp = getFileProperty(origin);
-				if (p.identifiers[origin] != originProp)
-				{
-					p.identifiers[origin] = originProp;
-					shouldReload = true;
-				}
-				else
-				{
-					for (const auto& dOrigin : p.object->distributedOrigins())
-					{
-						auto prop = getFileProperty(dOrigin);
-						if (p.identifiers[dOrigin] != prop)
-						{
-							p.identifiers[dOrigin] = prop;
-							shouldReload = true;
-							break;
-						}
-					}
-				}
+				identifier->second = property;
+				
+				if (p.loader.invalid() || !p.object->canBeReloaded()) continue;
 				
-				if (shouldReload)
-					p.loader->reloadObject(p.object, cache);
+				auto existing = std::find_if(requests.begin(), requests.end(),
+					[&p](const ReloadRequest& r) { return r.object == p.object; });
+				
+				if (existing == requests.end())
+					requests.push_back({key, p.object, p.loader});
 			}
 		}
 	}
+	
+	for (auto& r : requests)
+		startReload(r.key, r.object, r.loader);
+}
+
+void ObjectsCache::startReload(const std::string& key, LoadableObject::Pointer object, ObjectLoader::Pointer loader)
+{
+	{
+		CriticalSectionScope lock(_lock);
+		
+		auto pending = _pendingReloads.find(object.ptr());
+		if (pending != _pendingReloads.end())
+		{
+			pending->second.changedAgain = true;
+			++_reloadStatistics.coalescedNotifications;
+			return;
+		}
+		
+		PendingReload& reload = _pendingReloads[object.ptr()];
+		reload.key = key;
+		reload.object = object;
+		reload.loader = loader;
+		reload.startTime = queryContiniousTimeInNanoSeconds();
+		++_reloadStatistics.reloadsStarted;
+	}
+	
+	if (loader->reloadObjectAsync(object, *this))
+	{
+		CriticalSectionScope lock(_lock);
+		++_reloadStatistics.asyncReloads;
+	}
+	else
+	{
+		loader->reloadObject(object, *this);
+		objectDidReload(object);
+	}
+}
+
+void ObjectsCache::objectDidReload(const LoadableObject::Pointer& object)
+{
+	PendingReload reload;
+	{
+		CriticalSectionScope lock(_lock);
+		
+		auto pending = _pendingReloads.find(object.ptr());
+		if (pending == _pendingReloads.end()) return;
+		
+		reload = pending->second;
+		_pendingReloads.erase(pending);
+		
+		uint64_t latency = (queryContiniousTimeInNanoSeconds() - reload.startTime) / 1000;
+		_reloadStatistics.lastLatency = latency;
+		_reloadStatistics.peakLatency = etMax(_reloadStatistics.peakLatency, latency);
+		_reloadStatistics.totalLatency += latency;
+		++_reloadStatistics.reloadsCompleted;
+	}
+	
+	refreshReloadedObject(reload.key, object);
+	enforceMemoryBudget();
+	
+	if (reload.changedAgain)
+		startReload(reload.key, object, reload.loader);
+}
+
+/*
+ * Reloaded objects could depend on other files and occupy different amount of memory now
+ */
+void ObjectsCache::refreshReloadedObject(const std::string& key, const LoadableObject::Pointer& object)
+{
+	Shard& shard = shardForKey(key);
+	CriticalSectionScope lock(shard.lock);
+	
+	auto entry = shard.objects.find(key);
+	if (entry == shard.objects.end()) return;
+	
+	for (auto& p : entry->second)
+	{
+		if (p.object == object)
+		{
+			watchObject(key, p);
+			
+			uint64_t memoryUsage = p.object->estimatedMemoryUsage();
+			_memoryUsage += memoryUsage;
+			_memoryUsage -= p.memoryUsage;
+			p.memoryUsage = memoryUsage;
+		}
+	}
+}
+
+ObjectsCache::ReloadStatistics ObjectsCache::reloadStatistics()
+{
+	CriticalSectionScope lock(_lock);
+	return _reloadStatistics;
 }
 
 void ObjectsCache::report()
 {
-	log::info("[ObjectsCache] Contains %llu objects", static_cast<uint64_t>(_objects.size()));
+	uint64_t objectsCount = 0;
+	for (auto& shard : _shards)
+	{
+		CriticalSectionScope lock(shard.lock);
+		objectsCount += shard.objects.size();
+	}
+	
+	CriticalSectionScope lock(_lock);
+	log::info("[ObjectsCache] Contains %llu objects (%llu bytes), watching %llu files (%s)", objectsCount,
+		_memoryUsage.load(), static_cast<uint64_t>(_watcher.watchedPathsCount()),
+		_watcher.usesNativeNotifications() ? "native" : "polling");
+	
+	if (_reloadStatistics.reloadsCompleted > 0)
+	{
+		log::info("[ObjectsCache] %llu reloads (%llu async, %llu coalesced), latency: %llu us average, %llu us peak",
+			_reloadStatistics.reloadsCompleted, _reloadStatistics.asyncReloads, _reloadStatistics.coalescedNotifications,
+			_reloadStatistics.totalLatency / _reloadStatistics.reloadsCompleted, _reloadStatistics.peakLatency);
+	}
 }
@@ -0,0 +1,278 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <mutex>
+#include <et/core/tools.h>
+#include <et/core/profiler.h>
+
+namespace et
+{
+	namespace profiler
+	{
+		struct Zone
+		{
+			const char* name = nullptr;
+			uint64_t beginTime = 0;
+			uint64_t endTime = 0;
+		};
+
+		/*
+		 * Written only by the owning thread, zones are published by incrementing count,
+		 * so they could be read from any thread while recording continues.
+		 */
+		struct ThreadZones
+		{
+			std::vector<Zone> zones;
+			std::atomic<size_t> count{0};
+			std::atomic<uint32_t> generation{0};
+			std::atomic<bool> abandoned{false};
+			std::string threadName;
+			uint32_t threadIndex = 0;
+
+			ThreadZones(uint32_t capacity, uint32_t index) :
+				zones(capacity), threadIndex(index) { }
+		};
+
+		struct ThreadZonesOwner
+		{
+			ThreadZones* zones = nullptr;
+
+			~ThreadZonesOwner()
+			{
+				if (zones != nullptr)
+					zones->abandoned.store(true, std::memory_order_release);
+			}
+		};
+
+		struct ProfilerState
+		{
+			std::mutex lock;
+			std::vector<ThreadZones*> threads;
+			std::atomic<uint32_t> generation{0};
+			std::atomic<uint32_t> zonesPerThread{DefaultZonesPerThread};
+			std::atomic<uint64_t> droppedZones{0};
+			uint32_t nextThreadIndex = 0;
+
+			~ProfilerState()
+			{
+				for (auto t : threads)
+					etDestroyObject(t);
+			}
+		};
+
+		std::atomic<bool> profilingEnabled{false};
+
+		static ProfilerState& state()
+		{
+			static ProfilerState profilerState;
+			return profilerState;
+		}
+
+		static thread_local ThreadZonesOwner currentThreadZonesOwner;
+
+		static ThreadZones* currentThreadZones()
+		{
+			auto& s = state();
+			ThreadZones* result = currentThreadZonesOwner.zones;
+			if (result == nullptr)
+			{
+				std::lock_guard<std::mutex> guard(s.lock);
+				result = etCreateObject<ThreadZones>(s.zonesPerThread.load(), s.nextThreadIndex++);
+				result->generation.store(s.generation.load());
+				s.threads.push_back(result);
+				currentThreadZonesOwner.zones = result;
+			}
+
+			/*
+			 * Zones are discarded by the owning thread, after clear() changed generation
+			 */
+			uint32_t generation = s.generation.load(std::memory_order_relaxed);
+			if (result->generation.load(std::memory_order_relaxed) != generation)
+			{
+				result->count.store(0, std::memory_order_relaxed);
+				result->generation.store(generation, std::memory_order_release);
+			}
+
+			return result;
+		}
+
+		static void appendEscaped(std::string& output, const char* value)
+		{
+			for (const char* c = value; *c != 0; ++c)
+			{
+				if ((*c == '"') || (*c == '\\'))
+					output.push_back('\\');
+
+				if (static_cast<unsigned char>(*c) >= 0x20)
+					output.push_back(*c);
+			}
+		}
+	}
+}
+
+using namespace et;
+using namespace et::profiler;
+
+void et::profiler::setEnabled(bool value)
+{
+	profilingEnabled.store(value, std::memory_order_relaxed);
+}
+
+bool et::profiler::enabled()
+{
+	return profilingEnabled.load(std::memory_order_relaxed);
+}
+
+void et::profiler::setZonesPerThread(uint32_t value)
+{
+	state().zonesPerThread.store(etMax(1u, value));
+}
+
+void et::profiler::setCurrentThreadName(const char* name)
+{
+	ThreadZones* zones = currentThreadZones();
+
+	std::lock_guard<std::mutex> guard(state().lock);
+	zones->threadName = name;
+}
+
+void et::profiler::clear()
+{
+	auto& s = state();
+
+	std::lock_guard<std::mutex> guard(s.lock);
+	s.generation.fetch_add(1);
+	s.droppedZones.store(0);
+
+	auto i = std::remove_if(s.threads.begin(), s.threads.end(), [](ThreadZones* zones)
+	{
+		if (!zones->abandoned.load(std::memory_order_acquire))
+			return false;
+
+		etDestroyObject(zones);
+		return true;
+	});
+	s.threads.erase(i, s.threads.end());
+}
+
+uint64_t et::profiler::recordedZonesCount()
+{
+	auto& s = state();
+	std::lock_guard<std::mutex> guard(s.lock);
+
+	uint64_t result = 0;
+	uint32_t generation = s.generation.load();
+	for (auto zones : s.threads)
+	{
+		if (zones->generation.load(std::memory_order_acquire) == generation)
+			result += zones->count.load(std::memory_order_acquire);
+	}
+	return result;
+}
+
+uint64_t et::profiler::droppedZonesCount()
+{
+	return state().droppedZones.load(std::memory_order_relaxed);
+}
+
+uint64_t et::profiler::beginZone()
+{
+	return etMax(uint64_t(1), queryContiniousTimeInNanoSeconds());
+}
+
+void et::profiler::endZone(const char* name, uint64_t beginTime)
+{
+	uint64_t endTime = queryContiniousTimeInNanoSeconds();
+
+	ThreadZones* zones = currentThreadZones();
+	size_t index = zones->count.load(std::memory_order_relaxed);
+	if (index >= zones->zones.size())
+	{
+		state().droppedZones.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	Zone& zone = zones->zones[index];
+	zone.name = name;
+	zone.beginTime = beginTime;
+	zone.endTime = endTime;
+	zones->count.store(index + 1, std::memory_order_release);
+}
+
+std::string et::profiler::chromeTrace()
+{
+	auto& s = state();
+	std::lock_guard<std::mutex> guard(s.lock);
+
+	uint32_t generation = s.generation.load();
+
+	uint64_t baseTime = std::numeric_limits<uint64_t>::max();
+	for (auto zones : s.threads)
+	{
+		if (zones->generation.load(std::memory_order_acquire) != generation) continue;
+
+		size_t count = zones->count.load(std::memory_order_acquire);
+		for (size_t i = 0; i < count; ++i)
+			baseTime = etMin(baseTime, zones->zones[i].beginTime);
+	}
+
+	std::string result;
+	result.reserve(4096);
+	result.append("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+	char buffer[128] = { };
+	bool first = true;
+	for (auto zones : s.threads)
+	{
+		if (zones->generation.load(std::memory_order_acquire) != generation) continue;
+
+		size_t count = zones->count.load(std::memory_order_acquire);
+		if ((count == 0) && zones->threadName.empty()) continue;
+
+		if (!zones->threadName.empty())
+		{
+			result.append(first ? "\n" : ",\n");
+			snprintf(buffer, sizeof(buffer), "{\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"",
+				zones->threadIndex);
+			result.append(buffer);
+			appendEscaped(result, zones->threadName.c_str());
+			result.append("\"}}");
+			first = false;
+		}
+
+		result.reserve(result.size() + count * 96);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const Zone& zone = zones->zones[i];
+			result.append(first ? "\n{\"name\":\"" : ",\n{\"name\":\"");
+			appendEscaped(result, zone.name);
+			snprintf(buffer, sizeof(buffer), "\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				zones->threadIndex, static_cast<double>(zone.beginTime - baseTime) / 1000.0,
+				static_cast<double>(zone.endTime - zone.beginTime) / 1000.0);
+			result.append(buffer);
+			first = false;
+		}
+	}
+
+	result.append("\n]}\n");
+	return result;
+}
+
+bool et::profiler::exportChromeTrace(const std::string& fileName)
+{
+	std::string trace = chromeTrace();
+
+	std::ofstream file(fileName, std::ios::out | std::ios::binary);
+	if (!file.good())
+	{
+		log::error("Unable to write profiler trace: %s", fileName.c_str());
+		return false;
+	}
+
+	file.write(trace.data(), static_cast<std::streamsize>(trace.size()));
+	return file.good();
+}
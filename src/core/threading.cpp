@@ -46,3 +46,8 @@ void et::threading::sleepMSec(uint64_t msec)
 {
 	std::this_thread::sleep_for(std::chrono::milliseconds(msec));
 }
+
+void et::threading::sleepUSec(uint64_t usec)
+{
+	std::this_thread::sleep_for(std::chrono::microseconds(usec));
+}
@@ -5,12 +5,20 @@
  *
  */
 
+#include <chrono>
 #include <et/core/datastorage.h>
 #include <et/core/tools.h>
 #include <et/core/cout.h>
 
 using namespace et;
 
+uint64_t et::queryContiniousTimeInNanoSeconds()
+{
+	static const auto startTime = std::chrono::steady_clock::now();
+	auto elapsed = std::chrono::steady_clock::now() - startTime;
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
 size_t et::streamSize(std::istream& s)
 {
 	std::streamoff currentPos = s.tellg();
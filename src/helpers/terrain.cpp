@@ -6,6 +6,7 @@
  */
 
 #include <et/core/tools.h>
+#include <et/core/mappedfile.h>
 #include <et/app/application.h>
 #include <et/helpers/terrain.h>
 #include <et/timers/intervaltimer.h>
@@ -480,8 +481,17 @@ void Terrain::loadFromStream(std::istream& stream, const vec2i& dimension, Terra
 
 void Terrain::loadFromRAWFile(const std::string& fileName, const vec2i& dimension, TerrainData::Format format)
 {
-	std::ifstream rawFile(application().resolveFileName(fileName), std::ios_base::binary);
-	
+	auto resolvedFileName = application().resolveFileName(fileName);
+
+	auto mappedFile = MappedFile::Pointer::create(resolvedFileName, MappedFile::Access::Sequential);
+	if (mappedFile->valid())
+	{
+		MappedFileStream stream(mappedFile);
+		loadFromStream(stream, dimension, format);
+		return;
+	}
+
+	std::ifstream rawFile(resolvedFileName, std::ios_base::binary);
 	if (rawFile.good())
 		loadFromStream(rawFile, dimension, format);
 }
@@ -5,6 +5,7 @@
  *
  */
 
+#include <et/core/mappedfile.h>
 #include <et/imaging/ddsloader.h>
 
 using namespace et;
@@ -428,6 +429,15 @@ void dds::loadFromStream(std::istream& source, TextureDescription& desc)
 
 void dds::loadFromFile(const std::string& path, TextureDescription& desc)
 {
+	auto mappedFile = MappedFile::Pointer::create(path, MappedFile::Access::Sequential);
+	if (mappedFile->valid())
+	{
+		MappedFileStream stream(mappedFile);
+		desc.setOrigin(path);
+		loadFromStream(stream, desc);
+		return;
+	}
+
 	InputStream file(path, StreamMode_Binary);
 	if (file.valid())
 	{
@@ -438,6 +448,15 @@ void dds::loadFromFile(const std::string& path, TextureDescription& desc)
 
 void dds::loadInfoFromFile(const std::string& path, TextureDescription& desc)
 {
+	auto mappedFile = MappedFile::Pointer::create(path, MappedFile::Access::Random);
+	if (mappedFile->valid())
+	{
+		MappedFileStream stream(mappedFile);
+		desc.setOrigin(path);
+		loadInfoFromStream(stream, desc);
+		return;
+	}
+
 	InputStream file(path, StreamMode_Binary);
 	if (file.valid())
 	{
@@ -5,6 +5,7 @@
  *
  */
 
+#include <et/core/mappedfile.h>
 #include <et/imaging/hdrloader.h>
 
 using namespace et;
@@ -145,6 +146,15 @@ void et::hdr::loadFromStream(std::istream& source, TextureDescription& desc)
 
 void et::hdr::loadFromFile(const std::string& path, TextureDescription& desc)
 {
+	auto mappedFile = MappedFile::Pointer::create(path, MappedFile::Access::Sequential);
+	if (mappedFile->valid())
+	{
+		MappedFileStream stream(mappedFile);
+		desc.setOrigin(path);
+		loadFromStream(stream, desc);
+		return;
+	}
+
 	InputStream file(path, StreamMode_Binary);
 	if (file.valid())
 	{
@@ -155,6 +165,15 @@ void et::hdr::loadFromFile(const std::string& path, TextureDescription& desc)
 
 void et::hdr::loadInfoFromFile(const std::string& path, TextureDescription& desc)
 {
+	auto mappedFile = MappedFile::Pointer::create(path, MappedFile::Access::Random);
+	if (mappedFile->valid())
+	{
+		MappedFileStream stream(mappedFile);
+		desc.setOrigin(path);
+		loadInfoFromStream(stream, desc);
+		return;
+	}
+
 	InputStream file(path, StreamMode_Binary);
 	if (file.valid())
 	{
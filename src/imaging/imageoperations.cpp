@@ -6,7 +6,8 @@
  */
 
 #include <et/geometry/geometry.h>
-#include <et/imaging/imageoperations.h>
+#include <et/tasks/jobsystem.h>
+#include <et/imaging/imagepipeline.h>
 
 using namespace et;
 
@@ -25,303 +26,487 @@ mat3i ImageOperations::matrixFilterSharpen = mat3i(
 	-1,  5, -1,
 	 0, -1,  0);
 
-int indexForCoord(const vec2i& coord, const vec2i& size);
-bool grayscaleSortFunction(const vec4ub& v1, const vec4ub& v2);
-
-inline int roundf(float v, int minV, int maxV)
-	{ return clamp(static_cast<int>(v), minV, maxV); }
-
 void ImageOperations::transfer(const BinaryDataStorage& src, const vec2i& srcSize, int srcComponents,
 	BinaryDataStorage& dst, const vec2i& dstSize, int dstComponents, const vec2i& position)
 {
-	int startX = clamp(position.x, 0, dstSize.x - 1);
-	int startY = clamp(position.y, 0, dstSize.y - 1);			
-	int endX = clamp(position.x + srcSize.x, 0, dstSize.x - 1);	
-	int endY = clamp(position.y + srcSize.y, 0, dstSize.y - 1);	
-	for (int y = startY, srcY = 0; y < endY; ++y, ++srcY)
-	{
-		for (int x = startX, srcX = 0; x < endX; ++x, ++srcX)
-		{
-			int dstIndex = dstComponents * (x + (dstSize.y - y - 1) * dstSize.x);
-			int srcIndex = srcComponents * (srcX + (srcSize.y - srcY - 1) * srcSize.x);
-			for (int k = 0; k < dstComponents; ++k)
-				dst[dstIndex + k] = (k < srcComponents) ? src[srcIndex + k] : 255;
-		}
-	}
+	ImagePipeline(dstSize, dstComponents).transfer(src, srcSize, srcComponents, position).execute(dst);
 }
 
 void ImageOperations::draw(const BinaryDataStorage& src, const vec2i& srcSize, int srcComponents,
 			BinaryDataStorage& dst, const vec2i& dstSize, int dstComponents, const recti& destRect,
-			ImageBlendType blend, ImageFilteringType)
+			ImageBlendType blend, ImageFilteringType filter)
+{
+	ImagePipeline(dstSize, dstComponents).draw(src, srcSize, srcComponents, destRect, blend, filter).execute(dst);
+}
+
+void ImageOperations::fill(BinaryDataStorage& dst, const vec2i& dstSize, int dstComponents, const recti& r, const vec4ub& color)
+{
+	ImagePipeline(dstSize, dstComponents).fill(r, color).execute(dst);
+}
+
+void ImageOperations::applyPixelFilter(BinaryDataStorage& data, const vec2i& size, int components, PixelFilter* filter, void* context)
 {
-	int startX = clamp(destRect.left, 0, dstSize.x);
-	int startY = clamp(destRect.top, 0, dstSize.y);
-	int endX = clamp(destRect.left + destRect.width, 0, dstSize.x);
-	int endY = clamp(destRect.top + destRect.height, 0, dstSize.y);
-
-	float fWidth = static_cast<float>(destRect.width);
-	float fHeight = static_cast<float>(destRect.height);
-	
-	for (int y = startY; y < endY; ++y)
+	ImagePipeline(size, components).pixelFilter(filter, context).execute(data);
+}
+
+namespace
+{
+	enum : int
+	{
+		MaxBlurPasses = 3,
+		BlurColumnsBlockSize = 16,
+		MaxBlurLanes = 4 * BlurColumnsBlockSize,
+	};
+
+	/*
+	 * Box covering [x - before, x + after]
+	 */
+	struct BlurPass
 	{
-		float fV = static_cast<float>(y - startY) / fHeight;
-		int v = roundf(fV * srcSize.y, 0, srcSize.y - 1);
-		int nextV = roundf(fV * srcSize.y + 1.0f, 0, srcSize.y - 1);
-		float dv = fV * srcSize.y - static_cast<float>(v);
+		int before = 0;
+		int after = 0;
+	};
 
-		for (int x = startX; x < endX; ++x)
+	int buildBlurPasses(int radius, ImageBlurType type, BlurPass* passes)
+	{
+		if (radius <= 0)
+			return 0;
+
+		if (type == ImageBlurType_Linear)
+		{
+			/*
+			 * Two boxes of (radius + 1) width, shifted in opposite directions, give symmetric triangle
+			 */
+			passes[0].before = radius / 2;
+			passes[0].after = radius - radius / 2;
+			passes[1].before = passes[0].after;
+			passes[1].after = passes[0].before;
+			return 2;
+		}
+
+		if (type == ImageBlurType_Gaussian)
 		{
-			float fU = static_cast<float>(x - startX) / fWidth;
-			int u = roundf(fU * srcSize.x, 0, srcSize.x - 1);
-			int nextU = roundf(fU * srcSize.x + 1.0f, 0, srcSize.x - 1);
-			float du = fU * srcSize.x - static_cast<float>(u);
-
-			int index0 = srcComponents * (u + (srcSize.y - v - 1) * srcSize.x);
-			int indexNextU = srcComponents * (nextU + (srcSize.y - v - 1) * srcSize.x);
-			int indexNextV = srcComponents * (u + (srcSize.y - nextV - 1) * srcSize.x);
-			int indexNextUV = srcComponents * (nextU + (srcSize.y - nextV - 1) * srcSize.x);
-
-			vec4ub color(0);
-			for (int c = 0; c < srcComponents; ++c)
+			/*
+			 * Widths of the boxes, which give closest standard deviation when applied in sequence
+			 */
+			float sigma = static_cast<float>(radius) / 3.0f;
+			float passesCount = static_cast<float>(MaxBlurPasses);
+			int lowerWidth = static_cast<int>(std::sqrt(12.0f * sigma * sigma / passesCount + 1.0f));
+			if (lowerWidth % 2 == 0)
+				--lowerWidth;
+
+			float fw = static_cast<float>(lowerWidth);
+			int lowerPasses = static_cast<int>(std::floor(0.5f + (12.0f * sigma * sigma - passesCount * fw * fw -
+				4.0f * passesCount * fw - 3.0f * passesCount) / (-4.0f * fw - 4.0f)));
+
+			for (int i = 0; i < MaxBlurPasses; ++i)
 			{
-				unsigned char topInterpolation = static_cast<unsigned char>(
-					static_cast<float>(src[index0 + c]) * (1.0f - du) +  static_cast<float>(src[indexNextU + c]) * du);
-				unsigned char bottomInterpolation = static_cast<unsigned char>(
-					static_cast<float>(src[indexNextV + c]) * (1.0f - du) +  static_cast<float>(src[indexNextUV + c]) * du);
-				color[c] =  static_cast<unsigned char>(
-					static_cast<float>(topInterpolation) * (1.0f - dv) +  static_cast<float>(bottomInterpolation) * dv);
+				passes[i].before = ((i < lowerPasses) ? lowerWidth : lowerWidth + 2) / 2;
+				passes[i].after = passes[i].before;
 			}
+			return MaxBlurPasses;
+		}
 
-			if (srcComponents < 4)
-				color.w = 255;
+		passes[0].before = radius;
+		passes[0].after = radius;
+		return 1;
+	}
 
-			int dstIndex = dstComponents * (x + (dstSize.y - 1 - y) * dstSize.x);
-			for (int c = 0; c < dstComponents; ++c)
-			{
-				if (blend == ImageBlendType_Additive)
-				{
-					dst[dstIndex + c] = static_cast<unsigned char>(clamp(dst[dstIndex + c] + color[c] * color.w / 255, 0, 255));
-				}
-				else if (blend == ImageBlendType_Default)
-				{
-					dst[dstIndex + c] = static_cast<unsigned char>((dst[dstIndex + c] * (255 - color.w) + color[c] * color.w) / 255);
-				}
-			}
+	inline float loadPixelValue(unsigned char value)
+		{ return static_cast<float>(value); }
 
-		}
-	}	
-}
+	inline float loadPixelValue(float value)
+		{ return value; }
 
-void ImageOperations::fill(BinaryDataStorage& dst, const vec2i& dstSize, int dstComponents, const recti& r, const vec4ub& color)
-{
-	int startX = clamp(r.left, 0, dstSize.x - 1);
-	int startY = clamp(r.top, 0, dstSize.y - 1);
-	int endY = clamp(r.bottom(), 0, dstSize.y - 1);
-	int endX = clamp(r.right(), 0, dstSize.x - 1);
+	inline void storePixelValue(float value, unsigned char& output)
+		{ output = static_cast<unsigned char>(clamp(value + 0.5f, 0.0f, 255.0f)); }
+
+	inline void storePixelValue(float value, float& output)
+		{ output = value; }
 
-	for (int y = startY; y < endY; ++y)
+	/*
+	 * Line of length elements with lanes floats in each (components of one pixel, or of several columns),
+	 * inner loops are over lanes, so they are vectorized by the compiler. Edges are clamped.
+	 */
+	void blurLine(const float* source, float* destination, int length, int lanes, const BlurPass& pass)
 	{
-		for (int x = startX; x < endX; ++x)
+		float scale = 1.0f / static_cast<float>(pass.before + pass.after + 1);
+		int last = length - 1;
+
+		float sum[MaxBlurLanes] = { };
+		for (int k = -pass.before; k <= pass.after; ++k)
 		{
-			int dstIndex = dstComponents * (x + (dstSize.y - 1 - y) * dstSize.x);
-			for (int k = 0; k < dstComponents; ++k)
-				dst[dstIndex + k] = color[k];
+			const float* value = source + lanes * clamp(k, 0, last);
+			for (int l = 0; l < lanes; ++l)
+				sum[l] += value[l];
+		}
+
+		for (int x = 0; x < length; ++x)
+		{
+			float* output = destination + lanes * x;
+			const float* added = source + lanes * etMin(x + pass.after + 1, last);
+			const float* removed = source + lanes * etMax(x - pass.before, 0);
+			for (int l = 0; l < lanes; ++l)
+			{
+				output[l] = sum[l] * scale;
+				sum[l] += added[l] - removed[l];
+			}
 		}
 	}
-}
 
-void ImageOperations::applyPixelFilter(BinaryDataStorage& data, const vec2i& size, int components, PixelFilter* filter, void* context)
-{
-	int k = 0;
-	for (int y = 0; y < size.y; ++y)
+	/*
+	 * Returns buffer with the result
+	 */
+	float* blurLine(float* line, float* temporary, int length, int lanes, const BlurPass* passes, int passesCount)
 	{
-		for (int x = 0; x < size.x; ++x)
+		for (int i = 0; i < passesCount; ++i)
 		{
-			vec4ub pixel(0);
-
-			for (int c = 0; c < components; ++c)
-				pixel[c] = data[k + c];
-
-			filter->applyRGBA(pixel, context);
+			blurLine(line, temporary, length, lanes, passes[i]);
+			std::swap(line, temporary);
+		}
+		return line;
+	}
 
-			for (int c = 0; c < components; ++c)
-				data[k + c] = pixel[c];
+	/*
+	 * Splits [0, count) into contiguous parts, one for each thread,
+	 * so every part could use its own slot of the scratch buffer
+	 */
+	size_t blurSlotsCount(int count)
+		{ return etMin(static_cast<size_t>(count), jobSystem().workersCount() + 1); }
 
-			k += components;
-		}
+	template <typename F>
+	void parallelForBlurSlots(int count, size_t slots, F func)
+	{
+		jobSystem().parallelFor(0, slots, 1, [&func, count, slots](size_t begin, size_t end)
+		{
+			for (size_t slot = begin; slot < end; ++slot)
+			{
+				func(slot, static_cast<int>(slot * static_cast<size_t>(count) / slots),
+					static_cast<int>((slot + 1) * static_cast<size_t>(count) / slots));
+			}
+		});
 	}
-}
 
-void ImageOperations::blur(BinaryDataStorage& data, const vec2i& size, int components, vec2i direction, int radius, ImageBlurType type)
-{
-	type = ImageBlurType_Average;
+	size_t blurSlotSize(const vec2i& size, int components)
+	{
+		size_t rowSize = static_cast<size_t>(size.x * components);
+		size_t columnsBlockSize = static_cast<size_t>(size.y * components * etMin(size.x, int(BlurColumnsBlockSize)));
+		return 2 * etMax(rowSize, columnsBlockSize);
+	}
 
-	BinaryDataStorage source(data);
-	for (int y = 0; y < size.y; ++y)
+	template <typename T>
+	void blurRows(T* data, const vec2i& size, int components, const BlurPass* passes, int passesCount,
+		FloatDataStorage& scratch)
 	{
-		for (int x = 0; x < size.x; ++x)
+		size_t slots = blurSlotsCount(size.y);
+		size_t slotSize = blurSlotSize(size, components);
+		int lineSize = size.x * components;
+
+		parallelForBlurSlots(size.y, slots, [&](size_t slot, int rowBegin, int rowEnd)
 		{
-			int i0 = components * indexForCoord(vec2i(x, y), size);
+			float* line = scratch.data() + slot * slotSize;
+			float* temporary = line + slotSize / 2;
+			for (int y = rowBegin; y < rowEnd; ++y)
+			{
+				T* row = data + y * lineSize;
+				for (int i = 0; i < lineSize; ++i)
+					line[i] = loadPixelValue(row[i]);
+
+				const float* result = blurLine(line, temporary, size.x, components, passes, passesCount);
+
+				for (int i = 0; i < lineSize; ++i)
+					storePixelValue(result[i], row[i]);
+			}
+		});
+	}
 
-			vec4i sum;
-			int scale = (type == ImageBlurType_Average) ? 1 : (radius + 1);
-			int totalScale = scale;
-			for (int c = 0; c < components; ++c)
-				sum[c] = source[i0 + c] * scale;
+	/*
+	 * Columns are processed in blocks, each row of the block is contiguous in memory
+	 */
+	template <typename T>
+	void blurColumns(T* data, const vec2i& size, int components, const BlurPass* passes, int passesCount,
+		FloatDataStorage& scratch)
+	{
+		int blocksCount = (size.x + BlurColumnsBlockSize - 1) / BlurColumnsBlockSize;
+		size_t slots = blurSlotsCount(blocksCount);
+		size_t slotSize = blurSlotSize(size, components);
+		int rowSize = size.x * components;
 
-			for (int r = 1; r <= radius; ++r)
+		parallelForBlurSlots(blocksCount, slots, [&](size_t slot, int blockBegin, int blockEnd)
+		{
+			float* line = scratch.data() + slot * slotSize;
+			float* temporary = line + slotSize / 2;
+			for (int block = blockBegin; block < blockEnd; ++block)
 			{
-				vec2i vNext = vec2i(x, y) + direction * r;
-				vec2i vPrev = vec2i(x, y) - direction * r;
-				int iNext = components * indexForCoord(vNext, size);
-				int iPrev = components * indexForCoord(vPrev, size);
-				scale = (type == ImageBlurType_Average) ? 1 : (radius + 1 - r);
-				totalScale += 2 * scale;
-				for (int c = 0; c < components; ++c)
+				int x0 = block * BlurColumnsBlockSize;
+				int lanes = etMin(int(BlurColumnsBlockSize), size.x - x0) * components;
+
+				for (int y = 0; y < size.y; ++y)
 				{
-					sum[c] += source[iNext + c] * scale;
-					sum[c] += source[iPrev + c] * scale;
+					const T* row = data + y * rowSize + x0 * components;
+					for (int l = 0; l < lanes; ++l)
+						line[y * lanes + l] = loadPixelValue(row[l]);
 				}
 
+				const float* result = blurLine(line, temporary, size.y, lanes, passes, passesCount);
+
+				for (int y = 0; y < size.y; ++y)
+				{
+					T* row = data + y * rowSize + x0 * components;
+					for (int l = 0; l < lanes; ++l)
+						storePixelValue(result[y * lanes + l], row[l]);
+				}
 			}
+		});
+	}
 
-			sum /= totalScale;
-			for (int c = 0; c < components; ++c)
-				data[i0 + c] = static_cast<unsigned char>(sum[c]);
-		}
+	template <typename T>
+	void blurImage(DataStorage<T>& data, const vec2i& size, int components, bool rows, bool columns,
+		int radius, ImageBlurType type, FloatDataStorage* scratch)
+	{
+		ET_ASSERT((components > 0) && (components <= 4));
+		ET_ASSERT(data.size() >= static_cast<size_t>(size.square() * components));
+
+		BlurPass passes[MaxBlurPasses];
+		int passesCount = buildBlurPasses(radius, type, passes);
+		if ((passesCount == 0) || (size.x <= 0) || (size.y <= 0))
+			return;
+
+		FloatDataStorage localScratch;
+		FloatDataStorage& buffers = (scratch == nullptr) ? localScratch : *scratch;
+
+		size_t requiredSize = blurSlotSize(size, components) *
+			blurSlotsCount(etMax(size.y, (size.x + BlurColumnsBlockSize - 1) / BlurColumnsBlockSize));
+		if (buffers.size() < requiredSize)
+			buffers.resize(requiredSize);
+
+		if (rows)
+			blurRows(data.data(), size, components, passes, passesCount, buffers);
+
+		if (columns)
+			blurColumns(data.data(), size, components, passes, passesCount, buffers);
 	}
 }
 
-void ImageOperations::median(BinaryDataStorage& data, const vec2i& size, int components, int radius)
+void ImageOperations::blur(BinaryDataStorage& data, const vec2i& size, int components, vec2i direction, int radius,
+	ImageBlurType type, FloatDataStorage* scratch)
 {
-	BinaryDataStorage source(data);
+	ET_ASSERT((direction.x == 0) != (direction.y == 0));
+	blurImage(data, size, components, direction.x != 0, direction.y != 0, radius, type, scratch);
+}
+
+void ImageOperations::blur(FloatDataStorage& data, const vec2i& size, int components, vec2i direction, int radius,
+	ImageBlurType type, FloatDataStorage* scratch)
+{
+	ET_ASSERT((direction.x == 0) != (direction.y == 0));
+	blurImage(data, size, components, direction.x != 0, direction.y != 0, radius, type, scratch);
+}
 
-	std::vector<vec4ub> matrix;
-	matrix.reserve(static_cast<std::vector<vec4ub>::size_type>((1 + 2 * radius) * (1 + 2 * radius)));
+void ImageOperations::blur(BinaryDataStorage& data, const vec2i& size, int components, int radius,
+	ImageBlurType type, FloatDataStorage* scratch)
+{
+	blurImage(data, size, components, true, true, radius, type, scratch);
+}
+
+void ImageOperations::blur(FloatDataStorage& data, const vec2i& size, int components, int radius,
+	ImageBlurType type, FloatDataStorage* scratch)
+{
+	blurImage(data, size, components, true, true, radius, type, scratch);
+}
 
-	for (int y = 0; y < size.y; ++y)
+namespace
+{
+	enum : int
 	{
-		for (int x = 0; x < size.x; ++x)
-		{
-			int i0 = components * indexForCoord(vec2i(x, y), size);
+		MedianFineBins = 256,
+		MedianCoarseBins = 16,
+		MedianCoarseShift = 4,
+		MedianTileWidth = 256,
+	};
+
+	/*
+	 * Sliding histograms (Perreault and Hebert): every column of the tile keeps histogram
+	 * of its (2r + 1) rows, which is moved down by one row for each output row,
+	 * kernel histogram is moved right by adding one column histogram and subtracting another.
+	 * Coarse histograms (16 bins) are used to find median without scanning all fine bins.
+	 */
+	template <typename Counter>
+	void medianTile(const unsigned char* source, unsigned char* destination, const vec2i& size,
+		int components, int radius, const recti& tile)
+	{
+		int columns = tile.width + 2 * radius;
+		int fineStride = components * MedianFineBins;
+		int coarseStride = components * MedianCoarseBins;
+
+		std::vector<Counter> columnsFine(static_cast<size_t>(columns * fineStride), 0);
+		std::vector<Counter> columnsCoarse(static_cast<size_t>(columns * coarseStride), 0);
+		std::vector<int> columnOffsets(static_cast<size_t>(columns), 0);
+		for (int i = 0; i < columns; ++i)
+			columnOffsets[i] = components * clamp(tile.left - radius + i, 0, size.x - 1);
 
-			matrix.clear();
-			for (int v = -radius; v <= radius; ++v)
+		auto updateColumns = [&](int row, Counter delta)
+		{
+			const unsigned char* rowData = source + components * size.x * clamp(row, 0, size.y - 1);
+			for (int i = 0; i < columns; ++i)
 			{
-				for (int u = - radius; u <= radius; ++u)
+				const unsigned char* pixel = rowData + columnOffsets[i];
+				Counter* fine = columnsFine.data() + i * fineStride;
+				Counter* coarse = columnsCoarse.data() + i * coarseStride;
+				for (int c = 0; c < components; ++c)
 				{
-					int index = components * indexForCoord(vec2i(x + u, y + v), size);
-					vec4ub color(0);
-					for (int c = 0; c < components; ++c)
-						color[c] = source[index+c];
-					matrix.push_back(color);
+					fine[c * MedianFineBins + pixel[c]] += delta;
+					coarse[c * MedianCoarseBins + (pixel[c] >> MedianCoarseShift)] += delta;
 				}
 			}
+		};
 
-			std::sort(matrix.begin(), matrix.end(), grayscaleSortFunction);
+		for (int row = tile.top - radius; row <= tile.top + radius; ++row)
+			updateColumns(row, Counter(1));
 
-			vec4ub& middle = matrix.at(matrix.size() / 2);
-			for (int c = 0; c < components; ++c)
-				data[i0 + c] = middle[c];
-		}
-	}
-}
+		/*
+		 * Coarse kernel histogram is updated for every pixel, segments of fine histogram
+		 * are updated lazily, only when median falls into them
+		 */
+		std::vector<Counter> kernelFine(static_cast<size_t>(fineStride), 0);
+		std::vector<Counter> kernelCoarse(static_cast<size_t>(coarseStride), 0);
+		std::vector<int> segmentColumns(static_cast<size_t>(coarseStride), 0);
 
-void ImageOperations::applyMatrixFilter(BinaryDataStorage& data, const vec2i& size, int components, const mat3i& m)
-{
-	BinaryDataStorage source(data);
-	matrix3<unsigned char> colorMatrix[4];
+		auto updateCoarse = [&](int column, bool add)
+		{
+			const Counter* coarse = columnsCoarse.data() + column * coarseStride;
+			if (add)
+			{
+				for (int i = 0; i < coarseStride; ++i)
+					kernelCoarse[i] += coarse[i];
+			}
+			else
+			{
+				for (int i = 0; i < coarseStride; ++i)
+					kernelCoarse[i] -= coarse[i];
+			}
+		};
 
-	for (int y = 0; y < size.y; ++y)
-	{
-		for (int x = 0; x < size.x; ++x)
+		auto updateSegment = [&](int segment, int column)
 		{
-			for (int dy = -1; dy <= 1; ++dy)
+			Counter* target = kernelFine.data() + segment * MedianCoarseBins;
+			int offset = segment * MedianCoarseBins;
+			int& segmentColumn = segmentColumns[segment];
+
+			if (column - segmentColumn > 2 * radius + 1)
 			{
-				for (int dx = -1; dx <= 1; ++dx)
+				std::fill(target, target + MedianCoarseBins, Counter(0));
+				for (int i = column; i <= column + 2 * radius; ++i)
 				{
-					int index = components * indexForCoord(vec2i(x + dx, y + dy), size);
-					for (int c = 0; c < components; ++c)
-						colorMatrix[c][dy+1][dx+1] = source[index+c];
+					const Counter* fine = columnsFine.data() + i * fineStride + offset;
+					for (int b = 0; b < MedianCoarseBins; ++b)
+						target[b] += fine[b];
 				}
 			}
-
-			vec4i result(0);
-			int cSum = 0;
-			for (int v = 0; v < 3; ++v)
+			else
 			{
-				for (int u = 0; u < 3; ++u)
+				for (int i = segmentColumn; i < column; ++i)
 				{
-					int value = m[v][u];
-					result.x += colorMatrix[0][v][u] * value;
-					result.y += colorMatrix[1][v][u] * value;
-					result.z += colorMatrix[2][v][u] * value;
-					result.w += colorMatrix[3][v][u] * value;
-					cSum += value;
+					const Counter* added = columnsFine.data() + (i + 2 * radius + 1) * fineStride + offset;
+					const Counter* removed = columnsFine.data() + i * fineStride + offset;
+					for (int b = 0; b < MedianCoarseBins; ++b)
+						target[b] += added[b] - removed[b];
 				}
 			}
+			segmentColumn = column;
+		};
+
+		uint32_t rank = static_cast<uint32_t>((2 * radius + 1) * (2 * radius + 1) / 2);
+		for (int y = tile.top; y < tile.bottom(); ++y)
+		{
+			if (y > tile.top)
+			{
+				updateColumns(y - radius - 1, Counter(-1));
+				updateColumns(y + radius, Counter(1));
+			}
+
+			std::fill(kernelCoarse.begin(), kernelCoarse.end(), Counter(0));
+			std::fill(segmentColumns.begin(), segmentColumns.end(), -(2 * radius + 2));
+			for (int i = 0; i <= 2 * radius; ++i)
+				updateCoarse(i, true);
+
+			unsigned char* output = destination + components * (y * size.x + tile.left);
+			for (int x = 0; x < tile.width; ++x)
+			{
+				for (int c = 0; c < components; ++c)
+				{
+					const Counter* coarse = kernelCoarse.data() + c * MedianCoarseBins;
+					uint32_t accumulated = 0;
+					int segment = 0;
+					while (accumulated + coarse[segment] <= rank)
+						accumulated += coarse[segment++];
 
-			if (cSum)
-				result /= cSum;
+					updateSegment(c * MedianCoarseBins + segment, x);
 
-			int i0 = components * indexForCoord(vec2i(x, y), size);
-			for (int c = 0; c < components; ++c)
-				data[i0 + c] = static_cast<unsigned char>(clamp(result[c], 0, 255));
+					const Counter* fine = kernelFine.data() + (c * MedianCoarseBins + segment) * MedianCoarseBins;
+					int bin = 0;
+					while (accumulated + fine[bin] <= rank)
+						accumulated += fine[bin++];
+
+					output[c] = static_cast<unsigned char>((segment << MedianCoarseShift) + bin);
+				}
+				output += components;
+
+				if (x + 1 < tile.width)
+				{
+					updateCoarse(x + 2 * radius + 1, true);
+					updateCoarse(x, false);
+				}
+			}
 		}
 	}
 }
 
-void ImageOperations::normalMapFilter(BinaryDataStorage& data, const vec2i& size, int components, const vec2& scale)
+void ImageOperations::median(BinaryDataStorage& data, const vec2i& size, int components, int radius)
 {
-	ET_ASSERT(components > 2);
+	ET_ASSERT((components > 0) && (components <= 4));
+	ET_ASSERT(data.size() >= static_cast<size_t>(size.square() * components));
 
-	vec2 fScale = scale / 255.0f;
-	BinaryDataStorage source(data);
-	for (int y = 0; y < size.y; ++y)
-	{
-		bool halfY = y < size.y / 2;
-		for (int x = 0; x < size.x; ++x)
-		{
-			bool halfX = x < size.x / 2;
-			vec2i nextX(x + (halfX ? 1 : -1), y);
-			vec2i nextY(x, y + (halfY ? 1 : -1));
+	if ((radius <= 0) || (size.x <= 0) || (size.y <= 0))
+		return;
 
-			int c00 = components * indexForCoord(vec2i(x, y), size);
-			int c01 = components * indexForCoord(nextX, size);
-			int c10 = components * indexForCoord(nextY, size);
-
-			short h00 = source[c00];
-			short h01 = source[c01];
-			short h10 = source[c10];
-
-			float dx = static_cast<float>(halfX ? h01 - h00 : h00 - h01) * fScale.x;
-			float dy = static_cast<float>(halfY ? h10 - h00 : h00 - h10) * fScale.y;
+	BinaryDataStorage source(data);
 
-			vec3 du(1.0f, 0.0f, dx);
-			vec3 dv(0.0f, 1.0f, dy);
+	/*
+	 * Tiles are limited in width to keep column histograms in cache,
+	 * strips should be high enough to amortize initialization of the column histograms
+	 */
+	int tilesPerRow = (size.x + MedianTileWidth - 1) / MedianTileWidth;
+	int tasksCount = static_cast<int>(4 * (jobSystem().workersCount() + 1));
+	int strips = clamp(tasksCount / tilesPerRow, 1, etMax(1, size.y / (4 * radius)));
 
-			vec3 produce = normalize(cross(du, dv));
+	std::vector<recti> tiles;
+	for (int s = 0; s < strips; ++s)
+	{
+		int top = s * size.y / strips;
+		int bottom = (s + 1) * size.y / strips;
+		for (int x = 0; x < size.x; x += MedianTileWidth)
+			tiles.emplace_back(x, top, etMin(int(MedianTileWidth), size.x - x), bottom - top);
+	}
 
-			data[c00+0] = static_cast<unsigned char>(255.0f * (0.5f + 0.5f * produce.x));
-			data[c00+1] = static_cast<unsigned char>(255.0f * (0.5f + 0.5f * produce.y));
-			data[c00+2] = static_cast<unsigned char>(255.0f * (0.5f + 0.5f * produce.z));
+	bool wideCounters = (2 * radius + 1) * (2 * radius + 1) > std::numeric_limits<uint16_t>::max();
+	jobSystem().parallelFor(0, tiles.size(), 1, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			if (wideCounters)
+				medianTile<uint32_t>(source.data(), data.data(), size, components, radius, tiles[i]);
+			else
+				medianTile<uint16_t>(source.data(), data.data(), size, components, radius, tiles[i]);
 		}
-	}
+	});
 }
 
-/*
- * Internal Stuff
- */
-int indexForCoord(const vec2i& coord, const vec2i& size)
+void ImageOperations::applyMatrixFilter(BinaryDataStorage& data, const vec2i& size, int components, const mat3i& m)
 {
-	int xVal = coord.x < 0 ? 0 : (coord.x >= size.x ? size.x - 1 : coord.x);
-	int yVal = coord.y < 0 ? 0 : (coord.y >= size.y ? size.y - 1 : coord.y);
-	return yVal * size.x + xVal;
+	ImagePipeline(size, components).matrixFilter(m).execute(data);
 }
 
-bool grayscaleSortFunction(const vec4ub& v1, const vec4ub& v2)
+void ImageOperations::normalMapFilter(BinaryDataStorage& data, const vec2i& size, int components, const vec2& scale)
 {
-	int g1 = 76 * v1.x + 150 * v1.y + 29 * v1.z;
-	int g2 = 76 * v2.x + 150 * v2.y + 29 * v2.z;
-	return g1 < g2;
+	ImagePipeline(size, components).normalMapFilter(scale).execute(data);
 }
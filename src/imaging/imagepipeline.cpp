@@ -0,0 +1,810 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/geometry/geometry.h>
+#include <et/core/profiler.h>
+#include <et/tasks/jobsystem.h>
+#include <et/imaging/imagepipeline.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#	define ET_IMAGE_PIPELINE_SSE	1
+#	include <emmintrin.h>
+#endif
+
+namespace et
+{
+	/*
+	 * Window of the image, pixels are addressed with image coordinates
+	 */
+	struct ImageTile
+	{
+		unsigned char* data = nullptr;
+		vec2i origin;
+		int rowSize = 0;
+		int components = 0;
+
+		ImageTile(unsigned char* d, const vec2i& o, int rs, int c) :
+			data(d), origin(o), rowSize(rs), components(c) { }
+
+		unsigned char* pixel(int x, int y) const
+			{ return data + (y - origin.y) * rowSize + (x - origin.x) * components; }
+	};
+
+	class ImagePipelineStage : public Shared
+	{
+	public:
+		ET_DECLARE_POINTER(ImagePipelineStage)
+
+	public:
+		virtual ~ImagePipelineStage() { }
+
+		/*
+		 * Stages with non-zero radius read neighbours of the pixel,
+		 * so they could not be processed in place
+		 */
+		virtual int radius() const
+			{ return 0; }
+
+		/*
+		 * Non-concurrent stages are processed once over the whole image from the calling thread
+		 */
+		virtual bool concurrent() const
+			{ return true; }
+
+		/*
+		 * Processes pixels within region (in image coordinates),
+		 * input and output are the same tile for stages with zero radius
+		 */
+		virtual void process(const ImageTile& input, const ImageTile& output, const recti& region) = 0;
+	};
+}
+
+using namespace et;
+
+namespace
+{
+	enum : int
+	{
+		PipelineTileWidth = 256,
+		PipelineTileHeight = 64,
+		KernelBlockSize = 16,
+		ConvolutionTaps = 9,
+	};
+
+	recti expandRect(const recti& r, int amount)
+		{ return recti(r.left - amount, r.top - amount, r.width + 2 * amount, r.height + 2 * amount); }
+
+	recti clipRect(const recti& r, const vec2i& size)
+	{
+		int left = etMax(r.left, 0);
+		int top = etMax(r.top, 0);
+		return recti(left, top, etMin(r.right(), size.x) - left, etMin(r.bottom(), size.y) - top);
+	}
+
+	inline int clampedCoord(float v, int minV, int maxV)
+		{ return clamp(static_cast<int>(v), minV, maxV); }
+
+	/*
+	 * Fills pixels outside of the image (but inside of the tile) with nearest pixels of the image
+	 */
+	void replicateBorders(const ImageTile& tile, const recti& full, const recti& valid)
+	{
+		int c = tile.components;
+		if ((valid.left > full.left) || (valid.right() < full.right()))
+		{
+			for (int y = valid.top; y < valid.bottom(); ++y)
+			{
+				const unsigned char* first = tile.pixel(valid.left, y);
+				for (int x = full.left; x < valid.left; ++x)
+					etCopyMemory(tile.pixel(x, y), first, c);
+
+				const unsigned char* last = tile.pixel(valid.right() - 1, y);
+				for (int x = valid.right(); x < full.right(); ++x)
+					etCopyMemory(tile.pixel(x, y), last, c);
+			}
+		}
+
+		for (int y = full.top; y < valid.top; ++y)
+			etCopyMemory(tile.pixel(full.left, y), tile.pixel(full.left, valid.top), full.width * c);
+
+		for (int y = valid.bottom(); y < full.bottom(); ++y)
+			etCopyMemory(tile.pixel(full.left, y), tile.pixel(full.left, valid.bottom() - 1), full.width * c);
+	}
+
+	/*
+	 * 3x3 convolution
+	 */
+	struct ConvolutionKernel
+	{
+		int weights[ConvolutionTaps] { };
+		int divisor = 0;
+
+		/*
+		 * Weights with positive sum, used by SIMD path, which computes floor(sum / divisor)
+		 * it is equal to the truncated division, since negative results are clamped to zero anyway
+		 */
+		int16_t vectorWeights[ConvolutionTaps + 1] { };
+		float vectorDivisor = 1.0f;
+		float vectorReciprocal = 1.0f;
+		bool vectorized = false;
+
+		ConvolutionKernel(const mat3i& m)
+		{
+			int absoluteSum = 0;
+			for (int v = 0; v < 3; ++v)
+			{
+				for (int u = 0; u < 3; ++u)
+				{
+					weights[3 * v + u] = m[v][u];
+					divisor += m[v][u];
+					absoluteSum += std::abs(m[v][u]);
+				}
+			}
+
+			/*
+			 * Sums and products should be exact in single precision
+			 */
+			vectorized = (absoluteSum <= std::numeric_limits<int16_t>::max());
+			if (vectorized)
+			{
+				int sign = (divisor < 0) ? -1 : 1;
+				for (int t = 0; t < ConvolutionTaps; ++t)
+					vectorWeights[t] = static_cast<int16_t>(sign * weights[t]);
+
+				vectorDivisor = (divisor == 0) ? 1.0f : static_cast<float>(sign * divisor);
+				vectorReciprocal = 1.0f / vectorDivisor;
+			}
+		}
+	};
+
+	inline unsigned char convolveValue(const unsigned char* const* taps, int i, const ConvolutionKernel& kernel)
+	{
+		int result = 0;
+		for (int t = 0; t < ConvolutionTaps; ++t)
+			result += taps[t][i] * kernel.weights[t];
+
+		if (kernel.divisor != 0)
+			result /= kernel.divisor;
+
+		return static_cast<unsigned char>(clamp(result, 0, 255));
+	}
+
+#if (ET_IMAGE_PIPELINE_SSE)
+
+	int convolveValuesSimd(const unsigned char* const* taps, unsigned char* output, int count, const ConvolutionKernel& kernel)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128 zeroFloat = _mm_setzero_ps();
+		__m128 one = _mm_set1_ps(1.0f);
+		__m128 lowerBound = _mm_set1_ps(-1.0f);
+		__m128 upperBound = _mm_set1_ps(256.0f);
+		__m128 divisor = _mm_set1_ps(kernel.vectorDivisor);
+		__m128 reciprocal = _mm_set1_ps(kernel.vectorReciprocal);
+
+		/*
+		 * Taps are processed in pairs, with multiply-add of interleaved values
+		 */
+		__m128i weights[5];
+		for (int p = 0; p < 5; ++p)
+		{
+			uint32_t first = static_cast<uint16_t>(kernel.vectorWeights[2 * p]);
+			uint32_t second = static_cast<uint16_t>(kernel.vectorWeights[2 * p + 1]);
+			weights[p] = _mm_set1_epi32(static_cast<int>(first | (second << 16)));
+		}
+
+		int i = 0;
+		for (; i + KernelBlockSize <= count; i += KernelBlockSize)
+		{
+			__m128i sum[4] = { zero, zero, zero, zero };
+			for (int p = 0; p < 5; ++p)
+			{
+				__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(taps[2 * p] + i));
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(taps[2 * p + 1] + i));
+				__m128i lo = _mm_unpacklo_epi8(a, b);
+				__m128i hi = _mm_unpackhi_epi8(a, b);
+				sum[0] = _mm_add_epi32(sum[0], _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), weights[p]));
+				sum[1] = _mm_add_epi32(sum[1], _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), weights[p]));
+				sum[2] = _mm_add_epi32(sum[2], _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), weights[p]));
+				sum[3] = _mm_add_epi32(sum[3], _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), weights[p]));
+			}
+
+			__m128i result[4];
+			for (int j = 0; j < 4; ++j)
+			{
+				__m128 value = _mm_cvtepi32_ps(sum[j]);
+				__m128 q = _mm_min_ps(_mm_max_ps(_mm_mul_ps(value, reciprocal), lowerBound), upperBound);
+				q = _mm_cvtepi32_ps(_mm_cvtps_epi32(q));
+				__m128 r = _mm_sub_ps(value, _mm_mul_ps(q, divisor));
+				q = _mm_add_ps(q, _mm_and_ps(_mm_cmpge_ps(r, divisor), one));
+				q = _mm_sub_ps(q, _mm_and_ps(_mm_cmplt_ps(r, zeroFloat), one));
+				result[j] = _mm_cvttps_epi32(q);
+			}
+
+			__m128i packed = _mm_packus_epi16(_mm_packs_epi32(result[0], result[1]), _mm_packs_epi32(result[2], result[3]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), packed);
+		}
+		return i;
+	}
+
+#else
+
+	int convolveValuesSimd(const unsigned char* const*, unsigned char*, int, const ConvolutionKernel&)
+		{ return 0; }
+
+#endif
+
+	/*
+	 * Taps should point to the first value of 3x3 neighbourhood, in rows order
+	 */
+	void convolveValues(const unsigned char* const* taps, unsigned char* output, int count, const ConvolutionKernel& kernel)
+	{
+		int i = kernel.vectorized ? convolveValuesSimd(taps, output, count, kernel) : 0;
+		for (; i < count; ++i)
+			output[i] = convolveValue(taps, i, kernel);
+	}
+
+	/*
+	 * Blending of the values with per-value alpha, x / 255 is computed as (x + 1 + (x >> 8)) >> 8
+	 */
+#if (ET_IMAGE_PIPELINE_SSE)
+
+	inline __m128i divideBy255(__m128i x, __m128i one)
+		{ return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, one), _mm_srli_epi16(x, 8)), 8); }
+
+	int blendValuesSimd(unsigned char* dst, const unsigned char* color, const unsigned char* alpha, int count, ImageBlendType blend)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i one = _mm_set1_epi16(1);
+		__m128i maxValue = _mm_set1_epi8(-1);
+
+		int i = 0;
+		for (; i + KernelBlockSize <= count; i += KernelBlockSize)
+		{
+			__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+			__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(color + i));
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(alpha + i));
+
+			__m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(a, zero));
+			__m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(a, zero));
+
+			__m128i result;
+			if (blend == ImageBlendType_Additive)
+			{
+				result = _mm_packus_epi16(divideBy255(lo, one), divideBy255(hi, one));
+				result = _mm_adds_epu8(d, result);
+			}
+			else
+			{
+				__m128i inverseAlpha = _mm_xor_si128(a, maxValue);
+				lo = _mm_add_epi16(lo, _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(inverseAlpha, zero)));
+				hi = _mm_add_epi16(hi, _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(inverseAlpha, zero)));
+				result = _mm_packus_epi16(divideBy255(lo, one), divideBy255(hi, one));
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), result);
+		}
+		return i;
+	}
+
+#else
+
+	int blendValuesSimd(unsigned char*, const unsigned char*, const unsigned char*, int, ImageBlendType)
+		{ return 0; }
+
+#endif
+
+	void blendValues(unsigned char* dst, const unsigned char* color, const unsigned char* alpha, int count, ImageBlendType blend)
+	{
+		int i = blendValuesSimd(dst, color, alpha, count, blend);
+		if (blend == ImageBlendType_Additive)
+		{
+			for (; i < count; ++i)
+				dst[i] = static_cast<unsigned char>(clamp(dst[i] + color[i] * alpha[i] / 255, 0, 255));
+		}
+		else
+		{
+			for (; i < count; ++i)
+				dst[i] = static_cast<unsigned char>((dst[i] * (255 - alpha[i]) + color[i] * alpha[i]) / 255);
+		}
+	}
+
+	void copyPixels(const unsigned char* src, int srcComponents, unsigned char* dst, int dstComponents, int count)
+	{
+		if (srcComponents == dstComponents)
+		{
+			etCopyMemory(dst, src, count * dstComponents);
+			return;
+		}
+
+		for (int x = 0; x < count; ++x, src += srcComponents, dst += dstComponents)
+		{
+			for (int k = 0; k < dstComponents; ++k)
+				dst[k] = (k < srcComponents) ? src[k] : 255;
+		}
+	}
+
+	/*
+	 * Stages, transfer, draw and fill use vertically flipped coordinates, as ImageOperations do
+	 */
+	class TransferStage : public ImagePipelineStage
+	{
+	public:
+		TransferStage(const BinaryDataStorage& src, const vec2i& srcSize, int srcComponents,
+			const vec2i& dstSize, const vec2i& position) : _src(src), _srcSize(srcSize),
+			_srcComponents(srcComponents), _dstHeight(dstSize.y)
+		{
+			_start.x = clamp(position.x, 0, dstSize.x - 1);
+			_start.y = clamp(position.y, 0, dstSize.y - 1);
+			_end.x = clamp(position.x + srcSize.x, 0, dstSize.x - 1);
+			_end.y = clamp(position.y + srcSize.y, 0, dstSize.y - 1);
+		}
+
+		void process(const ImageTile&, const ImageTile& output, const recti& region)
+		{
+			int xBegin = etMax(region.left, _start.x);
+			int xEnd = etMin(region.right(), _end.x);
+			if (xBegin >= xEnd) return;
+
+			int rowBegin = etMax(region.top, _dstHeight - _end.y);
+			int rowEnd = etMin(region.bottom(), _dstHeight - _start.y);
+			for (int row = rowBegin; row < rowEnd; ++row)
+			{
+				int srcY = _dstHeight - 1 - row - _start.y;
+				const unsigned char* src = _src.data() +
+					_srcComponents * ((xBegin - _start.x) + (_srcSize.y - srcY - 1) * _srcSize.x);
+				copyPixels(src, _srcComponents, output.pixel(xBegin, row), output.components, xEnd - xBegin);
+			}
+		}
+
+	private:
+		const BinaryDataStorage& _src;
+		vec2i _srcSize;
+		int _srcComponents = 0;
+		int _dstHeight = 0;
+		vec2i _start;
+		vec2i _end;
+	};
+
+	class FillStage : public ImagePipelineStage
+	{
+	public:
+		FillStage(const vec2i& dstSize, const recti& r, const vec4ub& color) :
+			_color(color), _dstHeight(dstSize.y)
+		{
+			_start.x = clamp(r.left, 0, dstSize.x - 1);
+			_start.y = clamp(r.top, 0, dstSize.y - 1);
+			_end.x = clamp(r.right(), 0, dstSize.x - 1);
+			_end.y = clamp(r.bottom(), 0, dstSize.y - 1);
+		}
+
+		void process(const ImageTile&, const ImageTile& output, const recti& region)
+		{
+			int xBegin = etMax(region.left, _start.x);
+			int xEnd = etMin(region.right(), _end.x);
+			if (xBegin >= xEnd) return;
+
+			int c = output.components;
+			int rowBegin = etMax(region.top, _dstHeight - _end.y);
+			int rowEnd = etMin(region.bottom(), _dstHeight - _start.y);
+			for (int row = rowBegin; row < rowEnd; ++row)
+			{
+				unsigned char* dst = output.pixel(xBegin, row);
+				for (int x = xBegin; x < xEnd; ++x, dst += c)
+				{
+					for (int k = 0; k < c; ++k)
+						dst[k] = _color[k];
+				}
+			}
+		}
+
+	private:
+		vec4ub _color;
+		int _dstHeight = 0;
+		vec2i _start;
+		vec2i _end;
+	};
+
+	class DrawStage : public ImagePipelineStage
+	{
+	public:
+		DrawStage(const BinaryDataStorage& src, const vec2i& srcSize, int srcComponents,
+			const vec2i& dstSize, const recti& destRect, ImageBlendType blend) : _src(src), _srcSize(srcSize),
+			_srcComponents(srcComponents), _dstHeight(dstSize.y), _blend(blend)
+		{
+			_start.x = clamp(destRect.left, 0, dstSize.x);
+			_start.y = clamp(destRect.top, 0, dstSize.y);
+			_end.x = clamp(destRect.left + destRect.width, 0, dstSize.x);
+			_end.y = clamp(destRect.top + destRect.height, 0, dstSize.y);
+			_height = static_cast<float>(destRect.height);
+
+			/*
+			 * Horizontal sampling positions are the same for every row
+			 */
+			float fWidth = static_cast<float>(destRect.width);
+			for (int x = _start.x; x < _end.x; ++x)
+			{
+				float fU = static_cast<float>(x - _start.x) / fWidth;
+				int u = clampedCoord(fU * srcSize.x, 0, srcSize.x - 1);
+				int nextU = clampedCoord(fU * srcSize.x + 1.0f, 0, srcSize.x - 1);
+				_columns.push_back(vec2i(u, nextU) * srcComponents);
+				_columnsWeight.push_back(fU * srcSize.x - static_cast<float>(u));
+			}
+		}
+
+		void process(const ImageTile&, const ImageTile& output, const recti& region)
+		{
+			int xBegin = etMax(region.left, _start.x);
+			int xEnd = etMin(region.right(), _end.x);
+			if (xBegin >= xEnd) return;
+
+			int c = output.components;
+			int count = xEnd - xBegin;
+			std::vector<unsigned char> colors(2 * count * c);
+			unsigned char* alphas = colors.data() + count * c;
+
+			int rowBegin = etMax(region.top, _dstHeight - _end.y);
+			int rowEnd = etMin(region.bottom(), _dstHeight - _start.y);
+			for (int row = rowBegin; row < rowEnd; ++row)
+			{
+				int y = _dstHeight - 1 - row;
+				float fV = static_cast<float>(y - _start.y) / _height;
+				int v = clampedCoord(fV * _srcSize.y, 0, _srcSize.y - 1);
+				int nextV = clampedCoord(fV * _srcSize.y + 1.0f, 0, _srcSize.y - 1);
+				float dv = fV * _srcSize.y - static_cast<float>(v);
+
+				const unsigned char* srcRow = _src.data() + _srcComponents * (_srcSize.y - v - 1) * _srcSize.x;
+				const unsigned char* nextSrcRow = _src.data() + _srcComponents * (_srcSize.y - nextV - 1) * _srcSize.x;
+
+				for (int i = 0; i < count; ++i)
+				{
+					const vec2i& u = _columns[xBegin - _start.x + i];
+					float du = _columnsWeight[xBegin - _start.x + i];
+
+					vec4ub color(0);
+					for (int k = 0; k < _srcComponents; ++k)
+					{
+						unsigned char topInterpolation = static_cast<unsigned char>(
+							static_cast<float>(srcRow[u.x + k]) * (1.0f - du) + static_cast<float>(srcRow[u.y + k]) * du);
+						unsigned char bottomInterpolation = static_cast<unsigned char>(
+							static_cast<float>(nextSrcRow[u.x + k]) * (1.0f - du) + static_cast<float>(nextSrcRow[u.y + k]) * du);
+						color[k] = static_cast<unsigned char>(
+							static_cast<float>(topInterpolation) * (1.0f - dv) + static_cast<float>(bottomInterpolation) * dv);
+					}
+
+					if (_srcComponents < 4)
+						color.w = 255;
+
+					for (int k = 0; k < c; ++k)
+					{
+						colors[i * c + k] = color[k];
+						alphas[i * c + k] = color.w;
+					}
+				}
+
+				blendValues(output.pixel(xBegin, row), colors.data(), alphas, count * c, _blend);
+			}
+		}
+
+	private:
+		const BinaryDataStorage& _src;
+		std::vector<vec2i> _columns;
+		std::vector<float> _columnsWeight;
+		vec2i _srcSize;
+		int _srcComponents = 0;
+		int _dstHeight = 0;
+		float _height = 0.0f;
+		ImageBlendType _blend = ImageBlendType_Default;
+		vec2i _start;
+		vec2i _end;
+	};
+
+	class PixelFilterStage : public ImagePipelineStage
+	{
+	public:
+		PixelFilterStage(PixelFilter* filter, void* context, bool concurrent) :
+			_filter(filter), _context(context), _concurrent(concurrent) { }
+
+		bool concurrent() const
+			{ return _concurrent; }
+
+		void process(const ImageTile&, const ImageTile& output, const recti& region)
+		{
+			static_assert(sizeof(vec4ub) == 4, "Pixels should be tightly packed");
+
+			int c = output.components;
+			if (c == 4)
+			{
+				for (int row = region.top; row < region.bottom(); ++row)
+					_filter->applyRGBARow(reinterpret_cast<vec4ub*>(output.pixel(region.left, row)), region.width, _context);
+				return;
+			}
+
+			std::vector<vec4ub> pixels(region.width);
+			for (int row = region.top; row < region.bottom(); ++row)
+			{
+				unsigned char* data = output.pixel(region.left, row);
+				for (int x = 0; x < region.width; ++x)
+				{
+					pixels[x] = vec4ub(0);
+					for (int k = 0; k < c; ++k)
+						pixels[x][k] = data[x * c + k];
+				}
+
+				_filter->applyRGBARow(pixels.data(), region.width, _context);
+
+				for (int x = 0; x < region.width; ++x)
+				{
+					for (int k = 0; k < c; ++k)
+						data[x * c + k] = pixels[x][k];
+				}
+			}
+		}
+
+	private:
+		PixelFilter* _filter = nullptr;
+		void* _context = nullptr;
+		bool _concurrent = false;
+	};
+
+	class MatrixFilterStage : public ImagePipelineStage
+	{
+	public:
+		MatrixFilterStage(const mat3i& m) :
+			_kernel(m) { }
+
+		int radius() const
+			{ return 1; }
+
+		void process(const ImageTile& input, const ImageTile& output, const recti& region)
+		{
+			int c = input.components;
+			const unsigned char* taps[ConvolutionTaps + 1] = { };
+			for (int row = region.top; row < region.bottom(); ++row)
+			{
+				for (int v = 0; v < 3; ++v)
+				{
+					const unsigned char* neighbours = input.pixel(region.left - 1, row + v - 1);
+					for (int u = 0; u < 3; ++u)
+						taps[3 * v + u] = neighbours + u * c;
+				}
+				taps[ConvolutionTaps] = taps[ConvolutionTaps - 1];
+
+				convolveValues(taps, output.pixel(region.left, row), region.width * c, _kernel);
+			}
+		}
+
+	private:
+		ConvolutionKernel _kernel;
+	};
+
+	class NormalMapStage : public ImagePipelineStage
+	{
+	public:
+		NormalMapStage(const vec2i& size, const vec2& scale) :
+			_scale(scale / 255.0f), _size(size) { }
+
+		int radius() const
+			{ return 1; }
+
+		void process(const ImageTile& input, const ImageTile& output, const recti& region)
+		{
+			int c = input.components;
+			for (int row = region.top; row < region.bottom(); ++row)
+			{
+				bool halfY = row < _size.y / 2;
+				int nextRow = row + (halfY ? 1 : -1);
+				for (int x = region.left; x < region.right(); ++x)
+				{
+					bool halfX = x < _size.x / 2;
+					const unsigned char* src = input.pixel(x, row);
+
+					short h00 = src[0];
+					short h01 = src[halfX ? c : -c];
+					short h10 = input.pixel(x, nextRow)[0];
+
+					float dx = static_cast<float>(halfX ? h01 - h00 : h00 - h01) * _scale.x;
+					float dy = static_cast<float>(halfY ? h10 - h00 : h00 - h10) * _scale.y;
+
+					vec3 du(1.0f, 0.0f, dx);
+					vec3 dv(0.0f, 1.0f, dy);
+					vec3 produce = normalize(cross(du, dv));
+
+					unsigned char* dst = output.pixel(x, row);
+					dst[0] = static_cast<unsigned char>(255.0f * (0.5f + 0.5f * produce.x));
+					dst[1] = static_cast<unsigned char>(255.0f * (0.5f + 0.5f * produce.y));
+					dst[2] = static_cast<unsigned char>(255.0f * (0.5f + 0.5f * produce.z));
+					for (int k = 3; k < c; ++k)
+						dst[k] = src[k];
+				}
+			}
+		}
+
+	private:
+		vec2 _scale;
+		vec2i _size;
+	};
+}
+
+ImagePipeline::ImagePipeline(const vec2i& size, int components) :
+	_size(size), _components(components)
+{
+	ET_ASSERT((components > 0) && (components <= 4));
+}
+
+ImagePipeline::~ImagePipeline()
+{
+}
+
+ImagePipeline& ImagePipeline::addStage(ImagePipelineStage* stage)
+{
+	_stages.emplace_back(stage);
+	return *this;
+}
+
+ImagePipeline& ImagePipeline::transfer(const BinaryDataStorage& src, const vec2i& srcSize, int srcComponents, const vec2i& position)
+{
+	return addStage(etCreateObject<TransferStage>(src, srcSize, srcComponents, _size, position));
+}
+
+ImagePipeline& ImagePipeline::draw(const BinaryDataStorage& src, const vec2i& srcSize, int srcComponents,
+	const recti& destRect, ImageBlendType blend, ImageFilteringType)
+{
+	if ((blend != ImageBlendType_Default) && (blend != ImageBlendType_Additive))
+		return *this;
+
+	return addStage(etCreateObject<DrawStage>(src, srcSize, srcComponents, _size, destRect, blend));
+}
+
+ImagePipeline& ImagePipeline::fill(const recti& r, const vec4ub& color)
+{
+	return addStage(etCreateObject<FillStage>(_size, r, color));
+}
+
+ImagePipeline& ImagePipeline::pixelFilter(PixelFilter* filter, void* context, bool concurrent)
+{
+	ET_ASSERT(filter != nullptr);
+	return addStage(etCreateObject<PixelFilterStage>(filter, context, concurrent));
+}
+
+ImagePipeline& ImagePipeline::matrixFilter(const mat3i& m)
+{
+	return addStage(etCreateObject<MatrixFilterStage>(m));
+}
+
+ImagePipeline& ImagePipeline::normalMapFilter(const vec2& scale)
+{
+	ET_ASSERT(_components > 2);
+	return addStage(etCreateObject<NormalMapStage>(_size, scale));
+}
+
+void ImagePipeline::clear()
+{
+	_stages.clear();
+}
+
+void ImagePipeline::execute(BinaryDataStorage& data)
+{
+	if (_stages.empty() || (_size.x <= 0) || (_size.y <= 0)) return;
+
+	ET_PROFILE_ZONE("image::pipeline");
+
+	int rowSize = _size.x * _components;
+	ET_ASSERT(data.size() >= static_cast<size_t>(rowSize * _size.y));
+
+	std::vector<recti> tiles;
+	for (int y = 0; y < _size.y; y += PipelineTileHeight)
+	{
+		for (int x = 0; x < _size.x; x += PipelineTileWidth)
+		{
+			tiles.emplace_back(x, y, etMin(static_cast<int>(PipelineTileWidth), _size.x - x),
+				etMin(static_cast<int>(PipelineTileHeight), _size.y - y));
+		}
+	}
+
+	/*
+	 * Sequences of concurrent stages are processed by tiles, others over the whole image
+	 */
+	size_t firstStage = 0;
+	while (firstStage < _stages.size())
+	{
+		if (_stages[firstStage]->concurrent())
+		{
+			size_t lastStage = firstStage;
+			while ((lastStage < _stages.size()) && _stages[lastStage]->concurrent())
+				++lastStage;
+
+			executeTiled(firstStage, lastStage, tiles, data);
+			firstStage = lastStage;
+		}
+		else
+		{
+			ImageTile image(data.data(), vec2i(0), rowSize, _components);
+			_stages[firstStage]->process(image, image, recti(0, 0, _size.x, _size.y));
+			++firstStage;
+		}
+	}
+}
+
+void ImagePipeline::executeTiled(size_t firstStage, size_t lastStage, const std::vector<recti>& tiles, BinaryDataStorage& data)
+{
+	int rowSize = _size.x * _components;
+
+	int halo = 0;
+	for (size_t i = firstStage; i < lastStage; ++i)
+		halo += _stages[i]->radius();
+
+	/*
+	 * Without neighbour reads tiles are processed in place
+	 */
+	if (halo == 0)
+	{
+		ImageTile image(data.data(), vec2i(0), rowSize, _components);
+		jobSystem().parallelFor(0, tiles.size(), [&](size_t begin, size_t end)
+		{
+			for (size_t t = begin; t < end; ++t)
+			{
+				for (size_t i = firstStage; i < lastStage; ++i)
+					_stages[i]->process(image, image, tiles[t]);
+			}
+		});
+		return;
+	}
+
+	/*
+	 * Otherwise every tile is loaded with halo, enough for all stages, and processed in two buffers
+	 */
+	BinaryDataStorage source(data);
+	jobSystem().parallelFor(0, tiles.size(), [&](size_t begin, size_t end)
+	{
+		size_t bufferSize = static_cast<size_t>((PipelineTileWidth + 2 * halo) * (PipelineTileHeight + 2 * halo) * _components);
+		BinaryDataStorage buffers[2] = { BinaryDataStorage(bufferSize), BinaryDataStorage(bufferSize) };
+
+		for (size_t t = begin; t < end; ++t)
+		{
+			const recti& tile = tiles[t];
+			recti bounds = expandRect(tile, halo);
+			ImageTile windows[2] =
+			{
+				ImageTile(buffers[0].data(), vec2i(bounds.left, bounds.top), bounds.width * _components, _components),
+				ImageTile(buffers[1].data(), vec2i(bounds.left, bounds.top), bounds.width * _components, _components)
+			};
+
+			recti loaded = clipRect(bounds, _size);
+			for (int y = loaded.top; y < loaded.bottom(); ++y)
+			{
+				etCopyMemory(windows[0].pixel(loaded.left, y), source.data() + y * rowSize + loaded.left * _components,
+					loaded.width * _components);
+			}
+
+			int current = 0;
+			int remainingHalo = halo;
+			for (size_t i = firstStage; i < lastStage; ++i)
+			{
+				auto& stage = _stages[i];
+				int radius = stage->radius();
+				if (radius == 0)
+				{
+					stage->process(windows[current], windows[current], clipRect(expandRect(tile, remainingHalo), _size));
+				}
+				else
+				{
+					recti required = expandRect(tile, remainingHalo);
+					replicateBorders(windows[current], required, clipRect(required, _size));
+
+					remainingHalo -= radius;
+					stage->process(windows[current], windows[1 - current], clipRect(expandRect(tile, remainingHalo), _size));
+					current = 1 - current;
+				}
+			}
+
+			for (int y = tile.top; y < tile.bottom(); ++y)
+			{
+				etCopyMemory(data.data() + y * rowSize + tile.left * _components, windows[current].pixel(tile.left, y),
+					tile.width * _components);
+			}
+		}
+	});
+}
@@ -5,6 +5,8 @@
  *
  */
 
+#include <et/core/memorytags.h>
+#include <et/core/profiler.h>
 #include <et/imaging/textureloader.h>
 #include <et/imaging/pngloader.h>
 #include <et/imaging/ddsloader.h>
@@ -18,6 +20,8 @@ using namespace et;
 
 TextureDescription::Pointer et::loadTextureDescription(const std::string& fileName, bool initWithZero)
 {
+	ET_MEMORY_TAG("textures");
+	
 	if (!fileExists(fileName))
 		return TextureDescription::Pointer();
 
@@ -84,6 +88,9 @@ TextureDescription::Pointer et::loadTextureDescription(const std::string& fileNa
 
 TextureDescription::Pointer et::loadTexture(const std::string& fileName)
 {
+	ET_MEMORY_TAG("textures");
+	ET_PROFILE_ZONE("textures::load");
+	
 	if (!fileExists(fileName))
 		return TextureDescription::Pointer();
 	
@@ -6,6 +6,8 @@
  */
 
 #include <external/jansson/jansson.h>
+#include <et/core/memorytags.h>
+#include <et/core/profiler.h>
 #include <et/json/json.h>
 
 using namespace et;
@@ -64,17 +66,14 @@ std::string et::json::serialize(const et::ArrayValue& arr, size_t inFlags)
 	return serialized;
 }
 
-et::ValueBase::Pointer et::json::deserialize(const char* input, size_t len, ValueClass& c, bool printErrors)
+et::ValueBase::Pointer et::json::deserializeWithJansson(const char* input, size_t len, ValueClass& c, bool printErrors)
 	{ return deserializeJson(input, len, c, printErrors); }
 
-et::ValueBase::Pointer et::json::deserialize(const char* input, ValueClass& c, bool printErrors)
-	{ return deserializeJson(input, strlen(input), c, printErrors); }
-
-et::ValueBase::Pointer  et::json::deserialize(const std::string& s, ValueClass& c, bool printErrors)
-	{ return deserializeJson(s.c_str(), s.length(), c, printErrors); }
-
 et::ValueBase::Pointer deserializeJson(const char* buffer, size_t len, ValueClass& c, bool printErrors)
 {
+	ET_MEMORY_TAG("json");
+	ET_PROFILE_ZONE("json::deserializeWithJansson");
+	
 	c = ValueClass_Invalid;
 	
 	if ((buffer == nullptr) || (len == 0))
@@ -186,9 +185,9 @@ Dictionary deserializeDictionary(json_t* root)
 		else if (json_is_null(value))
 			result.setDictionaryForKey(key, Dictionary());
 		else if (json_is_true(value))
-			result.setIntegerForKey(key, IntegerValue(1ll));
+			result.setIntegerForKey(key, IntegerValue(int64_t(1)));
 		else if (json_is_false(value))
-			result.setIntegerForKey(key, IntegerValue(0ll));
+			result.setIntegerForKey(key, IntegerValue(int64_t(0)));
 		else if (value != nullptr)
 		{
 			ET_FAIL_FMT("Unsupported JSON type: %d", value->type);
@@ -0,0 +1,684 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <deque>
+#include <et/core/memorytags.h>
+#include <et/core/profiler.h>
+#include <et/json/json.h>
+
+using namespace et;
+
+namespace
+{
+	enum : size_t
+	{
+		MaxNestingDepth = 512,
+		KeyTableInitialSize = 256,
+	};
+
+	/*
+	 * Keys repeat a lot in scene and material files, so strings for raw key bytes
+	 * are created once per document and copied into dictionaries from here
+	 */
+	class KeyTable
+	{
+	public:
+		KeyTable() :
+			_slots(KeyTableInitialSize) { }
+
+		const std::string& intern(const char* begin, size_t length)
+		{
+			uint64_t hash = 14695981039346656037ull;
+			for (size_t i = 0; i < length; ++i)
+				hash = (hash ^ static_cast<uint8_t>(begin[i])) * 1099511628211ull;
+
+			size_t mask = _slots.size() - 1;
+			for (size_t index = static_cast<size_t>(hash) & mask; ; index = (index + 1) & mask)
+			{
+				Slot& slot = _slots[index];
+				if (slot.key == nullptr)
+				{
+					_keys.emplace_back(begin, length);
+					slot.hash = hash;
+					slot.key = &_keys.back();
+
+					if (2 * _keys.size() > _slots.size())
+						grow();
+
+					return _keys.back();
+				}
+
+				if ((slot.hash == hash) && (slot.key->size() == length) &&
+					(memcmp(slot.key->data(), begin, length) == 0))
+				{
+					return *slot.key;
+				}
+			}
+		}
+
+	private:
+		struct Slot
+		{
+			uint64_t hash = 0;
+			const std::string* key = nullptr;
+		};
+
+		void grow()
+		{
+			std::vector<Slot> slots(2 * _slots.size());
+			size_t mask = slots.size() - 1;
+			for (const auto& slot : _slots)
+			{
+				if (slot.key == nullptr) continue;
+
+				size_t index = static_cast<size_t>(slot.hash) & mask;
+				while (slots[index].key != nullptr)
+					index = (index + 1) & mask;
+				slots[index] = slot;
+			}
+			_slots.swap(slots);
+		}
+
+	private:
+		std::deque<std::string> _keys;
+		std::vector<Slot> _slots;
+	};
+
+	/*
+	 * Single pass recursive descent parser, builds Dictionary / ArrayValue directly.
+	 * Follows the same conventions as jansson-based path:
+	 * booleans become integers, null becomes empty dictionary,
+	 * numbers with fraction or exponent become floats.
+	 */
+	class Parser
+	{
+	public:
+		Parser(const char* begin, size_t length) :
+			_begin(begin), _position(begin), _end(begin + length) { }
+
+		ValueBase::Pointer parse(ValueClass& c)
+		{
+			c = ValueClass_Invalid;
+
+			skipWhitespace();
+
+			ValueBase::Pointer result;
+			if (peek() == '{')
+			{
+				c = ValueClass_Dictionary;
+				result = parseDictionary(0);
+			}
+			else if (peek() == '[')
+			{
+				c = ValueClass_Array;
+				result = parseArray(0);
+			}
+			else
+			{
+				fail("'[' or '{' expected");
+			}
+
+			skipWhitespace();
+			if (!failed() && (_position != _end))
+				fail("end of file expected");
+
+			if (failed())
+				c = ValueClass_Invalid;
+
+			return result;
+		}
+
+		bool failed() const
+			{ return !_error.empty(); }
+
+		const std::string& error() const
+			{ return _error; }
+
+		size_t errorOffset() const
+			{ return _errorOffset; }
+
+	private:
+		char peek() const
+			{ return (_position < _end) ? *_position : 0; }
+
+		void skipWhitespace()
+		{
+			while ((_position < _end) && ((*_position == ' ') || (*_position == '\n') ||
+				(*_position == '\r') || (*_position == '\t')))
+			{
+				++_position;
+			}
+		}
+
+		void fail(const char* message)
+		{
+			if (failed()) return;
+
+			_error = message;
+			_errorOffset = static_cast<size_t>(_position - _begin);
+			_position = _end;
+		}
+
+		bool expect(char c, const char* message)
+		{
+			skipWhitespace();
+			if (peek() != c)
+			{
+				fail(message);
+				return false;
+			}
+			++_position;
+			return true;
+		}
+
+		bool matchLiteral(const char* literal, size_t length)
+		{
+			if ((static_cast<size_t>(_end - _position) < length) || (memcmp(_position, literal, length) != 0))
+			{
+				fail("invalid literal");
+				return false;
+			}
+			_position += length;
+			return true;
+		}
+
+		Dictionary parseDictionary(size_t depth)
+		{
+			Dictionary result;
+			if (depth > MaxNestingDepth)
+			{
+				fail("maximum nesting depth exceeded");
+				return result;
+			}
+
+			++_position;
+			skipWhitespace();
+			if (peek() == '}')
+			{
+				++_position;
+				return result;
+			}
+
+			auto& content = result->content;
+			while (!failed())
+			{
+				skipWhitespace();
+				if (peek() != '"')
+				{
+					fail("string or '}' expected");
+					break;
+				}
+
+				const std::string& key = parseKey();
+				if (!expect(':', "':' expected")) break;
+
+				content[key] = parseValue(depth);
+
+				skipWhitespace();
+				if (peek() == ',')
+				{
+					++_position;
+				}
+				else if (peek() == '}')
+				{
+					++_position;
+					break;
+				}
+				else
+				{
+					fail("',' or '}' expected");
+				}
+			}
+
+			return result;
+		}
+
+		ArrayValue parseArray(size_t depth)
+		{
+			ArrayValue result;
+			if (depth > MaxNestingDepth)
+			{
+				fail("maximum nesting depth exceeded");
+				return result;
+			}
+
+			++_position;
+			skipWhitespace();
+			if (peek() == ']')
+			{
+				++_position;
+				return result;
+			}
+
+			auto& content = result->content;
+			while (!failed())
+			{
+				content.push_back(parseValue(depth));
+
+				skipWhitespace();
+				if (peek() == ',')
+				{
+					++_position;
+				}
+				else if (peek() == ']')
+				{
+					++_position;
+					break;
+				}
+				else
+				{
+					fail("',' or ']' expected");
+				}
+			}
+
+			return result;
+		}
+
+		ValueBase::Pointer parseValue(size_t depth)
+		{
+			skipWhitespace();
+
+			switch (peek())
+			{
+				case '{':
+					return parseDictionary(depth + 1);
+
+				case '[':
+					return parseArray(depth + 1);
+
+				case '"':
+				{
+					StringValue result;
+					parseString(result->content);
+					return result;
+				}
+
+				case 't':
+				{
+					if (matchLiteral("true", 4))
+						return IntegerValue(static_cast<int64_t>(1));
+					return ValueBase::Pointer();
+				}
+
+				case 'f':
+				{
+					if (matchLiteral("false", 5))
+						return IntegerValue(static_cast<int64_t>(0));
+					return ValueBase::Pointer();
+				}
+
+				case 'n':
+				{
+					if (matchLiteral("null", 4))
+						return Dictionary();
+					return ValueBase::Pointer();
+				}
+
+				default:
+					return parseNumber();
+			}
+		}
+
+		const std::string& parseKey()
+		{
+			const char* begin = ++_position;
+			while ((_position < _end) && (*_position != '"') && (*_position != '\\'))
+				++_position;
+
+			if ((_position < _end) && (*_position == '"'))
+			{
+				++_position;
+				return _keys.intern(begin, static_cast<size_t>(_position - begin - 1));
+			}
+
+			/*
+			 * Keys with escape sequences are rare, decode them separately
+			 */
+			_position = begin - 1;
+			parseString(_escapedKey);
+			return _keys.intern(_escapedKey.data(), _escapedKey.size());
+		}
+
+		void parseString(std::string& output)
+		{
+			output.clear();
+
+			const char* begin = ++_position;
+			while ((_position < _end) && (*_position != '"') && (*_position != '\\') &&
+				(static_cast<uint8_t>(*_position) >= 0x20))
+			{
+				++_position;
+			}
+			output.assign(begin, _position);
+
+			while (_position < _end)
+			{
+				char c = *_position++;
+				if (c == '"')
+				{
+					return;
+				}
+				else if (c == '\\')
+				{
+					if (_position >= _end) break;
+
+					char escaped = *_position++;
+					switch (escaped)
+					{
+						case '"':
+						case '\\':
+						case '/':
+							output.push_back(escaped);
+							break;
+						case 'b':
+							output.push_back('\b');
+							break;
+						case 'f':
+							output.push_back('\f');
+							break;
+						case 'n':
+							output.push_back('\n');
+							break;
+						case 'r':
+							output.push_back('\r');
+							break;
+						case 't':
+							output.push_back('\t');
+							break;
+						case 'u':
+							parseUnicodeEscape(output);
+							break;
+						default:
+							fail("invalid escape sequence");
+							return;
+					}
+				}
+				else if (static_cast<uint8_t>(c) < 0x20)
+				{
+					--_position;
+					fail("control character in string");
+					return;
+				}
+				else
+				{
+					output.push_back(c);
+				}
+			}
+
+			fail("unterminated string");
+		}
+
+		bool parseHex4(uint32_t& value)
+		{
+			if (_end - _position < 4)
+			{
+				fail("invalid \\u escape");
+				return false;
+			}
+
+			value = 0;
+			for (size_t i = 0; i < 4; ++i)
+			{
+				char c = *_position++;
+				value <<= 4;
+				if ((c >= '0') && (c <= '9'))
+					value |= static_cast<uint32_t>(c - '0');
+				else if ((c >= 'a') && (c <= 'f'))
+					value |= static_cast<uint32_t>(c - 'a' + 10);
+				else if ((c >= 'A') && (c <= 'F'))
+					value |= static_cast<uint32_t>(c - 'A' + 10);
+				else
+				{
+					fail("invalid \\u escape");
+					return false;
+				}
+			}
+			return true;
+		}
+
+		void parseUnicodeEscape(std::string& output)
+		{
+			uint32_t codePoint = 0;
+			if (!parseHex4(codePoint)) return;
+
+			if ((codePoint >= 0xD800) && (codePoint <= 0xDBFF))
+			{
+				uint32_t lowSurrogate = 0;
+				if ((_end - _position < 2) || (_position[0] != '\\') || (_position[1] != 'u'))
+				{
+					fail("invalid surrogate pair");
+					return;
+				}
+				_position += 2;
+
+				if (!parseHex4(lowSurrogate)) return;
+				if ((lowSurrogate < 0xDC00) || (lowSurrogate > 0xDFFF))
+				{
+					fail("invalid surrogate pair");
+					return;
+				}
+				codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+			}
+			else if ((codePoint >= 0xDC00) && (codePoint <= 0xDFFF))
+			{
+				fail("invalid surrogate pair");
+				return;
+			}
+
+			if (codePoint < 0x80)
+			{
+				output.push_back(static_cast<char>(codePoint));
+			}
+			else if (codePoint < 0x800)
+			{
+				output.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+				output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+			}
+			else if (codePoint < 0x10000)
+			{
+				output.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+				output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+				output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+			}
+			else
+			{
+				output.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+				output.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+				output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+				output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+			}
+		}
+
+		/*
+		 * Up to 19 significant digits are accumulated in integer, then scaled by exact power of ten
+		 * (exact for mantissa below 2^53 and exponent within 22), other cases go to strtod
+		 */
+		ValueBase::Pointer parseNumber()
+		{
+			static const double exactPowersOfTen[] =
+			{
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+			};
+
+			const char* begin = _position;
+
+			bool negative = (peek() == '-');
+			if (negative)
+				++_position;
+
+			if ((_position >= _end) || (*_position < '0') || (*_position > '9'))
+			{
+				fail("invalid token");
+				return ValueBase::Pointer();
+			}
+
+			uint64_t mantissa = 0;
+			int32_t significantDigits = 0;
+			int32_t droppedDigits = 0;
+
+			if (*_position == '0')
+			{
+				++_position;
+			}
+			else
+			{
+				while ((_position < _end) && (*_position >= '0') && (*_position <= '9'))
+				{
+					if (significantDigits < 19)
+					{
+						mantissa = 10 * mantissa + static_cast<uint64_t>(*_position - '0');
+						++significantDigits;
+					}
+					else
+					{
+						++droppedDigits;
+					}
+					++_position;
+				}
+			}
+
+			bool isReal = false;
+			int32_t exponent = droppedDigits;
+
+			if ((_position < _end) && (*_position == '.'))
+			{
+				isReal = true;
+				++_position;
+
+				if ((_position >= _end) || (*_position < '0') || (*_position > '9'))
+				{
+					fail("invalid number");
+					return ValueBase::Pointer();
+				}
+
+				while ((_position < _end) && (*_position >= '0') && (*_position <= '9'))
+				{
+					if (significantDigits < 19)
+					{
+						if ((mantissa > 0) || (*_position != '0'))
+							++significantDigits;
+						mantissa = 10 * mantissa + static_cast<uint64_t>(*_position - '0');
+						--exponent;
+					}
+					++_position;
+				}
+			}
+
+			if ((_position < _end) && ((*_position == 'e') || (*_position == 'E')))
+			{
+				isReal = true;
+				++_position;
+
+				bool negativeExponent = false;
+				if ((_position < _end) && ((*_position == '-') || (*_position == '+')))
+					negativeExponent = (*_position++ == '-');
+
+				if ((_position >= _end) || (*_position < '0') || (*_position > '9'))
+				{
+					fail("invalid number");
+					return ValueBase::Pointer();
+				}
+
+				int32_t explicitExponent = 0;
+				while ((_position < _end) && (*_position >= '0') && (*_position <= '9'))
+				{
+					if (explicitExponent < 100000)
+						explicitExponent = 10 * explicitExponent + (*_position - '0');
+					++_position;
+				}
+				exponent += negativeExponent ? -explicitExponent : explicitExponent;
+			}
+
+			if (!isReal && (droppedDigits == 0))
+			{
+				if (!negative && (mantissa <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())))
+					return IntegerValue(static_cast<int64_t>(mantissa));
+
+				if (negative && (mantissa <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1))
+					return IntegerValue(static_cast<int64_t>(0 - mantissa));
+
+				fail("integer overflow");
+				return ValueBase::Pointer();
+			}
+			else if (!isReal)
+			{
+				fail("integer overflow");
+				return ValueBase::Pointer();
+			}
+
+			double value = 0.0;
+			if ((mantissa < (1ull << 53)) && (exponent >= -22) && (exponent <= 22))
+			{
+				value = static_cast<double>(mantissa);
+				value = (exponent < 0) ? value / exactPowersOfTen[-exponent] : value * exactPowersOfTen[exponent];
+				if (negative)
+					value = -value;
+			}
+			else
+			{
+				std::string number(begin, _position);
+				value = std::strtod(number.c_str(), nullptr);
+			}
+
+			return FloatValue(static_cast<float>(value));
+		}
+
+	private:
+		const char* _begin = nullptr;
+		const char* _position = nullptr;
+		const char* _end = nullptr;
+
+		KeyTable _keys;
+		std::string _escapedKey;
+
+		std::string _error;
+		size_t _errorOffset = 0;
+	};
+}
+
+ValueBase::Pointer et::json::deserialize(const char* buffer, size_t len, ValueClass& c, bool printErrors)
+{
+	ET_MEMORY_TAG("json");
+	ET_PROFILE_ZONE("json::deserialize");
+
+	c = ValueClass_Invalid;
+
+	if ((buffer == nullptr) || (len == 0))
+		return Dictionary();
+
+	Parser parser(buffer, len);
+	auto result = parser.parse(c);
+
+	if (parser.failed())
+	{
+		if (printErrors)
+		{
+			size_t line = 1 + static_cast<size_t>(std::count(buffer, buffer + parser.errorOffset(), '\n'));
+			const char* lineStart = buffer + parser.errorOffset();
+			while ((lineStart > buffer) && (lineStart[-1] != '\n'))
+				--lineStart;
+			size_t column = static_cast<size_t>(buffer + parser.errorOffset() - lineStart) + 1;
+
+			log::error("JSON parsing error (%llu,%llu): %s", static_cast<uint64_t>(line),
+				static_cast<uint64_t>(column), parser.error().c_str());
+		}
+		return Dictionary();
+	}
+
+	return result;
+}
+
+ValueBase::Pointer et::json::deserialize(const char* input, ValueClass& c, bool printErrors)
+{
+	return deserialize(input, strlen(input), c, printErrors);
+}
+
+ValueBase::Pointer et::json::deserialize(const std::string& s, ValueClass& c, bool printErrors)
+{
+	return deserialize(s.c_str(), s.length(), c, printErrors);
+}
@@ -152,13 +152,8 @@ uint64_t OBJLoaderThread::main()
  */
 
 OBJLoader::OBJLoader(const std::string& inFile, size_t options) :
-	inputFileName(application().resolveFileName(inFile).c_str()),
-	inputFile(inputFileName.c_str()), lastGroup(nullptr), _loadOptions(options)
+	inputFileName(inFile), inputFilePath(getFilePath(inFile)), lastGroup(nullptr), _loadOptions(options)
 {
-	inputFilePath = getFilePath(inputFileName);
-	
-	if (inputFile.fail())
-		log::info("Unable to open file %s", inputFileName.c_str());
 }
 
 OBJLoader::~OBJLoader()
@@ -178,10 +173,8 @@ OBJLoader::~OBJLoader()
 		materialFile.close();
 }
 
-void OBJLoader::loadData(bool async,  s3d::Storage& storage, ObjectsCache& cache)
+void OBJLoader::loadData()
 {
-	ET_ASSERT(!async && "Async loading is currently disabled");
-	
 	std::string line;
 	int lineNumber = 0;
 	char key = 0;
@@ -209,7 +202,7 @@ void OBJLoader::loadData(bool async,  s3d::Storage& storage, ObjectsCache& cache
 			{
 				std::string matName;
 				inputFile >> matName;
-				loadMaterials(matName, async, cache);
+				_materialLibraries.push_back(matName);
 			}
 			else
 			{
@@ -369,19 +362,165 @@ void OBJLoader::loadData(bool async,  s3d::Storage& storage, ObjectsCache& cache
 	}
 }
 
-s3d::ElementContainer::Pointer OBJLoader::load(et::RenderContext* rc, s3d::Storage& storage, ObjectsCache& cache)
+void OBJLoader::parse()
 {
-	storage.flush();
+	inputFile.open(inputFileName.c_str());
+	if (inputFile.fail())
+		log::info("Unable to open file %s", inputFileName.c_str());
 
-	_rc = rc;
 	_groups.reserve(4);
 	_vertices.reserve(1024);
 	_normals.reserve(1024);
 	_texCoords.reserve(1024);
 
-	loadData(false, storage, cache);
-	
+	loadData();
+
 	processLoadedData();
+}
+
+void OBJLoader::processLoadedData()
+{
+	size_t totalTriangles = 0;
+
+	for (const auto& group : _groups)
+	{
+		for (const auto& face : group->faces)
+			totalTriangles += face.vertices.size() - 2;
+	}
+	
+	size_t totalVertices = 3 * totalTriangles;
+	
+	bool hasNormals = _normals.size() > 0;
+	bool hasTexCoords = _texCoords.size() > 0;
+		
+	VertexDeclaration decl(true, VertexAttributeUsage::Position, VertexAttributeType::Vec3);
+	decl.push_back(VertexAttributeUsage::Normal, VertexAttributeType::Vec3);
+
+	if (hasTexCoords)
+	{
+		decl.push_back(VertexAttributeUsage::TexCoord0, VertexAttributeType::Vec2);
+
+		if ((_loadOptions & Option_CalculateTangents) == Option_CalculateTangents)
+			decl.push_back(VertexAttributeUsage::Tangent, VertexAttributeType::Vec3);
+	}
+
+	IndexArrayFormat fmt = (totalVertices > 65535) ? IndexArrayFormat::Format_32bit : IndexArrayFormat::Format_16bit;
+	
+	_indices = IndexArray::Pointer::create(fmt, totalVertices, PrimitiveType::Triangles);
+	_indices->linearize(totalVertices);
+	
+	_vertexData = VertexStorage::Pointer::create(decl, totalVertices);
+
+	auto pos = _vertexData->accessData<VertexAttributeType::Vec3>(VertexAttributeUsage::Position, 0);
+	
+	VertexDataAccessor<VertexAttributeType::Vec3> nrm;
+	if (_vertexData->hasAttributeWithType(VertexAttributeUsage::Normal, VertexAttributeType::Vec3))
+		nrm = _vertexData->accessData<VertexAttributeType::Vec3>(VertexAttributeUsage::Normal, 0);
+	
+	VertexDataAccessor<VertexAttributeType::Vec2> tex;
+	if (_vertexData->hasAttributeWithType(VertexAttributeUsage::TexCoord0, VertexAttributeType::Vec2))
+		tex = _vertexData->accessData<VertexAttributeType::Vec2>(VertexAttributeUsage::TexCoord0, 0);
+	
+	size_t index = 0;
+	
+	auto PUSH_VERTEX = [this, &pos, &nrm, &tex, &index, hasTexCoords, hasNormals](const OBJVertex& vertex, const vec3& offset)
+	{
+		{
+			ET_ASSERT(vertex[0] < _vertices.size());
+			pos[index] = _vertices[vertex[0]] - offset;
+		}
+		
+		if (hasTexCoords)
+		{
+			ET_ASSERT(vertex[1] < _texCoords.size());
+			tex[index] = _texCoords[vertex[1]];
+		}
+		
+		if (hasNormals)
+		{
+			ET_ASSERT(vertex[2] < _normals.size());
+			nrm[index] = _normals[vertex[2]];
+		}
+		
+		++index;
+	};
+	
+	for (auto group : _groups)
+	{
+		size_t startIndex = index;
+		
+		vec3 center(0.0f);
+		
+		if (_loadOptions & Option_CalculateTransforms)
+		{
+			size_t totalVertices = 0;
+			
+			for (auto face : group->faces)
+			{
+				size_t numTriangles = face.vertices.size() - 2;
+				for (size_t i = 1; i <= numTriangles; ++i)
+				{
+					center += _vertices[face.vertices[0][0]];
+					center += _vertices[face.vertices[i][0]];
+					center += _vertices[face.vertices[i+1][0]];
+					totalVertices += 3;
+				}
+			}
+			
+			if (totalVertices > 0.0f)
+				center /= static_cast<float>(totalVertices);
+		}
+		
+		for (auto face : group->faces)
+		{
+			size_t numTriangles = face.vertices.size() - 2;
+			for (size_t i = 1; i <= numTriangles; ++i)
+			{
+				PUSH_VERTEX(face.vertices[0], center);
+				PUSH_VERTEX(face.vertices[i], center);
+				PUSH_VERTEX(face.vertices[i+1], center);
+			}
+		}
+		
+		uint32_t startIndex_u32 = static_cast<uint32_t>(startIndex);
+		uint32_t numIndexes_u32 = static_cast<uint32_t>(index - startIndex);
+		_meshes.emplace_back(group->name, startIndex_u32, numIndexes_u32, group->material, center);
+	}
+	
+	if (!hasNormals)
+		primitives::calculateNormals(_vertexData, _indices, 0, _indices->primitivesCount());
+
+	if (hasTexCoords && ((_loadOptions & Option_CalculateTangents) == Option_CalculateTangents))
+		primitives::calculateTangents(_vertexData, _indices, 0, _indices->primitivesCount() & 0xffffffff);
+}
+
+/*
+ * Scene building requires renderer and application, which are not available on Linux host
+ */
+#if (ET_PLATFORM_LINUX)
+
+s3d::ElementContainer::Pointer OBJLoader::load(et::RenderContext*, s3d::Storage&, ObjectsCache&)
+{
+	ET_FAIL("Not supported on this platform, use parse() to read geometry");
+	return s3d::ElementContainer::Pointer();
+}
+
+#else
+
+s3d::ElementContainer::Pointer OBJLoader::load(et::RenderContext* rc, s3d::Storage& storage, ObjectsCache& cache)
+{
+	_rc = rc;
+
+	if (!fileExists(inputFileName))
+	{
+		inputFileName = application().resolveFileName(inputFileName);
+		inputFilePath = getFilePath(inputFileName);
+	}
+
+	parse();
+
+	for (const auto& library : _materialLibraries)
+		loadMaterials(library, false, cache);
 
 	s3d::ElementContainer::Pointer result = generateVertexBuffers(storage);
 	loaded.invoke(result);
@@ -698,10 +837,11 @@ void OBJLoader::loadMaterials(const std::string& fileName, bool async, ObjectsCa
 					std::string name;
 					materialFile >> name;
 					
-					_lastMaterial = Material::Pointer();
-					_lastMaterial->setName(name);
+					Material::Pointer material;
+					material->setName(name);
 					
-					_materials.push_back(_lastMaterial);
+					_materials.push_back(material);
+					_lastMaterial = material;
 				}
 				else
 				{
@@ -728,133 +868,6 @@ void OBJLoader::loadMaterials(const std::string& fileName, bool async, ObjectsCa
 	application().popSearchPaths();
 }
 
-void OBJLoader::processLoadedData()
-{
-	size_t totalTriangles = 0;
-
-	for (const auto& group : _groups)
-	{
-		for (const auto& face : group->faces)
-			totalTriangles += face.vertices.size() - 2;
-	}
-	
-	size_t totalVertices = 3 * totalTriangles;
-	
-	bool hasNormals = _normals.size() > 0;
-	bool hasTexCoords = _texCoords.size() > 0;
-		
-	VertexDeclaration decl(true, VertexAttributeUsage::Position, VertexAttributeType::Vec3);
-	decl.push_back(VertexAttributeUsage::Normal, VertexAttributeType::Vec3);
-
-	if (hasTexCoords)
-	{
-		decl.push_back(VertexAttributeUsage::TexCoord0, VertexAttributeType::Vec2);
-
-		if ((_loadOptions & Option_CalculateTangents) == Option_CalculateTangents)
-			decl.push_back(VertexAttributeUsage::Tangent, VertexAttributeType::Vec3);
-	}
-
-	IndexArrayFormat fmt = (totalVertices > 65535) ? IndexArrayFormat::Format_32bit : IndexArrayFormat::Format_16bit;
-	
-	_indices = IndexArray::Pointer::create(fmt, totalVertices, PrimitiveType::Triangles);
-	_indices->linearize(totalVertices);
-	
-	_vertexData = VertexStorage::Pointer::create(decl, totalVertices);
-
-	auto pos = _vertexData->accessData<VertexAttributeType::Vec3>(VertexAttributeUsage::Position, 0);
-	
-	VertexDataAccessor<VertexAttributeType::Vec3> nrm;
-	if (_vertexData->hasAttributeWithType(VertexAttributeUsage::Normal, VertexAttributeType::Vec3))
-		nrm = _vertexData->accessData<VertexAttributeType::Vec3>(VertexAttributeUsage::Normal, 0);
-	
-	VertexDataAccessor<VertexAttributeType::Vec2> tex;
-	if (_vertexData->hasAttributeWithType(VertexAttributeUsage::TexCoord0, VertexAttributeType::Vec2))
-		tex = _vertexData->accessData<VertexAttributeType::Vec2>(VertexAttributeUsage::TexCoord0, 0);
-	
-	size_t index = 0;
-	
-	auto PUSH_VERTEX = [this, &pos, &nrm, &tex, &index, hasTexCoords, hasNormals](const OBJVertex& vertex, const vec3& offset)
-	{
-		{
-			ET_ASSERT(vertex[0] < _vertices.size());
-			pos[index] = _vertices[vertex[0]] - offset;
-		}
-		
-		if (hasTexCoords)
-		{
-			ET_ASSERT(vertex[1] < _texCoords.size());
-			tex[index] = _texCoords[vertex[1]];
-		}
-		
-		if (hasNormals)
-		{
-			ET_ASSERT(vertex[2] < _normals.size());
-			nrm[index] = _normals[vertex[2]];
-		}
-		
-		++index;
-	};
-	
-	for (auto group : _groups)
-	{
-		size_t startIndex = index;
-		
-		vec3 center(0.0f);
-		
-		if (_loadOptions & Option_CalculateTransforms)
-		{
-			size_t totalVertices = 0;
-			
-			for (auto face : group->faces)
-			{
-				size_t numTriangles = face.vertices.size() - 2;
-				for (size_t i = 1; i <= numTriangles; ++i)
-				{
-					center += _vertices[face.vertices[0][0]];
-					center += _vertices[face.vertices[i][0]];
-					center += _vertices[face.vertices[i+1][0]];
-					totalVertices += 3;
-				}
-			}
-			
-			if (totalVertices > 0.0f)
-				center /= static_cast<float>(totalVertices);
-		}
-		
-		for (auto face : group->faces)
-		{
-			size_t numTriangles = face.vertices.size() - 2;
-			for (size_t i = 1; i <= numTriangles; ++i)
-			{
-				PUSH_VERTEX(face.vertices[0], center);
-				PUSH_VERTEX(face.vertices[i], center);
-				PUSH_VERTEX(face.vertices[i+1], center);
-			}
-		}
-		
-		Material::Pointer m;
-		
-		for (auto mat : _materials)
-		{
-			if (mat->name() == group->material)
-			{
-				m = mat;
-				break;
-			}
-		}
-		
-		uint32_t startIndex_u32 = static_cast<uint32_t>(startIndex);
-		uint32_t numIndexes_u32 = static_cast<uint32_t>(index - startIndex);
-		_meshes.emplace_back(group->name, startIndex_u32, numIndexes_u32, m, center);
-	}
-	
-	if (!hasNormals)
-		primitives::calculateNormals(_vertexData, _indices, 0, _indices->primitivesCount());
-
-	if (hasTexCoords && ((_loadOptions & Option_CalculateTangents) == Option_CalculateTangents))
-		primitives::calculateTangents(_vertexData, _indices, 0, _indices->primitivesCount() & 0xffffffff);
-}
-
 s3d::ElementContainer::Pointer OBJLoader::generateVertexBuffers(s3d::Storage& storage)
 {
 	s3d::ElementContainer::Pointer result = s3d::ElementContainer::Pointer::create(inputFileName, nullptr);
@@ -871,16 +884,26 @@ s3d::ElementContainer::Pointer OBJLoader::generateVertexBuffers(s3d::Storage& st
 
 	for (const auto& i : _meshes)
 	{
+		s3d::Material::Pointer material;
+		for (const auto& m : _materials)
+		{
+			if (m->name() == i.materialName)
+			{
+				material = m;
+				break;
+			}
+		}
+
 		s3d::BaseElement::Pointer object;
 		
 		if (_loadOptions & Option_SupportMeshes)
 		{
-			object = SupportMesh::Pointer::create(i.name, vao, i.material, i.start, i.count,
+			object = SupportMesh::Pointer::create(i.name, vao, material, i.start, i.count,
 				_vertexData, _indices, result.ptr());
 		}
 		else 
 		{
-			object = Mesh::Pointer::create(i.name, vao, i.material, i.start, i.count,
+			object = Mesh::Pointer::create(i.name, vao, material, i.start, i.count,
 				_vertexData, _indices, result.ptr());
 		}
 		
@@ -899,6 +922,8 @@ void OBJLoader::threadFinished() // s3d::Storage& storage)
 	*/
 }
 
+#endif // ET_PLATFORM_LINUX
+
 /*
  * Service
  */
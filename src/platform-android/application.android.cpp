@@ -253,8 +253,8 @@ void Application::loaded()
 {
 	log::info("Application::loaded()");
 
-	_lastQueuedTimeMSec = queryContiniousTimeInMilliSeconds();
-	_runLoop.update(_lastQueuedTimeMSec);
+	_lastQueuedTimeNSec = queryContiniousTimeInNanoSeconds();
+	_runLoop.updateNSec(_lastQueuedTimeNSec);
 	
 	RenderContextParameters parameters;
 	delegate()->setRenderContextParameters(parameters);
@@ -11,7 +11,14 @@
 
 #include <et/platform-android/nativeactivity.h>
 
-#define PASS_TO_OUTPUTS(FUNC)		for (Output::Pointer output : logOutputs) \
+#define PASS_TO_OUTPUTS(FUNC, LEVEL)	{ \
+										va_list args; \
+										va_start(args, format); \
+										bool queued = pushAsyncMessage(LEVEL, format, args); \
+										va_end(args); \
+										if (queued) return; \
+									} \
+									for (Output::Pointer output : sharedLogOutputs()) \
 									{ \
 										va_list args; \
 										va_start(args, format); \
@@ -22,23 +29,21 @@
 using namespace et;
 using namespace log;
 
-static std::vector<Output::Pointer> logOutputs;
-
 void et::log::addOutput(Output::Pointer ptr)
 {
-	logOutputs.push_back(ptr);
+	sharedLogOutputs().push_back(ptr);
 }
 
 void et::log::removeOutput(Output::Pointer ptr)
 {
-	logOutputs.erase(std::remove_if(logOutputs.begin(), logOutputs.end(),
-		[ptr](Output::Pointer out) { return out == ptr; }), logOutputs.end());
+	sharedLogOutputs().erase(std::remove_if(sharedLogOutputs().begin(), sharedLogOutputs().end(),
+		[ptr](Output::Pointer out) { return out == ptr; }), sharedLogOutputs().end());
 }
 
-void et::log::debug(const char* format, ...) { PASS_TO_OUTPUTS(debug) }
-void et::log::info(const char* format, ...) { PASS_TO_OUTPUTS(info) }
-void et::log::warning(const char* format, ...) { PASS_TO_OUTPUTS(warning) }
-void et::log::error(const char* format, ...) { PASS_TO_OUTPUTS(error) }
+void et::log::debug(const char* format, ...) { PASS_TO_OUTPUTS(debug, Level::Debug) }
+void et::log::info(const char* format, ...) { PASS_TO_OUTPUTS(info, Level::Info) }
+void et::log::warning(const char* format, ...) { PASS_TO_OUTPUTS(warning, Level::Warning) }
+void et::log::error(const char* format, ...) { PASS_TO_OUTPUTS(error, Level::Error) }
 
 ConsoleOutput::ConsoleOutput() :
 	FileOutput(stdout)
@@ -107,6 +112,16 @@ void FileOutput::info(const char* format, va_list args)
 {
 	vfprintf(_file, format, args);
 	fprintf(_file, "\n");
+
+	/*
+	 * Asynchronous writer flushes once per batch
+	 */
+	if (!asyncOutputEnabled())
+		fflush(_file);
+}
+
+void FileOutput::flush()
+{
 	fflush(_file);
 }
 
@@ -11,7 +11,14 @@
 #include <et/core/et.h>
 #include <et/platform-apple/apple.h>
 
-#define PASS_TO_OUTPUTS(FUNC)		for (Output::Pointer output : sharedLogOutputs()) \
+#define PASS_TO_OUTPUTS(FUNC, LEVEL)	{ \
+										va_list args; \
+										va_start(args, format); \
+										bool queued = pushAsyncMessage(LEVEL, format, args); \
+										va_end(args); \
+										if (queued) return; \
+									} \
+									for (Output::Pointer output : sharedLogOutputs()) \
 									{ \
 										va_list args; \
 										va_start(args, format); \
@@ -33,10 +40,10 @@ void et::log::removeOutput(Output::Pointer ptr)
 		[ptr](Output::Pointer out) { return out == ptr; }), sharedLogOutputs().end());
 }
 
-void et::log::debug(const char* format, ...) { PASS_TO_OUTPUTS(debug) }
-void et::log::info(const char* format, ...) { PASS_TO_OUTPUTS(info) }
-void et::log::warning(const char* format, ...) { PASS_TO_OUTPUTS(warning) }
-void et::log::error(const char* format, ...) { PASS_TO_OUTPUTS(error) }
+void et::log::debug(const char* format, ...) { PASS_TO_OUTPUTS(debug, Level::Debug) }
+void et::log::info(const char* format, ...) { PASS_TO_OUTPUTS(info, Level::Info) }
+void et::log::warning(const char* format, ...) { PASS_TO_OUTPUTS(warning, Level::Warning) }
+void et::log::error(const char* format, ...) { PASS_TO_OUTPUTS(error, Level::Error) }
 
 ConsoleOutput::ConsoleOutput() :
 	FileOutput(stdout)
@@ -128,6 +135,16 @@ void FileOutput::info(const char* format, va_list args)
 {
 	vfprintf(_file, format, args);
 	fprintf(_file, "\n");
+
+	/*
+	 * Asynchronous writer flushes once per batch
+	 */
+	if (!asyncOutputEnabled())
+		fflush(_file);
+}
+
+void FileOutput::flush()
+{
 	fflush(_file);
 }
 
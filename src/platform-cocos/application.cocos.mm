@@ -69,7 +69,7 @@ void Application::loaded()
 	
 	_renderContext = sharedObjectFactory().createObject<RenderContext>(renderContextParams, this);
 	_renderingContextHandle = _renderContext->renderingContextHandle();
-	_runLoop.updateTime(_lastQueuedTimeMSec);
+	_runLoop.updateTimeNSec(_lastQueuedTimeNSec);
 	
     enterRunLoop();
 }
@@ -0,0 +1,49 @@
+/*
+* This file is part of `et engine`
+* Copyright 2009-2015 by Sergey Reznik
+* Please, modify content only if you know what are you doing.
+*
+*/
+
+#include <et/core/et.h>
+#include <et/core/memory.h>
+
+#if (ET_PLATFORM_LINUX)
+
+#include <unistd.h>
+#include <sys/mman.h>
+
+using namespace et;
+
+size_t et::memoryUsage()
+{
+	size_t totalPages = 0;
+	size_t residentPages = 0;
+
+	FILE* statm = fopen("/proc/self/statm", "r");
+	if (statm == nullptr)
+		return 0;
+
+	int valuesRead = fscanf(statm, "%zu %zu", &totalPages, &residentPages);
+	fclose(statm);
+
+	return (valuesRead == 2) ? residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+}
+
+size_t et::availableMemory()
+{
+	return static_cast<size_t>(sysconf(_SC_AVPHYS_PAGES)) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+void* et::allocateVirtualMemory(size_t size)
+{
+	void* result = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return (result == MAP_FAILED) ? nullptr : result;
+}
+
+void et::deallocateVirtualMemory(void* ptr, size_t size)
+{
+	munmap(ptr, size);
+}
+
+#endif // ET_PLATFORM_LINUX
@@ -0,0 +1,64 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/app/application.h>
+#include <et/app/backgroundthread.h>
+
+#if (ET_PLATFORM_LINUX)
+
+/*
+ * There is no Application on Linux host,
+ * main run loop belongs to the thread which first accessed it and is updated by the host.
+ */
+
+using namespace et;
+
+namespace
+{
+	class HostRunLoops
+	{
+	public:
+		HostRunLoops()
+		{
+			registerRunLoop(mainRunLoop);
+			backgroundThread.run();
+		}
+
+		~HostRunLoops()
+		{
+			backgroundThread.stopAndWaitForTermination();
+			unregisterRunLoop(mainRunLoop);
+		}
+
+	public:
+		RunLoop mainRunLoop;
+		BackgroundThread backgroundThread;
+	};
+
+	HostRunLoops& hostRunLoops()
+	{
+		static HostRunLoops runLoops;
+		return runLoops;
+	}
+}
+
+RunLoop& et::mainRunLoop()
+{
+	return hostRunLoops().mainRunLoop;
+}
+
+RunLoop& et::backgroundRunLoop()
+{
+	return hostRunLoops().backgroundThread.runLoop();
+}
+
+TimerPool::Pointer& et::mainTimerPool()
+{
+	return hostRunLoops().mainRunLoop.firstTimerPool();
+}
+
+#endif // ET_PLATFORM_LINUX
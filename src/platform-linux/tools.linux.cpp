@@ -0,0 +1,267 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/core/tools.h>
+#include <et/rendering/rendering.h>
+
+#if (ET_PLATFORM_LINUX)
+
+#include <dirent.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <fstream>
+
+static uint64_t startTime = 0;
+static bool startTimeInitialized = false;
+
+const char et::pathDelimiter = '/';
+const char et::invalidPathDelimiter = '\\';
+
+namespace
+{
+	uint64_t queryActualTime()
+	{
+		timeval tv = { };
+		gettimeofday(&tv, 0);
+		return static_cast<uint64_t>(tv.tv_sec) * 1000 + static_cast<uint64_t>(tv.tv_usec) / 1000;
+	}
+
+	bool pathHasMode(const std::string& path, mode_t mode)
+	{
+		struct stat status = { };
+		return (stat(path.c_str(), &status) == 0) && ((status.st_mode & S_IFMT) == mode);
+	}
+
+	void listFolder(const std::string& folder, bool directories, const char* mask, bool recursive, et::StringList& list)
+	{
+		DIR* dir = opendir(folder.c_str());
+		if (dir == nullptr) return;
+
+		std::string base = et::addTrailingSlash(folder);
+		while (dirent* entry = readdir(dir))
+		{
+			std::string name(entry->d_name);
+			if ((name == ".") || (name == "..")) continue;
+
+			std::string path = base + name;
+			if (pathHasMode(path, S_IFDIR))
+			{
+				if (directories)
+					list.push_back(et::addTrailingSlash(path));
+
+				if (recursive)
+					listFolder(path, directories, mask, true, list);
+			}
+			else if (!directories && ((mask == nullptr) || (fnmatch(mask, name.c_str(), 0) == 0)))
+			{
+				list.push_back(path);
+			}
+		}
+		closedir(dir);
+	}
+}
+
+float et::queryContiniousTimeInSeconds()
+{
+	return static_cast<float>(queryContiniousTimeInMilliSeconds()) / 1000.0f;
+}
+
+uint64_t et::queryContiniousTimeInMilliSeconds()
+{
+	if (!startTimeInitialized)
+	{
+		startTime = queryActualTime();
+		startTimeInitialized = true;
+	};
+
+	return queryActualTime() - startTime;
+}
+
+uint64_t et::queryCurrentTimeInMicroSeconds()
+{
+	timeval tv = { };
+	gettimeofday(&tv, 0);
+	return static_cast<uint64_t>(tv.tv_sec) * 1000000 + static_cast<uint64_t>(tv.tv_usec);
+}
+
+uint64_t et::getFileDate(const std::string& path)
+{
+	struct stat s = { };
+	stat(path.c_str(), &s);
+	return static_cast<uint64_t>(s.st_mtim.tv_sec);
+}
+
+std::string et::applicationPath()
+{
+	static std::string result;
+	if (result.empty())
+	{
+		char buffer[PATH_MAX] = { };
+		ssize_t length = readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
+		result = (length > 0) ? getFilePath(std::string(buffer, static_cast<size_t>(length))) : std::string("./");
+	}
+	return result;
+}
+
+std::string et::applicationPackagePath()
+{
+	return applicationPath();
+}
+
+std::string et::applicationDataFolder()
+{
+	return applicationPath();
+}
+
+std::string et::libraryBaseFolder()
+{
+	return applicationPath();
+}
+
+std::string et::documentsBaseFolder()
+{
+	const char* home = getenv("HOME");
+	return (home == nullptr) ? applicationPath() : addTrailingSlash(std::string(home));
+}
+
+std::string et::temporaryBaseFolder()
+{
+	const char* temp = getenv("TMPDIR");
+	return addTrailingSlash(std::string((temp == nullptr) ? "/tmp" : temp));
+}
+
+bool et::fileExists(const std::string& name)
+{
+	return pathHasMode(name, S_IFREG);
+}
+
+bool et::folderExists(const std::string& name)
+{
+	return pathHasMode(name, S_IFDIR);
+}
+
+bool et::createDirectory(const std::string& name, bool intermediates)
+{
+	if (::mkdir(name.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) == 0)
+		return true;
+
+	if (errno == EEXIST)
+		return folderExists(name);
+
+	if (intermediates && (errno == ENOENT))
+	{
+		std::string parent = getFilePath(name.substr(0, name.find_last_not_of(pathDelimiter) + 1));
+		if (!parent.empty() && createDirectory(parent.substr(0, parent.size() - 1), true))
+			return (::mkdir(name.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) == 0) || folderExists(name);
+	}
+
+	log::error("Unable to create directory %s (%d)", name.c_str(), errno);
+	return false;
+}
+
+bool et::removeDirectory(const std::string& name)
+{
+	return (::rmdir(name.c_str()) == 0);
+}
+
+bool et::removeFile(const std::string& name)
+{
+	return (::remove(name.c_str()) == 0);
+}
+
+bool et::copyFile(const std::string& fromName, const std::string& toName)
+{
+	std::ifstream input(fromName, std::ios::in | std::ios::binary);
+	std::ofstream output(toName, std::ios::out | std::ios::binary);
+	if (input.fail() || output.fail())
+		return false;
+
+	output << input.rdbuf();
+	return output.good();
+}
+
+void et::getFolderContent(const std::string& folder, StringList& list)
+{
+	DIR* dir = opendir(folder.c_str());
+	if (dir == nullptr)
+	{
+		log::error("Unable to get contents of the %s", folder.c_str());
+		return;
+	}
+
+	while (dirent* entry = readdir(dir))
+	{
+		std::string name(entry->d_name);
+		if ((name != ".") && (name != ".."))
+			list.push_back(folder + name);
+	}
+	closedir(dir);
+}
+
+void et::findFiles(const std::string& folder, const std::string& mask, bool recursive, StringList& list)
+{
+	listFolder(folder, false, mask.c_str(), recursive, list);
+}
+
+void et::findSubfolders(const std::string& folder, bool recursive, StringList& list)
+{
+	listFolder(folder, true, nullptr, recursive, list);
+}
+
+void et::openUrl(const std::string&)
+{
+}
+
+std::string et::unicodeToUtf8(const std::wstring& w)
+{
+	std::string result(w.size() * MB_LEN_MAX, 0);
+	size_t length = wcstombs(&result[0], w.c_str(), result.size());
+	result.resize((length == static_cast<size_t>(-1)) ? 0 : length);
+	return result;
+}
+
+std::wstring et::utf8ToUnicode(const std::string& mbcs)
+{
+	std::wstring result(mbcs.size(), 0);
+	size_t length = mbstowcs(&result[0], mbcs.c_str(), result.size());
+	result.resize((length == static_cast<size_t>(-1)) ? 0 : length);
+	return result;
+}
+
+std::string et::applicationIdentifierForCurrentProject()
+{
+	return getFileName(applicationPath().substr(0, applicationPath().size() - 1));
+}
+
+et::vec2i et::nativeScreenSize()
+{
+	ET_FAIL("Not supported on this platform");
+	return vec2i(1);
+}
+
+et::vec2i et::availableScreenSize()
+{
+	ET_FAIL("Not supported on this platform");
+	return vec2i(1);
+}
+
+/*
+ * Linux host is built without renderer, same as DirectX there are no OpenGL types to convert
+ */
+namespace et
+{
+	VertexAttributeType openglTypeToVertexAttributeType(uint32_t value)
+	{
+		ET_FAIL_FMT("Unsupported OpenGL type %u (0x%X)", value, value);
+	}
+}
+
+#endif // ET_PLATFORM_LINUX
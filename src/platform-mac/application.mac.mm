@@ -38,8 +38,8 @@ using namespace et;
  */
 void Application::loaded()
 {
-	_lastQueuedTimeMSec = queryContiniousTimeInMilliSeconds();
-	_runLoop.updateTime(_lastQueuedTimeMSec);
+	_lastQueuedTimeNSec = queryContiniousTimeInNanoSeconds();
+	_runLoop.updateTimeNSec(_lastQueuedTimeNSec);
 		
 	RenderContextParameters parameters;
 	delegate()->setRenderContextParameters(parameters);
@@ -76,7 +76,7 @@ void Application::loaded()
 	(void)ET_OBJC_AUTORELEASE(applicationMenu);
 #endif
 	
-	_runLoop.updateTime(_lastQueuedTimeMSec);
+	_runLoop.updateTimeNSec(_lastQueuedTimeNSec);
 	enterRunLoop();
 }
 
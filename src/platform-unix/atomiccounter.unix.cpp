@@ -7,11 +7,11 @@
 
 #include <et/core/et.h>
 
-#if (ET_PLATFORM_IOS | ET_PLATFORM_MAC | ET_PLATFORM_ANDROID)
+#if (ET_PLATFORM_IOS | ET_PLATFORM_MAC | ET_PLATFORM_ANDROID | ET_PLATFORM_LINUX)
 
 #if (ET_PLATFORM_ANDROID)
 #	include <sys/atomics.h>
-#else
+#elif (ET_PLATFORM_APPLE)
 #	include <libkern/OSAtomic.h>
 #endif
 
@@ -49,6 +49,8 @@ AtomicCounterType AtomicCounter::retain()
 	
 #if (ET_PLATFORM_ANDROID)
 	return __atomic_inc(&_counter);
+#elif (ET_PLATFORM_LINUX)
+	return __sync_add_and_fetch(&_counter, 1);
 #else
 	return OSAtomicIncrement32(&_counter);
 #endif
@@ -69,6 +71,8 @@ AtomicCounterType AtomicCounter::release()
 
 #if (ET_PLATFORM_ANDROID)
 	return __atomic_dec(&_counter);
+#elif (ET_PLATFORM_LINUX)
+	return __sync_sub_and_fetch(&_counter, 1);
 #else
 	return OSAtomicDecrement32(&_counter);
 #endif
@@ -95,6 +99,8 @@ bool AtomicBool::operator = (bool b)
 	ET_ASSERT((_value & validMask) == 0);
 #if (ET_PLATFORM_ANDROID)
 	__atomic_swap(b, &_value);
+#elif (ET_PLATFORM_LINUX)
+	__sync_lock_test_and_set(&_value, AtomicCounterType(b));
 #else
 	OSAtomicCompareAndSwap32Barrier(_value, AtomicCounterType(b), &_value);
 #endif
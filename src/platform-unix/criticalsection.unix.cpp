@@ -7,7 +7,7 @@
 
 #include <et/threading/criticalsection.h>
 
-#if (ET_PLATFORM_IOS | ET_PLATFORM_MAC | ET_PLATFORM_ANDROID)
+#if (ET_PLATFORM_IOS | ET_PLATFORM_MAC | ET_PLATFORM_ANDROID | ET_PLATFORM_LINUX)
 
 #include <errno.h>
 #include <pthread.h>
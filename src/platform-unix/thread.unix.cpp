@@ -7,7 +7,7 @@
 
 #include <et/threading/thread.h>
 
-#if (ET_PLATFORM_IOS | ET_PLATFORM_MAC | ET_PLATFORM_ANDROID)
+#if (ET_PLATFORM_IOS | ET_PLATFORM_MAC | ET_PLATFORM_ANDROID | ET_PLATFORM_LINUX)
 
 #include <pthread.h>
 #include <unistd.h>
@@ -164,4 +164,4 @@ Thread::Identifier Thread::identifier() const
 	return _private->threadId;
 }
 
-#endif // ET_PLATFORM_IOS | ET_PLATFORM_MAC | ET_PLATFORM_ANDROID
+#endif // ET_PLATFORM_IOS | ET_PLATFORM_MAC | ET_PLATFORM_ANDROID | ET_PLATFORM_LINUX
@@ -142,8 +142,8 @@ int Application::platformRun(int, char*[])
 	RenderContextParameters params;
 	delegate()->setRenderContextParameters(params); 
 
-	_lastQueuedTimeMSec = queryContiniousTimeInMilliSeconds();
-	_runLoop.updateTime(_lastQueuedTimeMSec);
+	_lastQueuedTimeNSec = queryContiniousTimeInNanoSeconds();
+	_runLoop.updateTimeNSec(_lastQueuedTimeNSec);
 
 	_renderContext = sharedObjectFactory().createObject<RenderContext>(params, this);
 	if (_renderContext->valid())
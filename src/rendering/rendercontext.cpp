@@ -18,6 +18,9 @@ void RenderContext::onFPSTimerExpired(NotifyTimer*)
 		_info.averagePolygonsPerSecond /= _info.averageFramePerSecond;
 		_info.averageFrameTimeInMicroseconds /= _info.averageFramePerSecond;
 	}
+
+	_info.frameTimeHistogram = _app->frameTimeHistogram();
+	_app->resetFrameTimeHistogram();
 	
 	renderingInfoUpdated.invoke(_info);
 	
@@ -28,6 +28,9 @@ namespace et
 			
 			void reloadObject(LoadableObject::Pointer o, ObjectsCache& c)
 				{ owner->reloadObject(o, c); }
+
+			bool reloadObjectAsync(LoadableObject::Pointer o, ObjectsCache& c)
+				{ return owner->reloadObjectAsync(o, c); }
 		};
 		
 		TextureFactoryPrivate(TextureFactory* owner) :
@@ -284,6 +287,16 @@ void TextureFactory::textureLoadingThreadDidLoadTextureData(TextureLoadingReques
 {
 	CriticalSectionScope lock(_csTextureLoading);
 
+	if (request->reloadingCache != nullptr)
+	{
+		if (request->textureDescription.valid())
+			request->texture->updateData(renderContext(), request->textureDescription);
+		
+		request->reloadingCache->objectDidReload(request->texture);
+		etDestroyObject(request);
+		return;
+	}
+
 	request->texture->updateData(renderContext(), request->textureDescription);
 	textureDidLoad.invoke(request->texture);
 
@@ -384,3 +397,9 @@ void TextureFactory::reloadObject(LoadableObject::Pointer object, ObjectsCache&)
 	if (newData.valid())
 		Texture::Pointer(object)->updateData(renderContext(), newData);
 }
+
+bool TextureFactory::reloadObjectAsync(LoadableObject::Pointer object, ObjectsCache& cache)
+{
+	_loadingThread->addReloadRequest(object->origin(), object, cache);
+	return true;
+}
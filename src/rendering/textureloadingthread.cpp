@@ -97,8 +97,21 @@ void TextureLoadingThread::addRequest(const std::string& fileName, Texture::Poin
 		i.invokeInMainRunLoop();
 	}
 	
+	enqueueRequest(etCreateObject<TextureLoadingRequest>(fileName, texture, delegate));
+}
+
+void TextureLoadingThread::addReloadRequest(const std::string& fileName, Texture::Pointer texture,
+	ObjectsCache& cache)
+{
+	auto request = etCreateObject<TextureLoadingRequest>(fileName, texture, nullptr);
+	request->reloadingCache = &cache;
+	enqueueRequest(request);
+}
+
+void TextureLoadingThread::enqueueRequest(TextureLoadingRequest* request)
+{
 	CriticalSectionScope lock(_requestsCriticalSection);
-	_requests.push(etCreateObject<TextureLoadingRequest>(fileName, texture, delegate));
+	_requests.push(request);
 
 	if (running())
 		resume();
@@ -5,10 +5,19 @@
  *
  */
 
+#include <et/core/arenaallocator.h>
+#include <et/core/memorytags.h>
+#include <et/core/profiler.h>
 #include <et/rt/kdtree.h>
 
 using namespace et;
 
+const float rt::Constants::epsilon = 0.0001f;
+const float rt::Constants::minusEpsilon = -epsilon;
+const float rt::Constants::onePlusEpsilon = 1.0f + epsilon;
+const float rt::Constants::epsilonSquared = epsilon * epsilon;
+const float rt::Constants::initialSplitValue = std::numeric_limits<float>::max();
+
 namespace
 {
 	const size_t DepthLimit = 31;
@@ -100,6 +109,9 @@ KDTree::Node KDTree::buildRootNode()
 
 void KDTree::build(const rt::TriangleList& triangles, size_t maxDepth, int splits)
 {
+	ET_MEMORY_TAG("rt");
+	ET_PROFILE_ZONE("kdtree::build");
+	
 	cleanUp();
 	
 	_maxBuildDepth = 0;
@@ -260,47 +272,61 @@ void KDTree::splitNodeUsingSortedArray(size_t nodeIndex, size_t depth)
 		return result;
 	};
 	
-	std::vector<vec3> minPoints;
-	std::vector<vec3> maxPoints;
-	const auto& localNode = _nodes.at(nodeIndex);
-	for (size_t triIndex : localNode.triangles)
-	{
-		const auto& tri = _triangles.at(triIndex);
-		minPoints.push_back(tri.minVertex().xyz() - vec3(rt::Constants::epsilon));
-		maxPoints.push_back(tri.maxVertex().xyz() + vec3(rt::Constants::epsilon));
-	}
-	
-	vec3 splitPosition = minPoints.at(minPoints.size() / 2);
+	vec3 splitPosition;
 	vec3 splitCost(rt::Constants::initialSplitValue);
-	
 	bool splitFound = false;
-	int numElements = static_cast<int>(minPoints.size());
 	
-	for (int currentAxis = 0; currentAxis < 3; ++currentAxis)
 	{
-		std::sort(minPoints.begin(), minPoints.end(), [&currentAxis](const vec3& l, const vec3& r)
-			{ return l[currentAxis] < r[currentAxis]; });
+		/*
+		 * Sorted bounds are only needed to find split position,
+		 * released before descending into children
+		 */
+		ArenaAllocatorScope arenaScope(threadFrameArena());
+		ArenaAllocatorSTDProxy<vec3> arenaAllocator(arenaScope.arena());
+		
+		const auto& localNode = _nodes.at(nodeIndex);
 		
-		std::sort(maxPoints.begin(), maxPoints.end(), [&currentAxis](const vec3& l, const vec3& r)
-			{ return l[currentAxis] < r[currentAxis]; });
+		std::vector<vec3, ArenaAllocatorSTDProxy<vec3>> minPoints(arenaAllocator);
+		std::vector<vec3, ArenaAllocatorSTDProxy<vec3>> maxPoints(arenaAllocator);
+		minPoints.reserve(localNode.triangles.size());
+		maxPoints.reserve(localNode.triangles.size());
 		
-		for (int i = 1; i + 1 < numElements; ++i)
+		for (size_t triIndex : localNode.triangles)
 		{
-			float costMin = estimateCostAtSplit(minPoints.at(i)[currentAxis], i, numElements - i, currentAxis);
-			if (compareAndAssignMinimum(splitCost[currentAxis], costMin))
-			{
-				splitPosition[currentAxis] = minPoints.at(i)[currentAxis];
-				splitFound = true;
-			}
+			const auto& tri = _triangles.at(triIndex);
+			minPoints.push_back(tri.minVertex().xyz() - vec3(rt::Constants::epsilon));
+			maxPoints.push_back(tri.maxVertex().xyz() + vec3(rt::Constants::epsilon));
 		}
 		
-		for (int i = numElements - 2; i > 0; --i)
+		splitPosition = minPoints.at(minPoints.size() / 2);
+		int numElements = static_cast<int>(minPoints.size());
+		
+		for (int currentAxis = 0; currentAxis < 3; ++currentAxis)
 		{
-			float costMax = estimateCostAtSplit(maxPoints.at(i)[currentAxis], i, numElements - i, currentAxis);
-			if (compareAndAssignMinimum(splitCost[currentAxis], costMax))
+			std::sort(minPoints.begin(), minPoints.end(), [&currentAxis](const vec3& l, const vec3& r)
+				{ return l[currentAxis] < r[currentAxis]; });
+			
+			std::sort(maxPoints.begin(), maxPoints.end(), [&currentAxis](const vec3& l, const vec3& r)
+				{ return l[currentAxis] < r[currentAxis]; });
+			
+			for (int i = 1; i + 1 < numElements; ++i)
+			{
+				float costMin = estimateCostAtSplit(minPoints.at(i)[currentAxis], i, numElements - i, currentAxis);
+				if (compareAndAssignMinimum(splitCost[currentAxis], costMin))
+				{
+					splitPosition[currentAxis] = minPoints.at(i)[currentAxis];
+					splitFound = true;
+				}
+			}
+			
+			for (int i = numElements - 2; i > 0; --i)
 			{
-				splitPosition[currentAxis] = maxPoints.at(i)[currentAxis];
-				splitFound = true;
+				float costMax = estimateCostAtSplit(maxPoints.at(i)[currentAxis], i, numElements - i, currentAxis);
+				if (compareAndAssignMinimum(splitCost[currentAxis], costMax))
+				{
+					splitPosition[currentAxis] = maxPoints.at(i)[currentAxis];
+					splitFound = true;
+				}
 			}
 		}
 	}
@@ -7,6 +7,7 @@
 
 #include <thread>
 #include <mutex>
+#include <et/core/profiler.h>
 #include <et/rt/raytrace.h>
 #include <et/rt/raytraceobjects.h>
 #include <et/app/application.h>
@@ -15,12 +16,6 @@
 
 namespace et
 {
-	
-const float rt::Constants::epsilon = 0.0001f;
-const float rt::Constants::minusEpsilon = -epsilon;
-const float rt::Constants::onePlusEpsilon = 1.0f + epsilon;
-const float rt::Constants::epsilonSquared = epsilon * epsilon;
-const float rt::Constants::initialSplitValue = std::numeric_limits<float>::max();
 
 namespace
 {
@@ -401,6 +396,8 @@ void RaytracePrivate::threadFunction()
 		if (!region.sampled)
 			break;
 
+		ET_PROFILE_ZONE("raytrace::region");
+
 		vec2i pixel;
 
 		for (pixel.y = region.origin.y; pixel.y < region.origin.y + region.size.y; ++pixel.y)
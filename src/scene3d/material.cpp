@@ -123,6 +123,7 @@ void Material::deserializeWithOptions(Dictionary stream, RenderContext* rc, Obje
 	_depthMask = stream.integerForKey(kDepthMask)->content != 0;
 
 	bool shouldCreateTextures = (options & DeserializeOption_CreateTextures) == DeserializeOption_CreateTextures;
+	bool loadTexturesAsync = (options & DeserializeOption_LoadTexturesAsync) == DeserializeOption_LoadTexturesAsync;
 	Dictionary intValues = stream.dictionaryForKey(kIntegerValues);
 	Dictionary floatValues = stream.dictionaryForKey(kFloatValues);
 	Dictionary vectorValues = stream.dictionaryForKey(kVectorValues);
@@ -147,7 +148,7 @@ void Material::deserializeWithOptions(Dictionary stream, RenderContext* rc, Obje
 			if (!fileExists(textureFileName))
 				textureFileName = basePath + textureFileName;
 			
-			setTexture(i, rc->textureFactory().loadTexture(textureFileName, cache));
+			setTexture(i, rc->textureFactory().loadTexture(textureFileName, cache, loadTexturesAsync, this));
 		}
 	}
 }
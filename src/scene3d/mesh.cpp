@@ -116,6 +116,11 @@ void Mesh::setVertexArrayObject(VertexArrayObject vao)
 	_vao = vao;
 }
 
+void Mesh::releaseVertexArrayObject()
+{
+	_vao = VertexArrayObject();
+}
+
 void Mesh::setVertexStorage(VertexStorage::Pointer vs)
 {
 	_vertexStorage = vs;
@@ -5,6 +5,9 @@
  *
  */
 
+#include <et/core/binaryserialization.h>
+#include <et/core/memorytags.h>
+#include <et/core/profiler.h>
 #include <et/app/application.h>
 #include <et/rendering/rendercontext.h>
 #include <et/scene3d/scene3d.h>
@@ -101,17 +104,66 @@ Dictionary Scene::serialize(const std::string& basePath)
 void Scene::deserializeWithOptions(et::RenderContext* rc, Dictionary info, const std::string& basePath,
 	ObjectsCache& cache, uint32_t options)
 {
+	ET_MEMORY_TAG("scene3d");
+	ET_PROFILE_ZONE("scene3d::deserialize");
+	
 	_serializationBasePath = basePath;
 	_storage.deserializeWithOptions(rc,  info.dictionaryForKey(kStorage), this, cache, options);
-	
-	if (options & DeserializeOption_CreateVertexBuffers)
+	finishDeserialization(rc, info, options);
+}
+
+bool Scene::serializeToContainer(const std::string& fileName, SceneSectionCompression compression)
+{
+	SceneContainerWriter writer;
+
+	Dictionary result;
+	result.setDictionaryForKey(kStorage, _storage.serializeToContainer(writer, fileName, compression));
+	ElementContainer::serialize(result, fileName);
+	writer.addSection(SceneSectionType::Hierarchy, binary::serialize(result), compression);
+
+	return writer.writeToFile(fileName);
+}
+
+bool Scene::deserializeFromContainer(et::RenderContext* rc, const std::string& fileName,
+	ObjectsCache& cache, uint32_t options)
+{
+	ET_MEMORY_TAG("scene3d");
+
+	Dictionary info;
+	auto container = SceneContainer::Pointer::create(fileName);
+	if (!container->valid() || !container->readHierarchy(info))
+	{
+		log::error("[s3d::Scene] Unable to load scene container: %s", fileName.c_str());
+		return false;
+	}
+
+	deserializeFromContainer(rc, container, info, getFilePath(fileName), cache, options);
+	return true;
+}
+
+void Scene::deserializeFromContainer(et::RenderContext* rc, SceneContainer::Pointer container, Dictionary info,
+	const std::string& basePath, ObjectsCache& cache, uint32_t options)
+{
+	ET_MEMORY_TAG("scene3d");
+	ET_PROFILE_ZONE("scene3d::deserialize");
+
+	_serializationBasePath = basePath;
+	_storage.deserializeFromContainer(rc, info.dictionaryForKey(kStorage), container, this, cache, options);
+	finishDeserialization(rc, info, options);
+}
+
+void Scene::finishDeserialization(et::RenderContext* rc, Dictionary info, uint32_t options)
+{
+	bool streamGeometry = (options & DeserializeOption_StreamGeometry) == DeserializeOption_StreamGeometry;
+
+	if ((options & DeserializeOption_CreateVertexBuffers) && !streamGeometry)
 	{
 		buildVertexBuffers(rc);
 	}
 	
 	ElementContainer::deserialize(info, this);
 	
-	if ((options & DeserializeOption_KeepGeometry) == 0)
+	if (((options & DeserializeOption_KeepGeometry) == 0) && !streamGeometry)
 	{
 		cleanupGeometry();
 	}
@@ -0,0 +1,245 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <external/zlib/zlib.h>
+#include <et/core/binaryserialization.h>
+#include <et/scene3d/scenecontainer.h>
+
+using namespace et;
+using namespace et::s3d;
+
+namespace
+{
+	const char sceneContainerMagic[] = { 'E', 'T', 'S', 'C' };
+
+	enum : uint32_t
+	{
+		SceneContainerVersion = 1,
+		SceneSectionAlignment = 4096,
+	};
+
+	/*
+	 * Maximal compression ratio of deflate, zlib sections declaring larger size are invalid
+	 */
+	enum : uint64_t
+	{
+		ZlibMaxExpansion = 1032,
+	};
+
+	inline uint64_t alignSectionOffset(uint64_t offset)
+		{ return (offset + SceneSectionAlignment - 1) & ~static_cast<uint64_t>(SceneSectionAlignment - 1); }
+}
+
+static_assert(sizeof(SceneContainerHeader) == 32, "Invalid scene container header size");
+static_assert(sizeof(SceneSectionHeader) == 32, "Invalid scene section header size");
+
+/*
+ * SceneContainerWriter
+ */
+uint32_t SceneContainerWriter::addSection(SceneSectionType type, const char* data, size_t size,
+	SceneSectionCompression compression)
+{
+	Section section;
+	section.header.type = type;
+	section.header.size = size;
+
+	if ((compression == SceneSectionCompression::Zlib) && (size > 0))
+	{
+		uLongf compressedSize = compressBound(static_cast<uLong>(size));
+		BinaryDataStorage compressed(compressedSize);
+
+		int result = compress2(compressed.data(), &compressedSize, reinterpret_cast<const Bytef*>(data),
+			static_cast<uLong>(size), Z_DEFAULT_COMPRESSION);
+
+		if ((result == Z_OK) && (compressedSize < size))
+		{
+			section.header.compression = SceneSectionCompression::Zlib;
+			section.header.storedSize = compressedSize;
+			section.data = BinaryDataStorage(compressedSize);
+			etCopyMemory(section.data.data(), compressed.data(), compressedSize);
+		}
+	}
+
+	if (section.header.compression == SceneSectionCompression::None)
+	{
+		section.header.storedSize = size;
+		section.data = BinaryDataStorage(size);
+		etCopyMemory(section.data.data(), data, size);
+	}
+
+	_sections.push_back(section);
+	return static_cast<uint32_t>(_sections.size() - 1);
+}
+
+bool SceneContainerWriter::writeToFile(const std::string& fileName)
+{
+	SceneContainerHeader header;
+	etCopyMemory(header.magic, sceneContainerMagic, sizeof(sceneContainerMagic));
+	header.version = SceneContainerVersion;
+	header.sectionsCount = static_cast<uint32_t>(_sections.size());
+	header.alignment = SceneSectionAlignment;
+	header.tableOffset = sizeof(SceneContainerHeader);
+
+	uint64_t offset = header.tableOffset + _sections.size() * sizeof(SceneSectionHeader);
+	for (auto& section : _sections)
+	{
+		section.header.offset = alignSectionOffset(offset);
+		offset = section.header.offset + section.header.storedSize;
+	}
+	header.fileSize = offset;
+
+	std::ofstream file(fileName, std::ios::out | std::ios::binary);
+	if (!file.good())
+	{
+		log::error("Unable to write scene container: %s", fileName.c_str());
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (const auto& section : _sections)
+		file.write(reinterpret_cast<const char*>(&section.header), sizeof(section.header));
+
+	const char padding[SceneSectionAlignment] = { };
+	uint64_t position = header.tableOffset + _sections.size() * sizeof(SceneSectionHeader);
+	for (const auto& section : _sections)
+	{
+		file.write(padding, static_cast<std::streamsize>(section.header.offset - position));
+		file.write(section.data.binary(), static_cast<std::streamsize>(section.header.storedSize));
+		position = section.header.offset + section.header.storedSize;
+	}
+
+	file.flush();
+	return file.good();
+}
+
+/*
+ * SceneContainer
+ */
+bool SceneContainer::isSceneContainer(const std::string& fileName)
+{
+	char magic[sizeof(sceneContainerMagic)] = { };
+
+	std::ifstream file(fileName, std::ios::in | std::ios::binary);
+	file.read(magic, sizeof(magic));
+
+	return file.good() && (memcmp(magic, sceneContainerMagic, sizeof(magic)) == 0);
+}
+
+SceneContainer::SceneContainer(const std::string& fileName) :
+	_file(MappedFile::Pointer::create(fileName, MappedFile::Access::Random, MappedFile::Protection::CopyOnWrite))
+{
+	if (!_file->valid())
+	{
+		log::error("Unable to open scene container: %s", fileName.c_str());
+		return;
+	}
+
+	SceneContainerHeader header;
+	if (_file->size() < sizeof(header))
+	{
+		log::error("Scene container is truncated: %s", fileName.c_str());
+		return;
+	}
+	etCopyMemory(&header, _file->data(), sizeof(header));
+
+	if ((memcmp(header.magic, sceneContainerMagic, sizeof(sceneContainerMagic)) != 0) ||
+		(header.version != SceneContainerVersion))
+	{
+		log::error("Invalid scene container header: %s", fileName.c_str());
+		return;
+	}
+
+	uint64_t fileSize = _file->size();
+	if ((header.fileSize > fileSize) || (header.tableOffset > fileSize) ||
+		(header.sectionsCount > (fileSize - header.tableOffset) / sizeof(SceneSectionHeader)))
+	{
+		log::error("Scene container is truncated: %s", fileName.c_str());
+		return;
+	}
+
+	_sections.resize(header.sectionsCount);
+	etCopyMemory(_sections.data(), _file->data() + header.tableOffset, header.sectionsCount * sizeof(SceneSectionHeader));
+
+	for (const auto& section : _sections)
+	{
+		bool validCompression = (section.compression == SceneSectionCompression::None) ?
+			(section.storedSize == section.size) : (section.compression == SceneSectionCompression::Zlib);
+
+		bool validBounds = (section.offset <= fileSize) && (section.storedSize <= fileSize - section.offset);
+
+		bool validSize = (section.compression != SceneSectionCompression::Zlib) ||
+			((section.size <= section.storedSize * ZlibMaxExpansion) && (section.size <= std::numeric_limits<uLongf>::max()));
+
+		if (!validCompression || !validBounds || !validSize)
+		{
+			log::error("Scene container has invalid section: %s", fileName.c_str());
+			_sections.clear();
+			return;
+		}
+	}
+
+	_valid = true;
+}
+
+int32_t SceneContainer::findSection(SceneSectionType type) const
+{
+	for (size_t i = 0, e = _sections.size(); i < e; ++i)
+	{
+		if (_sections[i].type == type)
+			return static_cast<int32_t>(i);
+	}
+	return -1;
+}
+
+BinaryDataStorage SceneContainer::sectionData(size_t index)
+{
+	if (index >= _sections.size())
+	{
+		log::error("Invalid scene container section index: %llu", static_cast<uint64_t>(index));
+		return BinaryDataStorage();
+	}
+
+	const auto& section = _sections.at(index);
+	size_t offset = static_cast<size_t>(section.offset);
+	size_t storedSize = static_cast<size_t>(section.storedSize);
+
+	if (section.compression == SceneSectionCompression::None)
+	{
+		_file->advise(MappedFile::Access::WillNeed, offset, storedSize);
+		return _file->mutableView(offset, storedSize);
+	}
+
+	BinaryDataStorage result(static_cast<size_t>(section.size));
+	uLongf decompressedSize = static_cast<uLongf>(section.size);
+
+	int status = uncompress(result.data(), &decompressedSize,
+		reinterpret_cast<const Bytef*>(_file->data() + offset), static_cast<uLong>(storedSize));
+
+	if ((status != Z_OK) || (decompressedSize != section.size))
+	{
+		log::error("Unable to decompress scene container section %llu", static_cast<uint64_t>(index));
+		return BinaryDataStorage();
+	}
+
+	_file->advise(MappedFile::Access::DontNeed, offset, storedSize);
+	return result;
+}
+
+bool SceneContainer::readHierarchy(Dictionary& result)
+{
+	int32_t hierarchySection = findSection(SceneSectionType::Hierarchy);
+	if (hierarchySection < 0)
+		return false;
+
+	ValueClass vc = ValueClass_Invalid;
+	Dictionary hierarchy = binary::deserialize(sectionData(static_cast<size_t>(hierarchySection)), vc);
+	if (vc != ValueClass_Dictionary)
+		return false;
+
+	result = hierarchy;
+	return true;
+}
@@ -0,0 +1,467 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <mutex>
+#include <condition_variable>
+#include <et/core/profiler.h>
+#include <et/app/invocation.h>
+#include <et/rendering/rendercontext.h>
+#include <et/threading/thread.h>
+#include <et/scene3d/serialization.h>
+#include <et/scene3d/scenestreamer.h>
+
+namespace et
+{
+	namespace s3d
+	{
+		struct SceneStreamingPayload : public Shared
+		{
+			ET_DECLARE_POINTER(SceneStreamingPayload)
+
+			enum class State
+			{
+				Unloaded,
+				Queued,
+				Loaded,
+				Resident
+			};
+
+			Dictionary info;
+			VertexStorage::Pointer placeholder;
+			VertexStorage::Pointer vertexStorage;
+			IndexArray::Pointer indexArray;
+			VertexArrayObject vertexArrayObject;
+			std::vector<Mesh::Pointer> meshes;
+			size_t section = 0;
+			size_t dataSize = 0;
+			float priority = 0.0f;
+			State state = State::Unloaded;
+			bool requested = false;
+		};
+
+		/*
+		 * Shared between streamer, worker threads and invocations scheduled in the main run loop,
+		 * so neither of them could outlive the data they are using.
+		 */
+		struct SceneStreamingState : public Shared
+		{
+			ET_DECLARE_POINTER(SceneStreamingState)
+
+			std::mutex lock;
+			std::condition_variable condition;
+			std::vector<SceneStreamingPayload::Pointer> queue;
+			SceneContainer::Pointer container;
+			SceneStreamer* owner = nullptr;
+			bool stopping = false;
+
+			SceneStreamingPayload::Pointer waitForPayload();
+			void payloadDidLoad(SceneStreamingPayload::Pointer);
+		};
+
+		class SceneStreamingThread : public Thread
+		{
+		public:
+			SceneStreamingThread(SceneStreamingState::Pointer state) :
+				Thread(false), _state(state) { }
+
+		private:
+			uint64_t main();
+
+		private:
+			SceneStreamingState::Pointer _state;
+		};
+	}
+}
+
+using namespace et;
+using namespace et::s3d;
+
+namespace
+{
+	const float requestedPayloadPriority = -std::numeric_limits<float>::max();
+}
+
+/*
+ * SceneStreamingState
+ */
+SceneStreamingPayload::Pointer SceneStreamingState::waitForPayload()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	condition.wait(guard, [this]() { return stopping || !queue.empty(); });
+
+	if (stopping)
+		return SceneStreamingPayload::Pointer();
+
+	/*
+	 * Queue is small (one entry per vertex storage) and priorities change
+	 * every time viewer moves, so it is cheaper to search than to keep it sorted
+	 */
+	auto best = std::min_element(queue.begin(), queue.end(),
+		[](const SceneStreamingPayload::Pointer& l, const SceneStreamingPayload::Pointer& r)
+		{ return l->priority < r->priority; });
+
+	SceneStreamingPayload::Pointer result = *best;
+	queue.erase(best);
+
+	return result;
+}
+
+void SceneStreamingState::payloadDidLoad(SceneStreamingPayload::Pointer payload)
+{
+	if (owner != nullptr)
+		owner->payloadDidLoad(payload.ptr());
+}
+
+/*
+ * SceneStreamingThread
+ */
+uint64_t SceneStreamingThread::main()
+{
+	while (running())
+	{
+		SceneStreamingPayload::Pointer payload = _state->waitForPayload();
+		if (payload.invalid())
+			break;
+
+		ET_PROFILE_ZONE("scene3d::stream::load");
+
+		const unsigned char* data = nullptr;
+		size_t dataSize = 0;
+		if (payload->placeholder.valid())
+		{
+			payload->vertexStorage = Storage::loadVertexStorage(payload->info, _state->container);
+			const auto& vs = payload->vertexStorage;
+			data = static_cast<const BinaryDataStorage&>(vs->data()).data();
+			dataSize = vs->data().dataSize();
+		}
+		else
+		{
+			payload->indexArray = Storage::loadIndexArray(payload->info, _state->container);
+			data = payload->indexArray->data();
+			dataSize = payload->indexArray->dataSize();
+		}
+
+		/*
+		 * Geometry used in place is mapped lazily, touch every page here,
+		 * so page faults would not happen while uploading data on the main thread
+		 */
+		volatile unsigned char touched = 0;
+		for (size_t i = 0; i < dataSize; i += 4096)
+			touched ^= data[i];
+		(void)touched;
+
+		SceneStreamingState::Pointer state = _state;
+		Invocation([state, payload]() mutable { state->payloadDidLoad(payload); }).invokeInMainRunLoop();
+	}
+	return 0;
+}
+
+/*
+ * SceneStreamer
+ */
+SceneStreamer::SceneStreamer(RenderContext* rc, uint32_t threadsCount) :
+	_rc(rc), _state(SceneStreamingState::Pointer::create())
+{
+	_state->owner = this;
+
+	for (uint32_t i = 0; i < etMax(1u, threadsCount); ++i)
+	{
+		_threads.push_back(etCreateObject<SceneStreamingThread>(_state));
+		_threads.back()->run();
+	}
+}
+
+SceneStreamer::~SceneStreamer()
+{
+	{
+		std::lock_guard<std::mutex> guard(_state->lock);
+		_state->owner = nullptr;
+		_state->stopping = true;
+		_state->queue.clear();
+	}
+	_state->condition.notify_all();
+
+	for (auto thread : _threads)
+	{
+		thread->stop();
+		thread->join();
+		etDestroyObject(thread);
+	}
+}
+
+bool SceneStreamer::open(const std::string& fileName, ObjectsCache& cache, uint32_t options)
+{
+	ET_ASSERT(_scene.invalid());
+
+	Dictionary info;
+	_container = SceneContainer::Pointer::create(fileName);
+	if (!_container->valid() || !_container->readHierarchy(info))
+	{
+		log::error("[s3d::SceneStreamer] Unable to load scene container: %s", fileName.c_str());
+		return false;
+	}
+
+	options |= DeserializeOption_StreamGeometry | DeserializeOption_LoadTexturesAsync;
+
+	_scene = Scene::Pointer::create(getFileName(fileName));
+	_scene->deserializeFromContainer(_rc, _container, info, getFilePath(fileName), cache, options);
+
+	{
+		std::lock_guard<std::mutex> guard(_state->lock);
+		_state->container = _container;
+	}
+
+	Dictionary storage = info.dictionaryForKey(kStorage);
+	Dictionary indexArrayInfo = storage.dictionaryForKey(kIndexArray);
+
+	auto indexPayload = SceneStreamingPayload::Pointer::create();
+	indexPayload->info = indexArrayInfo;
+	indexPayload->section = static_cast<size_t>(indexArrayInfo.integerForKey(kSection)->content);
+	indexPayload->priority = requestedPayloadPriority;
+	indexPayload->requested = true;
+	_indexPayload = indexPayload.ptr();
+	_payloads.push_back(indexPayload);
+
+	Dictionary vertexStorages = storage.dictionaryForKey(kVertexStorages);
+	for (const auto& vs : _scene->storage().vertexStorages())
+	{
+		Dictionary storageInfo = vertexStorages.dictionaryForKey(vs->name());
+
+		auto payload = SceneStreamingPayload::Pointer::create();
+		payload->info = storageInfo;
+		payload->placeholder = vs;
+		payload->section = static_cast<size_t>(storageInfo.integerForKey(kSection)->content);
+		payload->dataSize = static_cast<size_t>(storageInfo.integerForKey(kDataSize)->content);
+		_payloadsByName[vs->name()] = payload.ptr();
+		_payloads.push_back(payload);
+	}
+
+	auto meshes = _scene->childrenOfType(ElementType::Mesh);
+	for (Mesh::Pointer mesh : meshes)
+	{
+		if (mesh->vertexStorage().invalid()) continue;
+
+		auto i = _payloadsByName.find(mesh->vertexStorage()->name());
+		if (i != _payloadsByName.end())
+			i->second->meshes.push_back(mesh);
+	}
+	_statistics.totalMeshes = meshes.size();
+
+	updatePriorities();
+	return true;
+}
+
+void SceneStreamer::setViewerPosition(const vec3& position)
+{
+	_viewerPosition = position;
+	_hasViewerPosition = true;
+	updatePriorities();
+}
+
+void SceneStreamer::request(const Mesh::Pointer& mesh)
+{
+	if (mesh->vertexStorage().invalid()) return;
+
+	auto i = _payloadsByName.find(mesh->vertexStorage()->name());
+	if (i == _payloadsByName.end()) return;
+
+	i->second->requested = true;
+	updatePriorities();
+}
+
+bool SceneStreamer::meshReady(const Mesh::Pointer& mesh) const
+{
+	if (mesh->vertexStorage().invalid()) return false;
+
+	auto i = _payloadsByName.find(mesh->vertexStorage()->name());
+	return (i != _payloadsByName.end()) && (i->second->state == SceneStreamingPayload::State::Resident);
+}
+
+void SceneStreamer::setMemoryBudget(size_t bytes)
+{
+	_memoryBudget = bytes;
+
+	if ((_memoryBudget > 0) && (_statistics.residentMemory > _memoryBudget))
+		unloadUntil(_memoryBudget);
+}
+
+void SceneStreamer::releaseMemory(size_t residentMemory)
+{
+	unloadUntil(residentMemory);
+}
+
+void SceneStreamer::updatePriorities()
+{
+	float worstResidentPriority = -std::numeric_limits<float>::max();
+
+	std::lock_guard<std::mutex> guard(_state->lock);
+	for (auto& payload : _payloads)
+	{
+		if (payload.ptr() == _indexPayload) continue;
+
+		float priority = std::numeric_limits<float>::max();
+		if (payload->requested)
+		{
+			priority = requestedPayloadPriority;
+		}
+		else if (_hasViewerPosition)
+		{
+			for (auto& mesh : payload->meshes)
+			{
+				const Sphere& sphere = mesh->boundingSphere();
+				priority = etMin(priority, etMax(0.0f, (sphere.center() - _viewerPosition).length() - sphere.radius()));
+			}
+		}
+		else
+		{
+			priority = 0.0f;
+		}
+		payload->priority = priority;
+
+		if (payload->state == SceneStreamingPayload::State::Resident)
+			worstResidentPriority = etMax(worstResidentPriority, priority);
+	}
+
+	/*
+	 * With limited budget geometry which would be unloaded right after loading is not scheduled
+	 */
+	for (auto& payload : _payloads)
+	{
+		if (payload->state != SceneStreamingPayload::State::Unloaded) continue;
+
+		bool fitsIntoBudget = (_memoryBudget == 0) || payload->requested ||
+			(_statistics.residentMemory + payload->dataSize <= _memoryBudget) ||
+			(payload->priority < worstResidentPriority);
+
+		if (fitsIntoBudget)
+			enqueue(payload.ptr());
+	}
+}
+
+void SceneStreamer::enqueue(SceneStreamingPayload* payload)
+{
+	payload->state = SceneStreamingPayload::State::Queued;
+	_state->queue.push_back(SceneStreamingPayload::Pointer(payload));
+	_state->condition.notify_one();
+}
+
+void SceneStreamer::payloadDidLoad(SceneStreamingPayload* payload)
+{
+	payload->state = SceneStreamingPayload::State::Loaded;
+	++_statistics.payloadsLoaded;
+
+	if (payload == _indexPayload)
+	{
+		_scene->storage().setIndexArray(payload->indexArray);
+		_indexBuffer = _rc->vertexBufferFactory().createIndexBuffer("mainIndexBuffer",
+			payload->indexArray, BufferDrawType::Static);
+
+		payload->dataSize = payload->indexArray->dataSize();
+		payload->state = SceneStreamingPayload::State::Resident;
+		_statistics.residentMemory += payload->dataSize;
+
+		for (auto& p : _payloads)
+		{
+			if (p->state == SceneStreamingPayload::State::Loaded)
+				makeResident(p.ptr());
+		}
+	}
+	else if (_indexPayload->state == SceneStreamingPayload::State::Resident)
+	{
+		makeResident(payload);
+	}
+
+	_statistics.peakResidentMemory = etMax(_statistics.peakResidentMemory, _statistics.residentMemory);
+}
+
+void SceneStreamer::makeResident(SceneStreamingPayload* payload)
+{
+	ET_PROFILE_ZONE("scene3d::stream::upload");
+
+	const auto& vs = payload->vertexStorage;
+
+	auto vb = _rc->vertexBufferFactory().createVertexBuffer(vs->name(), vs, BufferDrawType::Static);
+	payload->vertexArrayObject = _rc->vertexBufferFactory().createVertexArrayObject("vao-" + vs->name());
+	payload->vertexArrayObject->setBuffers(vb, _indexBuffer);
+
+	_scene->storage().replaceVertexStorage(payload->placeholder, vs);
+
+	payload->dataSize = vs->data().dataSize();
+	payload->state = SceneStreamingPayload::State::Resident;
+	_statistics.residentMemory += payload->dataSize;
+
+	for (auto& mesh : payload->meshes)
+	{
+		mesh->setVertexStorage(vs);
+		mesh->setIndexArray(_indexPayload->indexArray);
+		mesh->setVertexArrayObject(payload->vertexArrayObject);
+		++_statistics.readyMeshes;
+	}
+
+	for (auto& mesh : payload->meshes)
+		meshDidBecomeReady.invoke(mesh);
+
+	if (_memoryBudget > 0)
+		unloadUntil(_memoryBudget);
+}
+
+void SceneStreamer::unload(SceneStreamingPayload* payload)
+{
+	ET_ASSERT(payload->state == SceneStreamingPayload::State::Resident);
+
+	for (auto& mesh : payload->meshes)
+	{
+		mesh->setVertexStorage(payload->placeholder);
+		mesh->releaseVertexArrayObject();
+		--_statistics.readyMeshes;
+	}
+
+	_scene->storage().replaceVertexStorage(payload->vertexStorage, payload->placeholder);
+	payload->vertexArrayObject = VertexArrayObject();
+
+	/*
+	 * Pages of geometry used in place could be dropped right away,
+	 * unless someone else still holds the storage
+	 */
+	bool lastReference = payload->vertexStorage->atomicCounterValue() == 1;
+	payload->vertexStorage = VertexStorage::Pointer();
+
+	if (lastReference && _container->sectionStoredInPlace(payload->section))
+	{
+		const auto& section = _container->section(payload->section);
+		_container->mappedFile()->advise(MappedFile::Access::DontNeed,
+			static_cast<size_t>(section.offset), static_cast<size_t>(section.storedSize));
+	}
+
+	payload->state = SceneStreamingPayload::State::Unloaded;
+	_statistics.residentMemory -= payload->dataSize;
+	++_statistics.payloadsUnloaded;
+
+	for (auto& mesh : payload->meshes)
+		meshDidUnload.invoke(mesh);
+}
+
+void SceneStreamer::unloadUntil(size_t residentMemory)
+{
+	while (_statistics.residentMemory > residentMemory)
+	{
+		SceneStreamingPayload* farthest = nullptr;
+		for (auto& payload : _payloads)
+		{
+			bool canUnload = (payload.ptr() != _indexPayload) && !payload->requested &&
+				(payload->state == SceneStreamingPayload::State::Resident);
+
+			if (canUnload && ((farthest == nullptr) || (payload->priority > farthest->priority)))
+				farthest = payload.ptr();
+		}
+
+		if (farthest == nullptr)
+			break;
+
+		unload(farthest);
+	}
+}
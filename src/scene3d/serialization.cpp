@@ -43,6 +43,7 @@ namespace et
 		const std::string kVertexStorages = "vertexStorages";
 		const std::string kIndexArray = "indexArray";
 		const std::string kBinary = "binary";
+		const std::string kSection = "section";
 		const std::string kVertexDeclaration = "vertexDeclaration";
 		const std::string kUsage = "usage";
 		const std::string kType = "type";
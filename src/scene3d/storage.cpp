@@ -5,6 +5,7 @@
  *
  */
 
+#include <et/core/binaryserialization.h>
 #include <et/json/json.h>
 #include <et/scene3d/storage.h>
 #include <et/scene3d/serialization.h>
@@ -12,6 +13,37 @@
 using namespace et;
 using namespace et::s3d;
 
+namespace
+{
+	/*
+	 * Views are created only when section exactly matches data described in hierarchy,
+	 * otherwise data is copied (and truncated or zero-filled)
+	 */
+	bool sectionCanBeReferenced(const SceneContainer::Pointer& container, size_t section, size_t requiredSize)
+	{
+		if ((section >= container->sectionsCount()) || !container->sectionStoredInPlace(section))
+			return false;
+
+		uint64_t storedSize = container->section(section).storedSize;
+		if (storedSize != requiredSize)
+		{
+			log::warning("Scene container section %llu stores %llu bytes, while %llu bytes expected",
+				static_cast<uint64_t>(section), storedSize, static_cast<uint64_t>(requiredSize));
+			return false;
+		}
+
+		return true;
+	}
+
+	void copySectionData(SceneContainer::Pointer container, size_t section, char* destination, size_t size)
+	{
+		const BinaryDataStorage data = container->sectionData(section);
+		size_t copied = etMin(data.dataSize(), size);
+		etCopyMemory(destination, data.binary(), copied);
+		etFillMemory(destination + copied, 0, size - copied);
+	}
+}
+
 Storage::Storage()
 {
 }
@@ -21,6 +53,11 @@ void Storage::addVertexStorage(const VertexStorage::Pointer& vs)
 	_vertexStorages.push_back(vs);
 }
 
+void Storage::replaceVertexStorage(const VertexStorage::Pointer& from, const VertexStorage::Pointer& to)
+{
+	std::replace(_vertexStorages.begin(), _vertexStorages.end(), from, to);
+}
+
 void Storage::setIndexArray(const IndexArray::Pointer& ia)
 {
 	_indexArray = ia;
@@ -61,32 +98,103 @@ int Storage::indexOfVertexStorage(const VertexStorage::Pointer& vs)
 	return -1;
 }
 
-Dictionary Storage::serialize(const std::string& basePath)
+namespace
 {
-	Dictionary stream;
+	ArrayValue serializeVertexDeclaration(const VertexDeclaration& decl)
+	{
+		ArrayValue declaration;
+		declaration->content.reserve(decl.elements().size());
+		for (const auto& e : decl.elements())
+		{
+			Dictionary declDictionary;
+			declDictionary.setStringForKey(kUsage, vertexAttributeUsageToString(e.usage()));
+			declDictionary.setStringForKey(kType, vertexAttributeTypeToString(e.type()));
+			declDictionary.setStringForKey(kDataType, dataTypeToString(e.dataType()));
+			declDictionary.setIntegerForKey(kStride, e.stride());
+			declDictionary.setIntegerForKey(kOffset, e.offset());
+			declDictionary.setIntegerForKey(kComponents, e.components());
+			declaration->content.push_back(declDictionary);
+		}
+		return declaration;
+	}
 
-	if (!_materials.empty())
+	VertexDeclaration deserializeVertexDeclaration(ArrayValue declInfo)
+	{
+		VertexDeclaration decl(true);
+		for (Dictionary e : declInfo->content)
+		{
+			bool comp = false;
+			decl.push_back(stringToVertexAttributeUsage(e.stringForKey(kUsage)->content, comp),
+				stringToVertexAttributeType(e.stringForKey(kType)->content));
+		}
+		return decl;
+	}
+}
+
+Dictionary Storage::serializeMaterials(const std::string& basePath)
+{
+	Dictionary materialsDictionary;
+	for (auto& kv : _materials)
 	{
-		Dictionary materialsDictionary;
-		for (auto& kv : _materials)
+		if (kv.first != kv.second->name())
 		{
-			if (kv.first != kv.second->name())
-			{
-				log::warning("Mismatch for material's key and name: %s and %s, using key to serialize", 
-					kv.first.c_str(), kv.second->name().c_str());
-			}
-
-			Dictionary materialDictionary;
-			kv.second->serialize(materialDictionary, basePath);
-			materialsDictionary.setDictionaryForKey(kv.first, materialDictionary);
+			log::warning("Mismatch for material's key and name: %s and %s, using key to serialize", 
+				kv.first.c_str(), kv.second->name().c_str());
 		}
 
+		Dictionary materialDictionary;
+		kv.second->serialize(materialDictionary, basePath);
+		materialsDictionary.setDictionaryForKey(kv.first, materialDictionary);
+	}
+	return materialsDictionary;
+}
+
+void Storage::deserializeMaterials(RenderContext* rc, Dictionary materials, SerializationHelper* helper,
+	ObjectsCache& cache, uint32_t options)
+{
+	for (const auto kv : materials->content)
+	{
+		Dictionary materialInfo(kv.second);
+		Material::Pointer material;
+		material->deserializeWithOptions(materialInfo, rc, cache,
+			helper->serializationBasePath(), options);
+		addMaterial(material);
+	}
+}
+
+Dictionary Storage::serializeIndexArray(size_t& indexesDataSize)
+{
+	indexesDataSize = etMin(_indexArray->dataSize(),
+		_indexArray->actualSize() * static_cast<size_t>(_indexArray->format()));
+
+	Dictionary indexArrayDictionary;
+	indexArrayDictionary.setIntegerForKey(kDataSize, indexesDataSize);
+	indexArrayDictionary.setIntegerForKey(kIndexesCount, _indexArray->actualSize());
+	indexArrayDictionary.setStringForKey(kPrimitiveType, primitiveTypeToString(_indexArray->primitiveType()));
+	indexArrayDictionary.setStringForKey(kFormat, indexArrayFormatToString(_indexArray->format()));
+	return indexArrayDictionary;
+}
+
+Dictionary Storage::serialize(const std::string& basePath)
+{
+	Dictionary stream;
+
+	if (!_materials.empty())
+	{
+		Dictionary materialsDictionary = serializeMaterials(basePath);
 		std::string libraryName = replaceFileExt(basePath, ".etxmtls");
 
-		auto serializedData = json::serialize(materialsDictionary, json::SerializationFlag_ReadableFormat);
-		BinaryDataStorage binaryData(serializedData.size() + 1, 0);
-		etCopyMemory(binaryData.data(), serializedData.data(), serializedData.size());
-		binaryData.writeToFile(libraryName);
+		if (_serializationFormat == StorageFormat::Binary)
+		{
+			binary::serialize(materialsDictionary).writeToFile(libraryName);
+		}
+		else
+		{
+			auto serializedData = json::serialize(materialsDictionary, json::SerializationFlag_ReadableFormat);
+			BinaryDataStorage binaryData(serializedData.size() + 1, 0);
+			etCopyMemory(binaryData.data(), serializedData.data(), serializedData.size());
+			binaryData.writeToFile(libraryName);
+		}
 
 		stream.setStringForKey(kMaterials, getFileName(libraryName));
 	}
@@ -97,24 +205,10 @@ Dictionary Storage::serialize(const std::string& basePath)
 	{
 		std::string binaryName = replaceFileExt(basePath, ".storage-" + intToStr(index) + ".etvs");
 
-		ArrayValue declaration;
-		declaration->content.reserve(vs->declaration().elements().size());
-		for (const auto& e : vs->declaration().elements())
-		{
-			Dictionary declDictionary;
-			declDictionary.setStringForKey(kUsage, vertexAttributeUsageToString(e.usage()));
-			declDictionary.setStringForKey(kType, vertexAttributeTypeToString(e.type()));
-			declDictionary.setStringForKey(kDataType, dataTypeToString(e.dataType()));
-			declDictionary.setIntegerForKey(kStride, e.stride());
-			declDictionary.setIntegerForKey(kOffset, e.offset());
-			declDictionary.setIntegerForKey(kComponents, e.components());
-			declaration->content.push_back(declDictionary);
-		}
-
 		Dictionary storageDictionary;
 		storageDictionary.setStringForKey(kName, vs->name());
 		storageDictionary.setStringForKey(kBinary, getFileName(binaryName));
-		storageDictionary.setArrayForKey(kVertexDeclaration, declaration);
+		storageDictionary.setArrayForKey(kVertexDeclaration, serializeVertexDeclaration(vs->declaration()));
 		storageDictionary.setIntegerForKey(kDataSize, vs->data().dataSize());
 		storagesDictionary.setDictionaryForKey(vs->name(), storageDictionary);
 
@@ -129,15 +223,9 @@ Dictionary Storage::serialize(const std::string& basePath)
 
 	std::string binaryName = replaceFileExt(basePath, ".indexes.etvs");
 
-	size_t indexesDataSize = etMin(_indexArray->dataSize(),
-		_indexArray->actualSize() * static_cast<size_t>(_indexArray->format()));
-
-	Dictionary indexArrayDictionary;
+	size_t indexesDataSize = 0;
+	Dictionary indexArrayDictionary = serializeIndexArray(indexesDataSize);
 	indexArrayDictionary.setStringForKey(kBinary, getFileName(binaryName));
-	indexArrayDictionary.setIntegerForKey(kDataSize, indexesDataSize);
-	indexArrayDictionary.setIntegerForKey(kIndexesCount, _indexArray->actualSize());
-	indexArrayDictionary.setStringForKey(kPrimitiveType, primitiveTypeToString(_indexArray->primitiveType()));
-	indexArrayDictionary.setStringForKey(kFormat, indexArrayFormatToString(_indexArray->format()));
 	stream.setDictionaryForKey(kIndexArray, indexArrayDictionary);
 
 	std::ofstream fOut(binaryName, std::ios::out | std::ios::binary);
@@ -148,6 +236,39 @@ Dictionary Storage::serialize(const std::string& basePath)
 	return stream;
 }
 
+Dictionary Storage::serializeToContainer(SceneContainerWriter& writer, const std::string& basePath,
+	SceneSectionCompression compression)
+{
+	Dictionary stream;
+
+	if (!_materials.empty())
+	{
+		auto materialsData = binary::serialize(serializeMaterials(basePath));
+		stream.setIntegerForKey(kMaterials, writer.addSection(SceneSectionType::Materials, materialsData, compression));
+	}
+
+	Dictionary storagesDictionary;
+	for (const auto& vs : _vertexStorages)
+	{
+		Dictionary storageDictionary;
+		storageDictionary.setStringForKey(kName, vs->name());
+		storageDictionary.setArrayForKey(kVertexDeclaration, serializeVertexDeclaration(vs->declaration()));
+		storageDictionary.setIntegerForKey(kDataSize, vs->data().dataSize());
+		storageDictionary.setIntegerForKey(kSection, writer.addSection(SceneSectionType::VertexData,
+			vs->data().binary(), vs->data().dataSize(), compression));
+		storagesDictionary.setDictionaryForKey(vs->name(), storageDictionary);
+	}
+	stream.setDictionaryForKey(kVertexStorages, storagesDictionary);
+
+	size_t indexesDataSize = 0;
+	Dictionary indexArrayDictionary = serializeIndexArray(indexesDataSize);
+	indexArrayDictionary.setIntegerForKey(kSection, writer.addSection(SceneSectionType::IndexData,
+		_indexArray->binary(), indexesDataSize, compression));
+	stream.setDictionaryForKey(kIndexArray, indexArrayDictionary);
+
+	return stream;
+}
+
 void Storage::deserializeWithOptions(RenderContext* rc, Dictionary stream, SerializationHelper* helper,
 	ObjectsCache& cache, uint32_t options)
 {
@@ -155,36 +276,25 @@ void Storage::deserializeWithOptions(RenderContext* rc, Dictionary stream, Seria
 	if (!fileExists(materialsLibrary))
 		materialsLibrary = helper->serializationBasePath() + materialsLibrary;
 
-	if (fileExists(materialsLibrary))
+	InputStream materialsFile(materialsLibrary, StreamMode_Binary);
+	if (fileExists(materialsLibrary) && materialsFile.valid())
 	{
+		BinaryDataStorage data(streamSize(materialsFile.stream()));
+		materialsFile.stream().read(data.binary(), static_cast<std::streamsize>(data.size()));
+
 		ValueClass vc = ValueClass_Invalid;
-		Dictionary materials = json::deserialize(loadTextFile(materialsLibrary), vc);
+		Dictionary materials = binary::isBinaryData(data.binary(), data.size()) ?
+			binary::deserialize(data, vc) : json::deserialize(data.binary(), strnlen(data.binary(), data.size()), vc);
+
 		if (vc == ValueClass_Dictionary)
-		{
-			for (const auto kv : materials->content)
-			{
-				Dictionary materialInfo(kv.second);
-				Material::Pointer material;
-				material->deserializeWithOptions(materialInfo, rc, cache,
-					helper->serializationBasePath(), options);
-				addMaterial(material);
-			}
-		}
+			deserializeMaterials(rc, materials, helper, cache, options);
 	}
 
 	Dictionary vsmap = stream.dictionaryForKey(kVertexStorages);
 	for (const auto& kv : vsmap->content)
 	{
 		Dictionary storage(kv.second);
-		ArrayValue declInfo = storage.arrayForKey(kVertexDeclaration);
-
-		VertexDeclaration decl(true);
-		for (Dictionary e : declInfo->content)
-		{
-			bool comp = false;
-			decl.push_back(stringToVertexAttributeUsage(e.stringForKey(kUsage)->content, comp),
-				stringToVertexAttributeType(e.stringForKey(kType)->content));
-		}
+		VertexDeclaration decl = deserializeVertexDeclaration(storage.arrayForKey(kVertexDeclaration));
 		size_t capacity = static_cast<size_t>(storage.integerForKey(kDataSize)->content) / decl.dataSize();
 
 		VertexStorage::Pointer vs = VertexStorage::Pointer::create(decl, capacity);
@@ -224,6 +334,94 @@ void Storage::deserializeWithOptions(RenderContext* rc, Dictionary stream, Seria
 	setIndexArray(ia);
 }
 
+void Storage::deserializeFromContainer(RenderContext* rc, Dictionary stream, SceneContainer::Pointer container,
+	SerializationHelper* helper, ObjectsCache& cache, uint32_t options)
+{
+	if (stream.hasKey(kMaterials))
+	{
+		auto materialsSection = static_cast<size_t>(stream.integerForKey(kMaterials)->content);
+
+		ValueClass vc = ValueClass_Invalid;
+		Dictionary materials = binary::deserialize(container->sectionData(materialsSection), vc);
+		if (vc == ValueClass_Dictionary)
+			deserializeMaterials(rc, materials, helper, cache, options);
+	}
+
+	bool streamGeometry = (options & DeserializeOption_StreamGeometry) == DeserializeOption_StreamGeometry;
+
+	Dictionary vsmap = stream.dictionaryForKey(kVertexStorages);
+	for (const auto& kv : vsmap->content)
+	{
+		Dictionary storage(kv.second);
+		if (streamGeometry)
+		{
+			auto vs = VertexStorage::Pointer::create(deserializeVertexDeclaration(storage.arrayForKey(kVertexDeclaration)), 0);
+			vs->setName(storage.stringForKey(kName)->content);
+			addVertexStorage(vs);
+		}
+		else
+		{
+			addVertexStorage(loadVertexStorage(storage, container));
+		}
+	}
+
+	Dictionary iaInfo = stream.dictionaryForKey(kIndexArray);
+	if (streamGeometry)
+	{
+		setIndexArray(IndexArray::Pointer::create(stringToIndexArrayFormat(iaInfo.stringForKey(kFormat)->content), 0,
+			stringToPrimitiveType(iaInfo.stringForKey(kPrimitiveType)->content)));
+	}
+	else
+	{
+		setIndexArray(loadIndexArray(iaInfo, container));
+	}
+}
+
+VertexStorage::Pointer Storage::loadVertexStorage(Dictionary storage, SceneContainer::Pointer container)
+{
+	VertexDeclaration decl = deserializeVertexDeclaration(storage.arrayForKey(kVertexDeclaration));
+	size_t capacity = static_cast<size_t>(storage.integerForKey(kDataSize)->content) / decl.dataSize();
+	size_t section = static_cast<size_t>(storage.integerForKey(kSection)->content);
+
+	VertexStorage::Pointer vs;
+	if (sectionCanBeReferenced(container, section, capacity * decl.dataSize()))
+	{
+		size_t offset = static_cast<size_t>(container->section(section).offset);
+		vs = VertexStorage::Pointer::create(decl, container->mappedFile(), offset, capacity);
+	}
+
+	if (vs.invalid() || (vs->capacity() != capacity))
+	{
+		vs = VertexStorage::Pointer::create(decl, capacity);
+		copySectionData(container, section, vs->data().binary(), vs->data().dataSize());
+	}
+	vs->setName(storage.stringForKey(kName)->content);
+	return vs;
+}
+
+IndexArray::Pointer Storage::loadIndexArray(Dictionary iaInfo, SceneContainer::Pointer container)
+{
+	IndexArrayFormat fmt = stringToIndexArrayFormat(iaInfo.stringForKey(kFormat)->content);
+	PrimitiveType pt = stringToPrimitiveType(iaInfo.stringForKey(kPrimitiveType)->content);
+	size_t indexesCount = static_cast<size_t>(iaInfo.integerForKey(kIndexesCount)->content);
+	size_t section = static_cast<size_t>(iaInfo.integerForKey(kSection)->content);
+
+	IndexArray::Pointer ia;
+	if (sectionCanBeReferenced(container, section, indexesCount * static_cast<size_t>(fmt)))
+	{
+		size_t offset = static_cast<size_t>(container->section(section).offset);
+		ia = IndexArray::Pointer::create(fmt, pt, container->mappedFile(), offset, indexesCount);
+	}
+
+	if (ia.invalid() || (ia->capacity() != indexesCount))
+	{
+		ia = IndexArray::Pointer::create(fmt, indexesCount, pt);
+		copySectionData(container, section, ia->binary(), ia->dataSize());
+	}
+	ia->setActualSize(etMin(indexesCount, static_cast<size_t>(ia->capacity())));
+	return ia;
+}
+
 void Storage::flush()
 {
 	auto vi = _vertexStorages.begin();
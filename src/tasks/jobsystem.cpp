@@ -0,0 +1,284 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <deque>
+#include <condition_variable>
+#include <et/app/invocation.h>
+#include <et/tasks/jobsystem.h>
+
+namespace et
+{
+	struct JobQueue
+	{
+		std::mutex lock;
+		std::deque<Job::Pointer> jobs;
+	};
+
+	class JobSystemPrivate
+	{
+	public:
+		JobSystemPrivate();
+		~JobSystemPrivate();
+
+		void workerMain(size_t workerIndex);
+
+		void schedule(Job::Pointer);
+		bool executeNextJob();
+		void finishJob(Job::Pointer);
+
+		Job::Pointer popJob(size_t queueIndex);
+		Job::Pointer stealJob(size_t queueIndex);
+
+	public:
+		std::vector<JobQueue*> queues;
+		std::vector<std::thread> workers;
+
+		std::mutex sleepLock;
+		std::condition_variable sleepCondition;
+
+		std::atomic<int> queuedJobs{0};
+		std::atomic<int> sleepingWorkers{0};
+		std::atomic<size_t> submissionCounter{0};
+		std::atomic<bool> running{true};
+	};
+
+	/*
+	 * Index of the worker thread, or invalidWorkerIndex for threads outside of the pool
+	 */
+	static const size_t invalidWorkerIndex = static_cast<size_t>(-1);
+	static thread_local size_t currentWorkerIndex = invalidWorkerIndex;
+}
+
+using namespace et;
+
+JobSystem::JobSystem()
+{
+	ET_PIMPL_INIT(JobSystem)
+}
+
+JobSystem::~JobSystem()
+{
+	ET_PIMPL_FINALIZE(JobSystem)
+}
+
+Job::Pointer JobSystem::createJob(Job::Function func)
+{
+	return Job::Pointer::create(func);
+}
+
+Job::Pointer JobSystem::createChildJob(Job::Pointer parent, Job::Function func)
+{
+	ET_ASSERT(parent.valid() && !parent->finished());
+
+	parent->_unfinishedJobs.fetch_add(1);
+
+	auto job = Job::Pointer::create(func);
+	job->_parent = parent;
+	return job;
+}
+
+void JobSystem::addDependency(Job::Pointer job, Job::Pointer dependency)
+{
+	ET_ASSERT(job.valid() && dependency.valid());
+
+	std::lock_guard<std::mutex> lock(dependency->_continuationsLock);
+	if (!dependency->finished())
+	{
+		job->_pendingDependencies.fetch_add(1);
+		dependency->_continuations.push_back(job);
+	}
+}
+
+void JobSystem::setCompletionCallback(Job::Pointer job, Job::Function callback, RunLoop& runLoop)
+{
+	ET_ASSERT(job.valid() && !job->finished());
+
+	job->_completion = callback;
+	job->_completionRunLoop = &runLoop;
+}
+
+void JobSystem::run(Job::Pointer job)
+{
+	if (job->_pendingDependencies.fetch_sub(1) == 1)
+		_private->schedule(job);
+}
+
+Job::Pointer JobSystem::run(Job::Function func)
+{
+	auto job = createJob(func);
+	run(job);
+	return job;
+}
+
+void JobSystem::wait(Job::Pointer job)
+{
+	while (!job->finished())
+	{
+		if (!_private->executeNextJob())
+			std::this_thread::yield();
+	}
+}
+
+size_t JobSystem::workersCount() const
+{
+	return _private->workers.size();
+}
+
+/*
+ * Private
+ */
+JobSystemPrivate::JobSystemPrivate()
+{
+	size_t workersCount = etMax(size_t(1), threading::maxConcurrentThreads() - 1);
+
+	queues.reserve(workersCount);
+	for (size_t i = 0; i < workersCount; ++i)
+		queues.push_back(new JobQueue());
+
+	workers.reserve(workersCount);
+	for (size_t i = 0; i < workersCount; ++i)
+		workers.emplace_back(&JobSystemPrivate::workerMain, this, i);
+}
+
+JobSystemPrivate::~JobSystemPrivate()
+{
+	running = false;
+	{
+		std::lock_guard<std::mutex> lock(sleepLock);
+		sleepCondition.notify_all();
+	}
+
+	for (auto& worker : workers)
+		worker.join();
+
+	for (auto queue : queues)
+		delete queue;
+}
+
+void JobSystemPrivate::workerMain(size_t workerIndex)
+{
+	currentWorkerIndex = workerIndex;
+
+	while (running)
+	{
+		if (executeNextJob())
+			continue;
+
+		std::unique_lock<std::mutex> lock(sleepLock);
+		sleepingWorkers.fetch_add(1);
+		sleepCondition.wait(lock, [this]() { return (queuedJobs.load() > 0) || !running; });
+		sleepingWorkers.fetch_sub(1);
+	}
+}
+
+void JobSystemPrivate::schedule(Job::Pointer job)
+{
+	size_t queueIndex = (currentWorkerIndex == invalidWorkerIndex) ?
+		submissionCounter.fetch_add(1) % queues.size() : currentWorkerIndex;
+
+	auto queue = queues.at(queueIndex);
+	{
+		std::lock_guard<std::mutex> lock(queue->lock);
+		queue->jobs.push_back(job);
+	}
+	queuedJobs.fetch_add(1);
+
+	if (sleepingWorkers.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(sleepLock);
+		sleepCondition.notify_one();
+	}
+}
+
+Job::Pointer JobSystemPrivate::popJob(size_t queueIndex)
+{
+	auto queue = queues.at(queueIndex);
+
+	std::lock_guard<std::mutex> lock(queue->lock);
+	if (queue->jobs.empty())
+		return Job::Pointer();
+
+	auto job = queue->jobs.back();
+	queue->jobs.pop_back();
+	return job;
+}
+
+Job::Pointer JobSystemPrivate::stealJob(size_t queueIndex)
+{
+	auto queue = queues.at(queueIndex);
+
+	std::lock_guard<std::mutex> lock(queue->lock);
+	if (queue->jobs.empty())
+		return Job::Pointer();
+
+	auto job = queue->jobs.front();
+	queue->jobs.pop_front();
+	return job;
+}
+
+bool JobSystemPrivate::executeNextJob()
+{
+	if (queuedJobs.load() <= 0)
+		return false;
+
+	Job::Pointer job;
+
+	size_t ownIndex = currentWorkerIndex;
+	if (ownIndex != invalidWorkerIndex)
+		job = popJob(ownIndex);
+
+	if (job.invalid())
+	{
+		size_t startIndex = (ownIndex == invalidWorkerIndex) ? 0 : ownIndex + 1;
+		for (size_t i = 0, e = queues.size(); job.invalid() && (i < e); ++i)
+		{
+			size_t victimIndex = (startIndex + i) % e;
+			if (victimIndex != ownIndex)
+				job = stealJob(victimIndex);
+		}
+	}
+
+	if (job.invalid())
+		return false;
+
+	queuedJobs.fetch_sub(1);
+
+	if (job->_function)
+		job->_function();
+
+	finishJob(job);
+	return true;
+}
+
+void JobSystemPrivate::finishJob(Job::Pointer job)
+{
+	if (job->_unfinishedJobs.fetch_sub(1) != 1)
+		return;
+
+	std::vector<Job::Pointer> continuations;
+	{
+		std::lock_guard<std::mutex> lock(job->_continuationsLock);
+		job->_continuations.swap(continuations);
+		job->_finished = true;
+	}
+
+	if (job->_completionRunLoop != nullptr)
+		Invocation(job->_completion).invokeInRunLoop(*job->_completionRunLoop);
+
+	for (auto& continuation : continuations)
+	{
+		if (continuation->_pendingDependencies.fetch_sub(1) == 1)
+			schedule(continuation);
+	}
+
+	if (job->_parent.valid())
+	{
+		Job::Pointer parent = job->_parent;
+		job->_parent.reset(nullptr);
+		finishJob(parent);
+	}
+}
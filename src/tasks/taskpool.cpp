@@ -5,70 +5,193 @@
  *
  */
 
+#include <chrono>
+#include <et/core/profiler.h>
 #include <et/tasks/taskpool.h>
 
 using namespace et;
 
-TaskPool::TaskPool()
+TaskPool::TaskPool() :
+	_incomingTasks(incomingTasksCapacity)
 {
 }
 
 TaskPool::~TaskPool() 
 {
-	CriticalSectionScope lock(_csModifying);
+	joinTasks();
 	
-	for (auto i : _tasks)
-		etDestroyObject(i);
+	for (auto& task : _tasks)
+		releaseTask(task);
 }
 
 void TaskPool::addTask(Task* t, float delay)
 {
-	CriticalSectionScope lock(_csModifying);
-	
-	auto alreadyAdded = std::find(_tasksToAdd.begin(), _tasksToAdd.end(), t);
-	if (alreadyAdded == _tasksToAdd.end())
+	if (t->_scheduled.exchange(true)) return;
+
+	ScheduledTask task;
+	task.task = t;
+	task.executionTime = delay;
+	pushTask(std::move(task));
+}
+
+void TaskPool::addTask(TaskFunction func, float delay)
+{
+	ScheduledTask task;
+	task.function = std::move(func);
+	task.executionTime = delay;
+	pushTask(std::move(task));
+}
+
+void TaskPool::pushTask(ScheduledTask&& task)
+{
+	task.sequenceNumber = _sequenceNumber.fetch_add(1);
+	_tasksCount.fetch_add(1);
+
+	if (!_incomingTasks.push(std::move(task)))
 	{
-		t->setExecutionTime(_lastTime + delay);
-		_tasksToAdd.push_back(t); 
+		OverflowNode* node = etCreateObject<OverflowNode>();
+		node->task = std::move(task);
+		node->next = _overflowTasks.load(std::memory_order_relaxed);
+		while (!_overflowTasks.compare_exchange_weak(node->next, node, std::memory_order_release,
+			std::memory_order_relaxed)) { }
+
+		_overflowedTasks.fetch_add(1, std::memory_order_relaxed);
 	}
 }
 
-void TaskPool::update(float currentTime)
+void TaskPool::update(double currentTime)
 {
-	joinTasks();
-	
+	ET_PROFILE_ZONE("taskpool::update");
+
 	_lastTime = currentTime;
 	
-	auto i = _tasks.begin();
-	while (i != _tasks.end())
+	joinTasks();
+	
+	/*
+	 * Tasks added while executing will be executed on the next update
+	 */
+	while (!_tasks.empty() && (_lastTime >= _tasks.front().executionTime))
 	{
-		Task* task = (*i);
-		if (_lastTime >= task->executionTime())
-		{
-			task->execute();
-			etDestroyObject(task);
-			i = _tasks.erase(i);
-		}
-		else
-		{
-			++i;
-		}
+		std::pop_heap(_tasks.begin(), _tasks.end(), ScheduledTaskExecutesLater());
+		_tasksToExecute.push_back(std::move(_tasks.back()));
+		_tasks.pop_back();
 	}
+	_scheduledTasks.store(_tasks.size(), std::memory_order_relaxed);
+	
+	for (auto& task : _tasksToExecute)
+		executeTask(task);
+	
+	_tasksCount.fetch_sub(_tasksToExecute.size());
+	_tasksToExecute.clear();
 }
 
 bool TaskPool::hasTasks()
 {
-	CriticalSectionScope lock(_csModifying);
-	return !(_tasks.empty() && _tasksToAdd.empty());
+	return _tasksCount.load() > 0;
+}
+
+double TaskPool::nextTaskTime()
+{
+	if (!_incomingTasks.empty() || (_overflowTasks.load(std::memory_order_relaxed) != nullptr))
+		return _lastTime;
+	
+	return _tasks.empty() ? std::numeric_limits<double>::max() : _tasks.front().executionTime;
 }
 
 void TaskPool::joinTasks()
 {
-	CriticalSectionScope lock(_csModifying);
+	auto drainStartTime = std::chrono::steady_clock::now();
+	size_t drainedTasks = 0;
 	
-	if (!_tasksToAdd.empty())
+	ScheduledTask task;
+	while (_incomingTasks.pop(task))
+	{
+		task.executionTime += _lastTime;
+		_tasks.push_back(std::move(task));
+		std::push_heap(_tasks.begin(), _tasks.end(), ScheduledTaskExecutesLater());
+		++drainedTasks;
+	}
+	
+	/*
+	 * Order of overflowed tasks is restored by sequence numbers
+	 */
+	OverflowNode* node = _overflowTasks.exchange(nullptr, std::memory_order_acquire);
+	while (node != nullptr)
+	{
+		node->task.executionTime += _lastTime;
+		_tasks.push_back(std::move(node->task));
+		std::push_heap(_tasks.begin(), _tasks.end(), ScheduledTaskExecutesLater());
+		++drainedTasks;
+		
+		OverflowNode* next = node->next;
+		etDestroyObject(node);
+		node = next;
+	}
+	
+	_scheduledTasks.store(_tasks.size(), std::memory_order_relaxed);
+	
+	if (drainedTasks > 0)
+	{
+		uint64_t drainTime = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - drainStartTime).count());
+		
+		_drainedTasks.fetch_add(drainedTasks, std::memory_order_relaxed);
+		_lastDrainTime.store(drainTime, std::memory_order_relaxed);
+		_totalDrainTime.fetch_add(drainTime, std::memory_order_relaxed);
+		
+		if (drainTime > _peakDrainTime.load(std::memory_order_relaxed))
+			_peakDrainTime.store(drainTime, std::memory_order_relaxed);
+		
+		if (drainedTasks > _peakQueueDepth.load(std::memory_order_relaxed))
+			_peakQueueDepth.store(drainedTasks, std::memory_order_relaxed);
+	}
+}
+
+TaskPool::Statistics TaskPool::statistics() const
+{
+	Statistics result;
+	result.queueDepth = _incomingTasks.size();
+	result.peakQueueDepth = _peakQueueDepth.load(std::memory_order_relaxed);
+	result.scheduledTasks = _scheduledTasks.load(std::memory_order_relaxed);
+	result.drainedTasks = _drainedTasks.load(std::memory_order_relaxed);
+	result.overflowedTasks = _overflowedTasks.load(std::memory_order_relaxed);
+	result.lastDrainTime = _lastDrainTime.load(std::memory_order_relaxed);
+	result.peakDrainTime = _peakDrainTime.load(std::memory_order_relaxed);
+	result.totalDrainTime = _totalDrainTime.load(std::memory_order_relaxed);
+	return result;
+}
+
+void TaskPool::resetStatistics()
+{
+	_peakQueueDepth = 0;
+	_drainedTasks = 0;
+	_overflowedTasks = 0;
+	_lastDrainTime = 0;
+	_peakDrainTime = 0;
+	_totalDrainTime = 0;
+}
+
+void TaskPool::executeTask(ScheduledTask& scheduledTask)
+{
+	if (scheduledTask.task == nullptr)
+	{
+		scheduledTask.function();
+		scheduledTask.function = nullptr;
+	}
+	else
+	{
+		scheduledTask.task->execute();
+		etDestroyObject(scheduledTask.task);
+		scheduledTask.task = nullptr;
+	}
+}
+
+void TaskPool::releaseTask(ScheduledTask& scheduledTask)
+{
+	if (scheduledTask.task != nullptr)
 	{
-		_tasks.insert(_tasks.end(), _tasksToAdd.begin(), _tasksToAdd.end());
-		_tasksToAdd.clear();
+		etDestroyObject(scheduledTask.task);
+		scheduledTask.task = nullptr;
 	}
+	scheduledTask.function = nullptr;
 }
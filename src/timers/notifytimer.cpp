@@ -16,11 +16,17 @@ void NotifyTimer::start(TimerPool* tp, float period, int64_t repeatCount)
 {
 	ET_ASSERT(tp != nullptr);
 
-	startUpdates(tp);
+	/*
+	 * Timer pool schedules timer using its end time, so it should be set before attaching
+	 */
+	if (running())
+		cancelUpdates();
 
 	_period = period;
 	_repeatCount = repeatCount;
-	_endTime = actualTime() + period;
+	_endTime = tp->actualTime() + period;
+
+	startUpdates(tp);
 }
 
 void NotifyTimer::start(TimerPool::Pointer tp, float period, int64_t repeatCount)
@@ -42,3 +48,8 @@ void NotifyTimer::update(float t)
 		expired.invoke(this);
 	}
 }
+
+float NotifyTimer::nextUpdateTime() const
+{
+	return _endTime;
+}
@@ -5,10 +5,21 @@
  *
  */
 
+#include <et/core/profiler.h>
 #include <et/app/application.h>
 #include <et/timers/timerpool.h>
 #include <et/timers/timedobject.h>
 
+namespace et
+{
+	static const double timerPoolTickDuration = 0.001;
+
+	/*
+	 * Compensates float precision of deadlines reported by timed objects
+	 */
+	static const double timerPoolTickTolerance = 0.01;
+}
+
 using namespace et;
 
 TimerPool::TimerPool(RunLoop* owner) :
@@ -16,87 +27,143 @@ TimerPool::TimerPool(RunLoop* owner) :
 {
 }
 
+TimerPool::~TimerPool()
+{
+}
+
 bool TimerPool::hasObjects()
 {
 	CriticalSectionScope lock(_lock);
-	return !(_timedObjects.empty() && _queue.empty());
+	return !_registeredObjects.empty();
 }
 
-void TimerPool::attachTimedObject(TimedObject* obj)
+double TimerPool::nextUpdateTime()
 {
 	CriticalSectionScope lock(_lock);
 
-	QueueEntry entry(obj, QueueAction_Update);
-	if (std::find(_timedObjects.begin(), _timedObjects.end(), entry) != _timedObjects.end()) return;
+	if (_registeredObjects.empty())
+		return std::numeric_limits<double>::max();
 
-	if (_updating)
-	{
-		entry.action = QueueAction_Add;
-		if (std::find(_queue.begin(), _queue.end(), entry) == _queue.end())
-			_queue.push_back(entry);
-	}
-	else
+	if (!(_continuousObjects.empty() && _dueObjects.empty()))
+		return 0.0;
+
+	/*
+	 * Lower bound of the first non-empty slot, searching from the lowest level
+	 */
+	for (uint64_t level = 0; level < WheelLevels; ++level)
 	{
-		_timedObjects.push_back(entry);
+		uint64_t shift = level * WheelSlotBits;
+		uint64_t levelTick = _currentTick >> shift;
+		for (uint64_t i = 1; i <= WheelSlots; ++i)
+		{
+			if (!_wheel[level][(levelTick + i) & WheelSlotMask].empty())
+				return static_cast<double>((levelTick + i) << shift) * timerPoolTickDuration;
+		}
 	}
+
+	return _distantObjects.empty() ? std::numeric_limits<double>::max() :
+		static_cast<double>(_currentTick + 1) * timerPoolTickDuration;
 }
 
-void TimerPool::detachTimedObject(TimedObject* obj)
+void TimerPool::attachTimedObject(TimedObject* obj)
 {
-	CriticalSectionScope lock(_lock);
-
-	QueueEntry existsAddingEntry(obj, QueueAction_Add);
-	auto existsAddingValue = std::find(_queue.begin(), _queue.end(), existsAddingEntry);
-	if (existsAddingValue != _queue.end())
 	{
-		if (_updating)
-			existsAddingEntry.action = QueueAction_Remove;
-		else
-			_queue.erase(existsAddingValue);
-	}
+		CriticalSectionScope lock(_lock);
 
-	QueueEntry existsUpdatingEntry(obj, QueueAction_Update);
-	auto existsUpdatingValue = std::find(_timedObjects.begin(), _timedObjects.end(), existsUpdatingEntry);
-	if (existsUpdatingValue != _timedObjects.end()) 
-	{
-		if (_updating)
-			existsUpdatingValue->action = QueueAction_Remove;
+		if (_registeredObjects.count(obj) > 0) return;
+
+		Entry entry(obj, ++_registrationCounter, obj->requiresContinuousUpdates());
+		_registeredObjects.insert({obj, entry.registration});
+
+		if (entry.continuous)
+		{
+			_continuousObjects.push_back(entry);
+		}
 		else
-			_timedObjects.erase(existsUpdatingValue);
+		{
+			entry.tick = tickForDeadline(obj->nextUpdateTime());
+			schedule(entry);
+		}
 	}
+
+	if (_owner != nullptr)
+		_owner->wakeUp();
 }
 
-void TimerPool::update(float t)
+void TimerPool::detachTimedObject(TimedObject* obj)
 {
 	CriticalSectionScope lock(_lock);
 
-	if (_queue.size() > 0)
+	/*
+	 * Entries are removed from lists lazily
+	 */
+	_registeredObjects.erase(obj);
+}
+
+void TimerPool::update(double t)
+{
+	ET_PROFILE_ZONE("timerpool::update");
+
+	EntryList updatedObjects;
 	{
-		for (auto& i : _queue)
+		CriticalSectionScope lock(_lock);
+
+		updatedObjects.swap(_updatedObjects);
+		updatedObjects.clear();
+
+		advance(static_cast<uint64_t>(etMax(0.0, t / timerPoolTickDuration + timerPoolTickTolerance)));
+		updatedObjects.insert(updatedObjects.end(), _dueObjects.begin(), _dueObjects.end());
+		_dueObjects.clear();
+
+		auto e = std::remove_if(_continuousObjects.begin(), _continuousObjects.end(), [this](const Entry& entry)
 		{
-			if (i.action == QueueAction_Add)
+			if (!registered(entry)) return true;
+			if (entry.object->running()) return false;
+
+			unregister(entry);
+			return true;
+		});
+		_continuousObjects.erase(e, _continuousObjects.end());
+
+		updatedObjects.insert(updatedObjects.end(), _continuousObjects.begin(), _continuousObjects.end());
+	}
+
+	for (const auto& entry : updatedObjects)
+	{
+		{
+			CriticalSectionScope lock(_lock);
+			if (!registered(entry)) continue;
+
+			if (!entry.object->running())
 			{
-				i.action = QueueAction_Update;
-				_timedObjects.push_back(i);
+				unregister(entry);
+				continue;
 			}
 		}
-		_queue.clear();
-	}
 
-	_updating = true;
+		entry.object->update(static_cast<float>(t));
 
-	for (auto& object : _timedObjects)
-	{
-		auto updatableObject = object.object;
-		if ((object.action == QueueAction_Update) && updatableObject->running())
-			updatableObject->update(t);
+		if (!entry.continuous)
+		{
+			CriticalSectionScope lock(_lock);
+			if (registered(entry))
+			{
+				if (entry.object->running())
+				{
+					Entry rescheduled = entry;
+					rescheduled.tick = tickForDeadline(entry.object->nextUpdateTime());
+					schedule(rescheduled);
+				}
+				else
+				{
+					unregister(entry);
+				}
+			}
+		}
 	}
 
-	auto e = std::remove_if(_timedObjects.begin(), _timedObjects.end(), [](const QueueEntry& entry)
-		{ return (entry.action == QueueAction_Remove) || (!entry.object->running()); });
-	_timedObjects.erase(e, _timedObjects.end());
-
-	_updating = false;
+	CriticalSectionScope lock(_lock);
+	_updatedObjects.swap(updatedObjects);
 }
 
 float TimerPool::actualTime() const
@@ -109,3 +176,120 @@ void TimerPool::retain()
 	Shared::retain();
 }
 
+bool TimerPool::registered(const Entry& entry) const
+{
+	auto i = _registeredObjects.find(entry.object);
+	return (i != _registeredObjects.end()) && (i->second == entry.registration);
+}
+
+void TimerPool::unregister(const Entry& entry)
+{
+	if (registered(entry))
+		_registeredObjects.erase(entry.object);
+}
+
+uint64_t TimerPool::tickForDeadline(double deadline) const
+{
+	/*
+	 * Rounding up, so objects are never updated before deadline
+	 */
+	return static_cast<uint64_t>(etMax(0.0,
+		std::ceil(deadline / timerPoolTickDuration - timerPoolTickTolerance)));
+}
+
+void TimerPool::schedule(Entry entry)
+{
+	if (entry.tick <= _currentTick)
+	{
+		_dueObjects.push_back(entry);
+		return;
+	}
+
+	uint64_t delta = entry.tick - _currentTick;
+	for (uint64_t level = 0; level < WheelLevels; ++level)
+	{
+		uint64_t shift = level * WheelSlotBits;
+		if (delta < (uint64_t(1) << (shift + WheelSlotBits)))
+		{
+			_wheel[level][(entry.tick >> shift) & WheelSlotMask].push_back(entry);
+			return;
+		}
+	}
+
+	_distantObjects.push_back(entry);
+}
+
+void TimerPool::advance(uint64_t targetTick)
+{
+	if (targetTick <= _currentTick) return;
+
+	/*
+	 * Large jumps (paused or stalled run loop) are handled by rescheduling everything
+	 */
+	if (targetTick - _currentTick > WheelSlots * WheelSlots)
+	{
+		rebuildWheel(targetTick);
+		return;
+	}
+
+	EntryList cascaded;
+	while (_currentTick < targetTick)
+	{
+		++_currentTick;
+
+		for (uint64_t level = 1; level < WheelLevels; ++level)
+		{
+			uint64_t shift = level * WheelSlotBits;
+			if ((_currentTick & ((uint64_t(1) << shift) - 1)) != 0) break;
+
+			cascaded.clear();
+			cascaded.swap(_wheel[level][(_currentTick >> shift) & WheelSlotMask]);
+			for (const auto& entry : cascaded)
+			{
+				if (registered(entry))
+					schedule(entry);
+			}
+
+			if ((level + 1 == WheelLevels) && !_distantObjects.empty())
+			{
+				cascaded.clear();
+				cascaded.swap(_distantObjects);
+				for (const auto& entry : cascaded)
+				{
+					if (registered(entry))
+						schedule(entry);
+				}
+			}
+		}
+
+		auto& slot = _wheel[0][_currentTick & WheelSlotMask];
+		for (const auto& entry : slot)
+		{
+			if (registered(entry))
+				_dueObjects.push_back(entry);
+		}
+		slot.clear();
+	}
+}
+
+void TimerPool::rebuildWheel(uint64_t targetTick)
+{
+	EntryList entries;
+	entries.swap(_distantObjects);
+
+	for (auto& level : _wheel)
+	{
+		for (auto& slot : level)
+		{
+			entries.insert(entries.end(), slot.begin(), slot.end());
+			slot.clear();
+		}
+	}
+
+	_currentTick = targetTick;
+	for (const auto& entry : entries)
+	{
+		if (registered(entry))
+			schedule(entry);
+	}
+}
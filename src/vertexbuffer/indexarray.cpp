@@ -33,6 +33,20 @@ IndexArray::IndexArray(IndexArrayFormat format, size_t size, PrimitiveType conte
 		linearize(size);
 }
 
+IndexArray::IndexArray(IndexArrayFormat format, PrimitiveType content, MappedFile::Pointer file,
+	size_t offset, size_t size) : tag(0), _data(file->mutableView(offset, size * static_cast<size_t>(format))),
+	_mappedFile(file), _actualSize(0), _format(format), _primitiveType(content)
+{
+	/*
+	 * Array stays empty (with zero capacity) if view could not be created
+	 */
+	if (_data.dataSize() != size * static_cast<size_t>(format))
+	{
+		_data = BinaryDataStorage();
+		_mappedFile = MappedFile::Pointer();
+	}
+}
+
 void IndexArray::linearize(size_t indexFrom, size_t indexTo, uint32_t startIndex)
 {
 	for (size_t i = indexFrom; i < indexTo; ++i)
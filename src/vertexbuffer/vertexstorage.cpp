@@ -14,11 +14,13 @@ class et::VertexStoragePrivate
 {
 public:
 	VertexStoragePrivate(const VertexDeclaration&, size_t);
+	VertexStoragePrivate(const VertexDeclaration&, MappedFile::Pointer, size_t, size_t);
 
 public:
 	VertexDeclaration decl;
 	BinaryDataStorage data;
 	size_t capacity = 0;
+	MappedFile::Pointer mappedFile;
 };
 
 VertexStorage::VertexStorage(const VertexDeclaration& aDecl, size_t capacity)
@@ -34,6 +36,11 @@ VertexStorage::VertexStorage(const VertexArray::Pointer& va)
 	memcpy(_private->data.binary(), desc.data.binary(), desc.data.dataSize());
 }
 
+VertexStorage::VertexStorage(const VertexDeclaration& aDecl, MappedFile::Pointer file, size_t offset, size_t capacity)
+{
+	ET_PIMPL_INIT(VertexStorage, aDecl, file, offset, capacity);
+}
+
 VertexStorage::~VertexStorage()
 {
 	ET_PIMPL_FINALIZE(VertexStorage)
@@ -112,3 +119,11 @@ VertexStoragePrivate::VertexStoragePrivate(const VertexDeclaration& d, size_t ca
 {
 
 }
+
+VertexStoragePrivate::VertexStoragePrivate(const VertexDeclaration& d, MappedFile::Pointer file,
+	size_t offset, size_t cap) : decl(d), data(file->mutableView(offset, d.dataSize() * cap)), capacity(cap),
+	mappedFile(file)
+{
+	if (data.dataSize() != d.dataSize() * cap)
+		capacity = 0;
+}